@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+
+//Packs values into a byte buffer a few bits at a time, LSB first.
+//Writing past the end sets the overflow flag instead of touching memory.
+class BitWriter
+{
+private:
+
+	uint8_t* buffer;
+	int capacity;
+	int bytePos = 0;
+
+	uint64_t scratch = 0;
+	int scratchBits = 0;
+	bool overflow = false;
+
+public:
+
+	BitWriter(char* buffer, int capacity) : buffer((uint8_t*)buffer), capacity(capacity) {}
+
+	void WriteBits(uint32_t value, int bits)
+	{
+		if (overflow) return;
+
+		if (bits < 32) value &= (1u << bits) - 1;
+		scratch |= (uint64_t)value << scratchBits;
+		scratchBits += bits;
+
+		while (scratchBits >= 8)
+		{
+			if (bytePos >= capacity)
+			{
+				//Nothing more fits, drop what's pending so later calls can't push scratchBits past 63
+				overflow = true;
+				scratch = 0;
+				scratchBits = 0;
+				return;
+			}
+			buffer[bytePos++] = (uint8_t)scratch;
+			scratch >>= 8;
+			scratchBits -= 8;
+		}
+	}
+
+	void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+
+	//Signed value stored offset by half the range, clamped to fit
+	void WriteSigned(int32_t value, int bits)
+	{
+		int32_t half = 1 << (bits - 1);
+		if (value < -half) value = -half;
+		if (value > half - 1) value = half - 1;
+		WriteBits((uint32_t)(value + half), bits);
+	}
+
+	//Small values in few bits: 4 bit groups, low first, each followed by a bit saying whether another comes.
+	//0-15 take 5 bits, up to 255 take 10
+	void WriteVarUInt(uint32_t value)
+	{
+		do
+		{
+			WriteBits(value & 0xF, 4);
+			value >>= 4;
+			WriteBool(value != 0);
+		} while (value != 0);
+	}
+
+	//Writes out any partial byte. Returns total bytes used
+	int Flush()
+	{
+		if (scratchBits > 0)
+		{
+			if (bytePos >= capacity) overflow = true;
+			else buffer[bytePos++] = (uint8_t)scratch;
+			scratch = 0;
+			scratchBits = 0;
+		}
+		return bytePos;
+	}
+
+	int GetBitsWritten() { return bytePos * 8 + scratchBits; }
+	bool Overflowed() { return overflow; }
+
+};
+
+//Reads values written by BitWriter. Reading past the end returns zeros and sets the overflow flag.
+class BitReader
+{
+private:
+
+	const uint8_t* buffer;
+	int length;
+	int bytePos = 0;
+
+	uint64_t scratch = 0;
+	int scratchBits = 0;
+	bool overflow = false;
+
+public:
+
+	BitReader(const char* buffer, int length) : buffer((const uint8_t*)buffer), length(length) {}
+
+	uint32_t ReadBits(int bits)
+	{
+		while (scratchBits < bits)
+		{
+			uint64_t next = 0;
+			if (bytePos < length) next = buffer[bytePos++];
+			else overflow = true;
+			scratch |= next << scratchBits;
+			scratchBits += 8;
+		}
+
+		uint32_t value = (uint32_t)(scratch & ((bits < 32) ? ((1ull << bits) - 1) : 0xFFFFFFFFull));
+		scratch >>= bits;
+		scratchBits -= bits;
+		return value;
+	}
+
+	bool ReadBool() { return ReadBits(1) != 0; }
+
+	//At most the 8 groups a 32 bit value needs, so garbage can't keep it reading
+	uint32_t ReadVarUInt()
+	{
+		uint32_t value = 0;
+		for (int shift = 0; shift < 32; shift += 4)
+		{
+			value |= ReadBits(4) << shift;
+			if (!ReadBool()) break;
+		}
+		return value;
+	}
+
+	int32_t ReadSigned(int bits)
+	{
+		int32_t half = 1 << (bits - 1);
+		return (int32_t)ReadBits(bits) - half;
+	}
+
+	bool Overflowed() { return overflow; }
+
+};
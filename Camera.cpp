@@ -1,7 +1,6 @@
 #include "Camera.h"
-#include "Input.h"
 
-using namespace DirectX;
+using namespace VectorMath;
 
 // Creates a camera at the specified position
 Camera::Camera(float x, float y, float z, float moveSpeed, float mouseLookSpeed, float aspectRatio)
@@ -59,27 +58,27 @@ void Camera::UpdateViewMatrix()
 {
 	// Rotate the standard "forward" matrix by our rotation
 	// This gives us our "look direction"
-	XMFLOAT3 rot = transform.GetPitchYawRoll();
-	XMVECTOR dir = XMVector3Rotate(XMVectorSet(0, 0, 1, 0), XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3(&rot)));
+	quat rot = transform.GetRotation();
+	Vector dir = Vector3Rotate(VectorSet(0, 0, 1, 0), LoadFloat4(&rot));
 
-	XMFLOAT3 pos = transform.GetPosition();
-	XMMATRIX view = XMMatrixLookToLH(
-		XMLoadFloat3(&pos),
+	float3 pos = transform.GetPosition();
+	Matrix view = MatrixLookToLH(
+		LoadFloat3(&pos),
 		dir,
-		XMVectorSet(0, 1, 0, 0));
+		VectorSet(0, 1, 0, 0));
 
-	XMStoreFloat4x4(&viewMatrix, view);
+	StoreFloat4x4(&viewMatrix, view);
 }
 
 // Updates the projection matrix
 void Camera::UpdateProjectionMatrix(float aspectRatio)
 {
-	XMMATRIX P = XMMatrixPerspectiveFovLH(
-		0.25f * XM_PI,		// Field of View Angle
+	Matrix P = MatrixPerspectiveFovLH(
+		0.25f * PI,		// Field of View Angle
 		aspectRatio,		// Aspect ratio
 		0.01f,				// Near clip plane distance
 		300.0f);			// Far clip plane distance
-	XMStoreFloat4x4(&projMatrix, P);
+	StoreFloat4x4(&projMatrix, P);
 }
 
 Transform* Camera::GetTransform()
@@ -1,6 +1,5 @@
 #pragma once
-#include <DirectXMath.h>
-#include <Windows.h>
+#include "VectorMath.h"
 
 #include "Transform.h"
 
@@ -16,15 +15,15 @@ public:
 	void UpdateProjectionMatrix(float aspectRatio);
 
 	// Getters
-	DirectX::XMFLOAT4X4 GetView() { return viewMatrix; }
-	DirectX::XMFLOAT4X4 GetProjection() { return projMatrix; }
+	VectorMath::float4x4 GetView() { return viewMatrix; }
+	VectorMath::float4x4 GetProjection() { return projMatrix; }
 
 	Transform* GetTransform();
 
 private:
 	// Camera matrices
-	DirectX::XMFLOAT4X4 viewMatrix;
-	DirectX::XMFLOAT4X4 projMatrix;
+	VectorMath::float4x4 viewMatrix;
+	VectorMath::float4x4 projMatrix;
 
 	Transform transform;
 
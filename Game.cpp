@@ -497,9 +497,10 @@ void Game::LoadAssetsAndCreateEntities()
 	entities[0]->GetTransform()->AddChild(entities[1]->GetTransform(), true);
 
 	//Projectiles
+	projectileSystem.Resize(MAX_PROJECTILES);
 	for (int i = 0; i < MAX_PROJECTILES; i++)
 	{
-		Projectile* bullet = new Projectile(Assets::GetInstance().GetMesh("Models\\sphere.obj"), materials[0], 5);
+		Projectile* bullet = new Projectile(Assets::GetInstance().GetMesh("Models\\sphere.obj"), materials[0], 5, &projectileSystem, i);
 		entities.push_back(bullet);
 		projectiles[i] = bullet;
 		bullet->dead = true;
@@ -706,11 +707,12 @@ void Game::Update(float deltaTime, float totalTime)
 
 	Input& input = Input::GetInstance();
 
+	//Predict our own movement first, the network update sends it and corrects it
+	localPlayer->Update(deltaTime);
 	netManager->Update(deltaTime, localPlayer, projectiles);
 
 	// Update the camera
 	camera->Update(deltaTime);
-	localPlayer->Update(deltaTime);
 
 	if (input.MouseLeftPress())
 	{
@@ -737,23 +739,16 @@ void Game::Update(float deltaTime, float totalTime)
 			tf->SetPosition(camtf->GetPosition().x + localPlayer->velocityX * deltaTime, camtf->GetPosition().y + localPlayer->velocityY * deltaTime, camtf->GetPosition().z + localPlayer->velocityZ * deltaTime);
 			tf->SetRotation(camtf->GetPitchYawRoll().x, camtf->GetPitchYawRoll().y, camtf->GetPitchYawRoll().z);
 			bullet->SetVelocity(0, 2, 35, -4.9f);
+			bullet->Launch();
 			if (netManager->GetNetworkState() == NetworkState::Connected)
 				netManager->AddNetworkProjectile(bullet, index);
 		}
 	}
 
+	//All of our projectiles in one pass, then back into their transforms for drawing
+	projectileSystem.Update(deltaTime);
 	for (int i = 0; i < MAX_PROJECTILES; i++)
-	{
-		Projectile* p = projectiles[i];
-		if (!p->dead)
-		{
-			p->Update(deltaTime);
-			if (p->dead)
-			{
-				p->GetTransform()->SetPosition(0, -5000, 0);
-			}
-		}
-	}
+		projectiles[i]->Sync();
 
 	for (int i = 0; i < emitters.size(); i++)
 	{
@@ -46,6 +46,7 @@ private:
 	std::vector<GameEntity*>* currentScene;
 	std::vector<GameEntity*> entities;
 	Projectile* projectiles[MAX_PROJECTILES];
+	ProjectileSystem projectileSystem;
 	Camera* camera;
 	Player* localPlayer;
 
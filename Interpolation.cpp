@@ -0,0 +1,146 @@
+#include "Interpolation.h"
+
+#include <cmath>
+
+static const float PI = 3.14159265f;
+
+//Blends angles the short way around
+static float LerpAngle(float a, float b, float t)
+{
+	float d = b - a;
+	while (d > PI) d -= 2 * PI;
+	while (d < -PI) d += 2 * PI;
+	return a + d * t;
+}
+
+void InterpolationBuffer::Add(const InterpolationSample& sample)
+{
+	//Find where it goes, usually the end
+	int i = count;
+	while (i > 0 && samples[i - 1].time > sample.time) i--;
+
+	if (i > 0 && samples[i - 1].time == sample.time)
+	{
+		samples[i - 1] = sample;
+		return;
+	}
+
+	if (count == INTERPOLATION_BUFFER_SIZE)
+	{
+		//Older than anything we'd keep
+		if (i == 0) return;
+
+		//Make room by forgetting the oldest
+		for (int j = 1; j < count; j++) samples[j - 1] = samples[j];
+		count--;
+		i--;
+	}
+
+	for (int j = count; j > i; j--) samples[j] = samples[j - 1];
+	samples[i] = sample;
+	count++;
+}
+
+bool InterpolationBuffer::Sample(double time, float maxExtrapolation, InterpolationSample* out)
+{
+	if (count == 0) return false;
+
+	//Haven't buffered enough yet, hold the oldest
+	if (time <= samples[0].time)
+	{
+		*out = samples[0];
+		return true;
+	}
+
+	//Ran out of samples, carry on along the last known velocity for a while
+	const InterpolationSample& newest = samples[count - 1];
+	if (time >= newest.time)
+	{
+		*out = newest;
+		if (!newest.present) return true;
+
+		float dt = (float)(time - newest.time);
+		if (dt > maxExtrapolation) dt = maxExtrapolation;
+		for (int k = 0; k < 3; k++)
+			out->position[k] += newest.velocity[k] * dt;
+		return true;
+	}
+
+	int i = count - 2;
+	while (samples[i].time > time) i--;
+	const InterpolationSample& a = samples[i];
+	const InterpolationSample& b = samples[i + 1];
+
+	//Nothing to blend between when the entity appears or disappears
+	if (!a.present || !b.present)
+	{
+		*out = a;
+		return true;
+	}
+
+	float span = (float)(b.time - a.time);
+	float t = (float)((time - a.time) / (b.time - a.time));
+	float t2 = t * t;
+	float t3 = t2 * t;
+
+	//Hermite basis, and its derivative for the velocity along the curve
+	float h00 = 2 * t3 - 3 * t2 + 1;
+	float h10 = t3 - 2 * t2 + t;
+	float h01 = -2 * t3 + 3 * t2;
+	float h11 = t3 - t2;
+
+	float d00 = 6 * t2 - 6 * t;
+	float d10 = 3 * t2 - 4 * t + 1;
+	float d01 = -6 * t2 + 6 * t;
+	float d11 = 3 * t2 - 2 * t;
+
+	out->time = time;
+	out->present = true;
+	for (int k = 0; k < 3; k++)
+	{
+		out->position[k] = h00 * a.position[k] + h10 * span * a.velocity[k] + h01 * b.position[k] + h11 * span * b.velocity[k];
+		out->velocity[k] = (d00 * a.position[k] + d01 * b.position[k]) / span + d10 * a.velocity[k] + d11 * b.velocity[k];
+		out->rotation[k] = LerpAngle(a.rotation[k], b.rotation[k], t);
+	}
+	return true;
+}
+
+void SnapshotClock::SetTickRate(int tickRate)
+{
+	if (tickRate < 1) tickRate = 60;
+	tickLength = 1.0 / tickRate;
+	started = false;
+}
+
+double SnapshotClock::Observe(uint16_t sequence, double localTime)
+{
+	if (!started)
+	{
+		started = true;
+		ticks = 0;
+		firstSequence = sequence;
+		lastSequence = sequence;
+		offset = localTime;
+		return 0;
+	}
+
+	ticks += (int16_t)(uint16_t)(sequence - lastSequence);
+	lastSequence = sequence;
+	double serverTime = ticks * tickLength;
+
+	//A packet that got here faster than any before means the old offset included delay.
+	//Otherwise creep up slowly, in case the route got longer or the clocks drift
+	double observed = localTime - serverTime;
+	if (observed < offset) offset = observed;
+	else offset += (observed - offset) * 0.01;
+
+	return serverTime;
+}
+
+uint16_t SnapshotClock::GetTickAt(double serverTime, float* fraction)
+{
+	double t = serverTime / tickLength;
+	double whole = std::floor(t);
+	*fraction = (float)(t - whole);
+	return (uint16_t)(firstSequence + (int64_t)whole);
+}
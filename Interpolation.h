@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+//Samples kept per remote entity, a couple of seconds at low send rates
+#define INTERPOLATION_BUFFER_SIZE 32
+
+//How far behind the server remote entities are drawn, in seconds
+#define DEFAULT_INTERPOLATION_DELAY 0.1f
+
+//Longest we keep moving an entity past its newest sample before freezing it
+#define MAX_EXTRAPOLATION 0.25f
+
+//State of a remote entity at one point in server time.
+//Velocity is world space, it's used as the curve tangent
+struct InterpolationSample
+{
+	double time;
+	bool present;
+	float position[3];
+	float velocity[3];
+	float rotation[3]; //pitch/yaw/roll
+};
+
+//Jitter buffer of timestamped samples for one remote entity.
+//Reading between two samples follows a cubic Hermite curve through their positions and velocities,
+//reading past the newest one extrapolates for at most a bounded time.
+class InterpolationBuffer
+{
+private:
+
+	InterpolationSample samples[INTERPOLATION_BUFFER_SIZE]; //Oldest first
+	int count = 0;
+
+public:
+
+	//Samples may arrive out of order. Ones older than everything buffered are dropped
+	void Add(const InterpolationSample& sample);
+
+	//State at the given server time. Returns false if there's nothing buffered yet
+	bool Sample(double time, float maxExtrapolation, InterpolationSample* out);
+
+	void Clear() { count = 0; }
+
+};
+
+//Maps snapshot sequence numbers to server time, and server time to the local clock.
+//Sequences count server ticks, so they're spaced exactly one tick apart on the server.
+class SnapshotClock
+{
+private:
+
+	double tickLength = 1.0 / 60.0;
+
+	bool started = false;
+	uint16_t firstSequence = 0;
+	uint16_t lastSequence = 0;
+	int64_t ticks = 0; //lastSequence without wrap around
+
+	//Local time minus server time, tracks the least delayed packets
+	double offset = 0;
+
+public:
+
+	void SetTickRate(int tickRate);
+
+	//Call with each newer snapshot as it arrives. Returns its server time
+	double Observe(uint16_t sequence, double localTime);
+
+	//Server time the local clock corresponds to, ignoring network delay jitter
+	double GetServerTime(double localTime) { return localTime - offset; }
+
+	//Server tick a server time falls in, as a sequence number and how far through that tick
+	uint16_t GetTickAt(double serverTime, float* fraction);
+
+	bool IsStarted() { return started; }
+	void Reset() { started = false; }
+
+	double GetTickLength() { return tickLength; }
+
+};
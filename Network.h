@@ -2,14 +2,55 @@
 #include <system_error>
 #include <string>
 #include <iostream>
+
+#ifdef _WIN32
 #include <winsock.h>
+#else
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 #pragma once
+
+#ifdef _WIN32
 #pragma comment (lib, "ws2_32")
 
+typedef int socklen_t;
+
+inline int GetLastSocketError() { return WSAGetLastError(); }
+#else
+//Winsock names so the rest of the code doesn't care which backend it's on
+typedef int SOCKET;
+typedef sockaddr SOCKADDR;
+#define INVALID_SOCKET (-1)
+#define closesocket close
+
+inline int GetLastSocketError() { return errno; }
+#endif
+
+//Largest datagram we ever send or receive. Stays under the usual path MTU, since a fragmented
+//datagram is lost if any fragment is and some networks drop fragments outright.
+//The server trims world updates to fit rather than going over
+#define MAX_DATAGRAM_SIZE 1200
+
+//Most datagrams moved by a single RecvBatch/SendBatch call
+#define MAX_DATAGRAM_BATCH 64
+
+struct Datagram
+{
+    sockaddr_in address;
+    int length;
+    char data[MAX_DATAGRAM_SIZE];
+};
+
 class WSASession
 {
 public:
+#ifdef _WIN32
     WSASession()
     {
         int ret = WSAStartup(MAKEWORD(2, 2), &data);
@@ -23,6 +64,10 @@ public:
 
 private:
     WSAData data;
+#else
+    //Nothing to start up on POSIX
+    WSASession() {}
+#endif
 };
 
 class UDPSocket
@@ -32,13 +77,42 @@ public:
     {
         sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
         if (sock == INVALID_SOCKET)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "Error opening socket");
+            throw std::system_error(GetLastSocketError(), std::system_category(), "Error opening socket");
+
+#ifndef _WIN32
+        //The destructor won't run if we throw, so anything opened so far is closed here
+        epollFD = epoll_create1(0);
+        if (epollFD < 0)
+        {
+            int error = GetLastSocketError();
+            closesocket(sock);
+            throw std::system_error(error, std::system_category(), "epoll_create1 failed");
+        }
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = sock;
+        if (epoll_ctl(epollFD, EPOLL_CTL_ADD, sock, &ev) < 0)
+        {
+            int error = GetLastSocketError();
+            close(epollFD);
+            closesocket(sock);
+            throw std::system_error(error, std::system_category(), "epoll_ctl failed");
+        }
+#endif
     }
     ~UDPSocket()
     {
+#ifndef _WIN32
+        close(epollFD);
+#endif
         closesocket(sock);
     }
 
+    //Owns its handles, a copy would close them a second time
+    UDPSocket(const UDPSocket&) = delete;
+    UDPSocket& operator=(const UDPSocket&) = delete;
+
     void SendTo(const std::string& address, unsigned short port, const char* buffer, int len, int flags = 0)
     {
         sockaddr_in add;
@@ -47,26 +121,140 @@ public:
         add.sin_port = htons(port);
         int ret = sendto(sock, buffer, len, flags, reinterpret_cast<SOCKADDR*>(&add), sizeof(add));
         if (ret < 0)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "sendto failed");
+            throw std::system_error(GetLastSocketError(), std::system_category(), "sendto failed");
     }
     void SendTo(sockaddr_in& address, const char* buffer, int len, int flags = 0)
     {
         int ret = sendto(sock, buffer, len, flags, reinterpret_cast<SOCKADDR*>(&address), sizeof(address));
         if (ret < 0)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "sendto failed");
+            throw std::system_error(GetLastSocketError(), std::system_category(), "sendto failed");
     }
     sockaddr_in RecvFrom(char* buffer, int len, int flags = 0)
     {
         sockaddr_in from;
-        int size = sizeof(from);
+        socklen_t size = sizeof(from);
         int ret = recvfrom(sock, buffer, len, flags, reinterpret_cast<SOCKADDR*>(&from), &size);
         if (ret < 0)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "recvfrom failed");
+            throw std::system_error(GetLastSocketError(), std::system_category(), "recvfrom failed");
 
         // make the buffer zero terminated
         buffer[ret] = 0;
         return from;
     }
+
+    //Blocks until at least one datagram is available, then takes everything
+    //that's already queued up to count. Returns the number of datagrams filled.
+    int RecvBatch(Datagram* datagrams, int count)
+    {
+        if (count > MAX_DATAGRAM_BATCH) count = MAX_DATAGRAM_BATCH;
+
+#ifdef _WIN32
+        //Winsock has no recvmmsg, so block for the first one and then
+        //only keep reading while the socket says more is pending
+        int received = 0;
+        u_long pending = 1;
+        while (received < count && pending > 0)
+        {
+            Datagram* d = &datagrams[received];
+            socklen_t size = sizeof(d->address);
+            int ret = recvfrom(sock, d->data, MAX_DATAGRAM_SIZE, 0, reinterpret_cast<SOCKADDR*>(&d->address), &size);
+            if (ret < 0)
+            {
+                //Bigger than we ever send, so it's nothing of ours. Hand it on empty to be ignored
+                if (GetLastSocketError() != WSAEMSGSIZE)
+                    throw std::system_error(GetLastSocketError(), std::system_category(), "recvfrom failed");
+                ret = 0;
+            }
+            d->length = ret;
+            received++;
+
+            if (ioctlsocket(sock, FIONREAD, &pending) != 0) pending = 0;
+        }
+        return received;
+#else
+        mmsghdr msgs[MAX_DATAGRAM_BATCH];
+        iovec iovecs[MAX_DATAGRAM_BATCH];
+        for (int i = 0; i < count; i++)
+        {
+            iovecs[i].iov_base = datagrams[i].data;
+            iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &datagrams[i].address;
+            msgs[i].msg_hdr.msg_namelen = sizeof(datagrams[i].address);
+        }
+
+        int ret = recvmmsg(sock, msgs, count, MSG_WAITFORONE, nullptr);
+        if (ret < 0)
+            throw std::system_error(GetLastSocketError(), std::system_category(), "recvmmsg failed");
+
+        //Anything cut short was bigger than we ever send, so it's handed on empty to be ignored
+        for (int i = 0; i < ret; i++)
+            datagrams[i].length = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : (int)msgs[i].msg_len;
+        return ret;
+#endif
+    }
+
+    //Sends every datagram to its own address, as few syscalls as the platform allows
+    void SendBatch(Datagram* datagrams, int count)
+    {
+#ifdef _WIN32
+        for (int i = 0; i < count; i++)
+            SendTo(datagrams[i].address, datagrams[i].data, datagrams[i].length);
+#else
+        mmsghdr msgs[MAX_DATAGRAM_BATCH];
+        iovec iovecs[MAX_DATAGRAM_BATCH];
+
+        int sent = 0;
+        while (sent < count)
+        {
+            int batch = count - sent;
+            if (batch > MAX_DATAGRAM_BATCH) batch = MAX_DATAGRAM_BATCH;
+
+            for (int i = 0; i < batch; i++)
+            {
+                Datagram* d = &datagrams[sent + i];
+                iovecs[i].iov_base = d->data;
+                iovecs[i].iov_len = d->length;
+
+                msgs[i] = {};
+                msgs[i].msg_hdr.msg_iov = &iovecs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                msgs[i].msg_hdr.msg_name = &d->address;
+                msgs[i].msg_hdr.msg_namelen = sizeof(d->address);
+            }
+
+            int ret = sendmmsg(sock, msgs, batch, 0);
+            if (ret < 0)
+                throw std::system_error(GetLastSocketError(), std::system_category(), "sendmmsg failed");
+            sent += ret;
+        }
+#endif
+    }
+
+    //Waits up to timeoutMs for something to read. Returns false on timeout.
+    bool WaitReadable(int timeoutMs)
+    {
+#ifdef _WIN32
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(sock, &readSet);
+        timeval tv;
+        tv.tv_sec = timeoutMs / 1000;
+        tv.tv_usec = (timeoutMs % 1000) * 1000;
+        int ret = select(0, &readSet, nullptr, nullptr, &tv);
+#else
+        epoll_event ev;
+        int ret = epoll_wait(epollFD, &ev, 1, timeoutMs);
+        if (ret < 0 && errno == EINTR) return false;
+#endif
+        if (ret < 0)
+            throw std::system_error(GetLastSocketError(), std::system_category(), "wait failed");
+        return ret > 0;
+    }
+
     void Bind(unsigned short port)
     {
         sockaddr_in add;
@@ -76,9 +264,12 @@ public:
 
         int ret = bind(sock, reinterpret_cast<SOCKADDR*>(&add), sizeof(add));
         if (ret < 0)
-            throw std::system_error(WSAGetLastError(), std::system_category(), "Bind failed");
+            throw std::system_error(GetLastSocketError(), std::system_category(), "Bind failed");
     }
 
 private:
     SOCKET sock;
-};
\ No newline at end of file
+#ifndef _WIN32
+    int epollFD;
+#endif
+};
@@ -1,27 +1,51 @@
 #include "NetworkManager.h"
 #include <bitset>
+#include <chrono>
+
+using namespace DirectX;
 
 void NetworkManager::ReceiveFrom()
 {
 	while (running)
 	{
-		while (!newData)
+		Datagram* packet = packetPool.Acquire();
+		if (packet == nullptr)
 		{
-			try 
-			{
-				socket.RecvFrom(recvBuffer, 500);
-			}
-			catch (std::exception& ex)
+			//Update hasn't caught up yet, leave everything queued in the socket
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		try 
+		{
+			//Wakes up now and then so Disconnect can stop us
+			if (socket.WaitReadable(RECEIVE_POLL_MS) && socket.RecvBatch(packet, 1) > 0)
 			{
-				std::cout << "RecvFrom error." << std::endl;
-				running = false;
-				Disconnect();
+				std::lock_guard<std::mutex> guard(receivedLock);
+				receivedPackets.push_back(packet);
+				continue;
 			}
-			newData = true;
 		}
+		catch (std::exception& ex)
+		{
+			//Update notices and disconnects
+			std::cout << "RecvFrom error." << std::endl;
+			running = false;
+		}
+		packetPool.Release(packet);
 	}
 }
 
+Datagram* NetworkManager::NextReceived()
+{
+	std::lock_guard<std::mutex> guard(receivedLock);
+	if (receivedPackets.empty()) return nullptr;
+
+	Datagram* packet = receivedPackets.front();
+	receivedPackets.pop_front();
+	return packet;
+}
+
 NetworkManager::~NetworkManager()
 {
 
@@ -31,12 +55,23 @@ NetworkManager::~NetworkManager()
 		if (p == nullptr) continue;
 
 		auto it = find(entities->begin(), entities->end(), p);
-		auto it2 = find(remotePlayers.begin(), remotePlayers.end(), p);
-		entities->erase(it);
-		remotePlayers.erase(it2);
+		if (it != entities->end()) entities->erase(it);
 		delete p->GetCamera();
 		delete p;
 	}
+	remotePlayers.clear();
+
+	for (size_t i = 0; i < remoteProjectiles.size(); i++)
+	{
+		Projectile* p = remoteProjectiles[i];
+		if (p == nullptr) continue;
+
+		auto it = find(entities->begin(), entities->end(), p);
+		if (it != entities->end()) entities->erase(it);
+		delete p;
+	}
+	remoteProjectiles.clear();
+	remoteProjectileSystem.Resize(0);
 
 	if (state != NetworkState::Offline)
 	{
@@ -44,6 +79,104 @@ NetworkManager::~NetworkManager()
 	}
 }
 
+Player* NetworkManager::CreateRemotePlayer()
+{
+	Player* newPlayer = new Player(playerMesh, playerMat, new Camera(0, 10, -5, 3.0f, 1.0f, 1280.0f / 720.0f), false);
+	newPlayer->GetTransform()->SetPosition(0, -1, 0);
+	newPlayer->GetTransform()->SetScale(2, 2, 2);
+	newPlayer->GetTransform()->SetParent(newPlayer->GetCamera()->GetTransform(), false);
+	entities->push_back(newPlayer);
+	return newPlayer;
+}
+
+Projectile* NetworkManager::CreateRemoteProjectile(int index)
+{
+	Projectile* newProjectile = new Projectile(playerMesh, playerMat, 5, &remoteProjectileSystem, index);
+	newProjectile->dead = true;
+	newProjectile->GetTransform()->SetScale(0.2f, 0.2f, 0.2f);
+	newProjectile->Launch();
+	entities->push_back(newProjectile);
+	return newProjectile;
+}
+
+void NetworkManager::SendPacket(Datagram* packet, int length)
+{
+	try
+	{
+		socket.SendTo(IP, PORT, packet->data, length);
+	}
+	catch (std::exception& ex)
+	{
+		std::cout << "SendTo error." << std::endl;
+	}
+	packetPool.Release(packet);
+}
+
+void NetworkManager::SendConnectRequest(Player* local)
+{
+	Datagram* packet = packetPool.Acquire();
+	if (packet == nullptr) return; //Retried anyway
+
+	PacketWriter writer(packet->data, MAX_DATAGRAM_SIZE);
+	writer.WriteUInt32(1);
+	writer.WriteUInt32(connectCookie[0]);
+	writer.WriteUInt32(connectCookie[1]);
+
+	//Send initial position and velocity
+	CopyPlayerMovementData(local, &writer);
+
+	SendPacket(packet, writer.GetLength());
+}
+
+void NetworkManager::FlushReliable(double now)
+{
+	int length;
+	Datagram* packet;
+	while ((packet = packetPool.Acquire()) != nullptr)
+	{
+		length = reliable.WriteDue(now, playerID, packet->data, MAX_DATAGRAM_SIZE);
+		if (length == 0)
+		{
+			packetPool.Release(packet);
+			break;
+		}
+		SendPacket(packet, length);
+	}
+}
+
+void NetworkManager::HandleReliableMessage(const char* buffer, int length)
+{
+	PacketReader reader(buffer, length);
+	unsigned int msgType = reader.ReadUInt32();
+
+	switch (msgType)
+	{
+	case 1: //Connected request accepted
+	{
+		unsigned int id = reader.ReadUInt32();
+		unsigned int capacity = reader.ReadUInt32();
+		unsigned int slot = reader.ReadUInt32();
+		int projectileBlock = reader.ReadInt32();
+		unsigned int tickRate = reader.ReadUInt32();
+		if (reader.Overflowed()) break;
+
+		if (state == NetworkState::Connecting) state = NetworkState::Connected;
+
+		playerID = id;
+		playerSlot = slot;
+		projectilesPerPlayer = projectileBlock;
+		if (projectilesPerPlayer < 1) projectilesPerPlayer = MAX_PROJECTILES;
+		snapshotClock.SetTickRate(tickRate);
+		std::cout << "\nJoined as player " << playerSlot << std::endl;
+
+		//Remote players are made as they show up in world updates
+		if (remotePlayers.size() < capacity)
+			remotePlayers.resize(capacity, nullptr);
+	}
+	break;
+	}
+}
+
 NetworkResult NetworkManager::Connect(std::string ip, int port, Player* local, Mesh* mesh, Material* mat)
 {
 	
@@ -63,18 +196,24 @@ NetworkResult NetworkManager::Connect(std::string ip, int port, Player* local, M
 
 	}
 
-	//Clear buffers
-	std::fill_n(sendBuffer, 500, 0);
-	std::fill_n(recvBuffer, 500, 0);
-
-	unsigned int msgType = 1;
-
-	std::memcpy(&sendBuffer, &msgType, 4);
-
-	//Send initial position and velocity
-	CopyPlayerMovementData(local, &sendBuffer[0] + 4);
-
-	socket.SendTo(IP, PORT, sendBuffer, 500);
+	//Anything left over from the last session
+	Datagram* stale;
+	while ((stale = NextReceived()) != nullptr) packetPool.Release(stale);
+
+	//Nothing to build deltas on yet
+	receivedSnapshots.Clear();
+	ackedSnapshot = -1;
+	snapshotsReceived = 0;
+	snapshotClock.Reset();
+	for (size_t i = 0; i < remotePlayerBuffers.size(); i++) remotePlayerBuffers[i].Clear();
+	pendingInputs.clear();
+	inputSequence = 0;
+	reliable.Reset();
+	connectCookie[0] = connectCookie[1] = 0;
+
+	//Resent from Update until the accept comes back. The first one only gets a challenge
+	SendConnectRequest(local);
+	connectRetryTimer = 0;
 
 	running = true;
 	recvFromThread = std::thread(&NetworkManager::ReceiveFrom, this);
@@ -84,20 +223,24 @@ NetworkResult NetworkManager::Connect(std::string ip, int port, Player* local, M
 
 NetworkResult NetworkManager::Disconnect()
 {
-	std::fill_n(sendBuffer, 500, 0);
-
-	unsigned int msgType = 4;
-	std::memcpy(&sendBuffer, &msgType, 4);
-	msgType = playerID;
-	std::memcpy(&sendBuffer[0] + 4, &msgType, 4);
-	socket.SendTo(IP, PORT, sendBuffer, 500);
+	if (state == NetworkState::Connected)
+	{
+		char message[8];
+		PacketWriter writer(message, sizeof(message));
+		writer.WriteUInt32(4);
+		writer.WriteUInt32(playerID);
+		reliable.Send(message, writer.GetLength());
+
+		//Pretend time has passed so everything still unacknowledged goes out again each round
+		for (int i = 0; i < DISCONNECT_REPEAT; i++)
+			FlushReliable(clientTime + i * RELIABLE_RESEND_INTERVAL);
+	}
 
 	IP = "";
 	PORT = 0;
 	running = false;
-	newData = true;
 	//session.~WSASession();
-	recvFromThread.join();
+	if (recvFromThread.joinable()) recvFromThread.join();
 	//socket.~UDPSocket();
 	//socket = UDPSocket();
 	//session = WSASession();
@@ -107,7 +250,7 @@ NetworkResult NetworkManager::Disconnect()
 }
 
 //Takes 36 Bytes
-void NetworkManager::CopyPlayerMovementData(Player* player, char* bff)
+void NetworkManager::CopyPlayerMovementData(Player* player, PacketWriter* writer)
 {
 
 	float x = player->GetCamera()->GetTransform()->GetPosition().x;
@@ -115,14 +258,14 @@ void NetworkManager::CopyPlayerMovementData(Player* player, char* bff)
 	float z = player->GetCamera()->GetTransform()->GetPosition().z;
 
 	//Position x/y/z
-	std::memcpy(bff, &x, 4);
-	std::memcpy(bff + 4, &y, 4);
-	std::memcpy(bff + 8, &z, 4);
+	writer->WriteFloat(x);
+	writer->WriteFloat(y);
+	writer->WriteFloat(z);
 
 	//Velocity x/y/z
-	std::memcpy(bff + 12, &player->velocityX, 4);
-	std::memcpy(bff + 16, &player->velocityY, 4);
-	std::memcpy(bff + 20, &player->velocityZ, 4);
+	writer->WriteFloat(player->velocityX);
+	writer->WriteFloat(player->velocityY);
+	writer->WriteFloat(player->velocityZ);
 
 	//Rotation pitch/yaw/roll
 
@@ -130,47 +273,70 @@ void NetworkManager::CopyPlayerMovementData(Player* player, char* bff)
 	float yaw = player->GetCamera()->GetTransform()->GetPitchYawRoll().y;
 	float roll = player->GetCamera()->GetTransform()->GetPitchYawRoll().z;
 
-	std::memcpy(bff + 24, &pitch, 4);
-	std::memcpy(bff + 28, &yaw, 4);
-	std::memcpy(bff + 32, &roll, 4);
+	writer->WriteFloat(pitch);
+	writer->WriteFloat(yaw);
+	writer->WriteFloat(roll);
 }
 
-void NetworkManager::ReadPlayerMovementData(Player* player, char* buffer)
+void NetworkManager::ReadPlayerMovementData(InterpolationSample* sample, const PlayerSnapshot& snapshot, int positionBits)
 {
-	float* bff = (float*)buffer;
-
-	float posX, posY, posZ, velX, velY, velZ, pitch, yaw, roll;
-	posX = *bff;
-	posY = *(bff+1);
-	posZ = *(bff+2);
-	velX = *(bff+3);
-	velY = *(bff+4);
-	velZ = *(bff+5);
-	pitch = *(bff + 6);
-	yaw = *(bff + 7);
-	roll = *(bff + 8);
-
-	player->GetCamera()->GetTransform()->SetPosition(posX, posY, posZ);
-	player->SetVelocity(velX, velY, velZ);
-	player->GetCamera()->GetTransform()->SetRotation(pitch, yaw, roll);
+	sample->present = snapshot.present;
+	if (!snapshot.present) return;
+
+	float velX, velY, velZ, pitch, yaw, roll;
+	sample->position[0] = SnapshotCodec::DequantizePosition(snapshot.position[0], positionBits);
+	sample->position[1] = SnapshotCodec::DequantizePosition(snapshot.position[1], positionBits);
+	sample->position[2] = SnapshotCodec::DequantizePosition(snapshot.position[2], positionBits);
+	velX = SnapshotCodec::DequantizeVelocity(snapshot.velocity[0]);
+	velY = SnapshotCodec::DequantizeVelocity(snapshot.velocity[1]);
+	velZ = SnapshotCodec::DequantizeVelocity(snapshot.velocity[2]);
+	pitch = SnapshotCodec::DequantizeAngle(snapshot.rotation[0]);
+	yaw = SnapshotCodec::DequantizeAngle(snapshot.rotation[1]);
+	roll = SnapshotCodec::DequantizeAngle(snapshot.rotation[2]);
+
+	sample->rotation[0] = pitch;
+	sample->rotation[1] = yaw;
+	sample->rotation[2] = roll;
+
+	//Players move relative to where they're facing on x/z, same as Transform::MoveRelative
+	XMVECTOR rotQuat = XMQuaternionRotationRollPitchYaw(pitch, yaw, roll);
+	XMFLOAT3 worldVel;
+	XMStoreFloat3(&worldVel, XMVector3Rotate(XMVectorSet(velX, 0, velZ, 0), rotQuat));
+	sample->velocity[0] = worldVel.x;
+	sample->velocity[1] = worldVel.y + velY;
+	sample->velocity[2] = worldVel.z;
 }
 
-//Takes 40 bytes
-void NetworkManager::CopyProjectileMovementData(Projectile* projectile, char* bff)
+void NetworkManager::ApplyPlayerMovementData(Player* player, const InterpolationSample& sample)
+{
+	if (!sample.present)
+	{
+		//Empty slot, keep it out of sight
+		player->GetCamera()->GetTransform()->SetPosition(0, -5000, 0);
+		player->SetVelocity(0, 0, 0);
+		return;
+	}
+
+	player->GetCamera()->GetTransform()->SetPosition(sample.position[0], sample.position[1], sample.position[2]);
+	player->GetCamera()->GetTransform()->SetRotation(sample.rotation[0], sample.rotation[1], sample.rotation[2]);
+}
+
+//Takes 48 bytes
+void NetworkManager::CopyProjectileMovementData(Projectile* projectile, PacketWriter* writer)
 {
 	float x = projectile->GetTransform()->GetPosition().x;
 	float y = projectile->GetTransform()->GetPosition().y;
 	float z = projectile->GetTransform()->GetPosition().z;
 
 	//Position x/y/z
-	std::memcpy(bff, &x, 4);
-	std::memcpy(bff + 4, &y, 4);
-	std::memcpy(bff + 8, &z, 4);
+	writer->WriteFloat(x);
+	writer->WriteFloat(y);
+	writer->WriteFloat(z);
 
 	//Velocity x/y/z
-	std::memcpy(bff + 12, &projectile->velocityX, 4);
-	std::memcpy(bff + 16, &projectile->velocityY, 4);
-	std::memcpy(bff + 20, &projectile->velocityZ, 4);
+	writer->WriteFloat(projectile->velocityX);
+	writer->WriteFloat(projectile->velocityY);
+	writer->WriteFloat(projectile->velocityZ);
 
 	//Rotation pitch/yaw/roll
 
@@ -179,108 +345,132 @@ void NetworkManager::CopyProjectileMovementData(Projectile* projectile, char* bf
 	float roll = projectile->GetTransform()->GetPitchYawRoll().z;
 	float gravity = projectile->gravity;
 
-	std::memcpy(bff + 24, &pitch, 4);
-	std::memcpy(bff + 28, &yaw, 4);
-	std::memcpy(bff + 32, &roll, 4);
-	std::memcpy(bff + 36, &gravity, 4);
+	writer->WriteFloat(pitch);
+	writer->WriteFloat(yaw);
+	writer->WriteFloat(roll);
+	writer->WriteFloat(gravity);
 
 	//Age
-	float lifespan = projectile->lifespan;
-	float age = projectile->age;
-
-	std::memcpy(bff + 40, &lifespan, 4);
-	std::memcpy(bff + 44, &age, 4);
+	writer->WriteFloat(projectile->lifespan);
+	writer->WriteFloat(projectile->age);
 
 }
 
-void NetworkManager::ReadProjectileMovementData(Projectile* projectile, char* buffer)
+void NetworkManager::ReadProjectileMovementData(Projectile* projectile, const ProjectileSnapshot& snapshot, int positionBits)
 {
-	float* bff = (float*)buffer;
-
-	float posX, posY, posZ, velX, velY, velZ, pitch, yaw, roll, grav, lifespan, age;
-	posX = *bff;
-	posY = *(bff + 1);
-	posZ = *(bff + 2);
-	velX = *(bff + 3);
-	velY = *(bff + 4);
-	velZ = *(bff + 5);
-	pitch = *(bff + 6);
-	yaw = *(bff + 7);
-	roll = *(bff + 8);
-	grav = *(bff + 9);
-	lifespan = *(bff + 10);
-	age = *(bff + 11);
+	if (!snapshot.present)
+	{
+		//Dead on the server
+		projectile->dead = true;
+		projectile->Launch();
+		return;
+	}
+
+	float posX, posY, posZ;
+	posX = SnapshotCodec::DequantizePosition(snapshot.position[0], positionBits);
+	posY = SnapshotCodec::DequantizePosition(snapshot.position[1], positionBits);
+	posZ = SnapshotCodec::DequantizePosition(snapshot.position[2], positionBits);
 
 	projectile->GetTransform()->SetPosition(posX, posY, posZ);
-	projectile->SetVelocity(velX, velY, velZ, grav);
+	projectile->velocityY = SnapshotCodec::DequantizeVelocity(snapshot.velocityY);
+	projectile->age = SnapshotCodec::DequantizeTime(snapshot.age);
+	projectile->dead = false; //Fix for when the server resurrects a projectile and doesn't tell us
+
+	//Fixed fields, rebuilt from the baseline when the server didn't resend them
+	float velX, velZ, pitch, yaw, roll, grav;
+	velX = SnapshotCodec::DequantizeVelocity(snapshot.velocityX);
+	velZ = SnapshotCodec::DequantizeVelocity(snapshot.velocityZ);
+	pitch = SnapshotCodec::DequantizeAngle(snapshot.rotation[0]);
+	yaw = SnapshotCodec::DequantizeAngle(snapshot.rotation[1]);
+	roll = SnapshotCodec::DequantizeAngle(snapshot.rotation[2]);
+	grav = SnapshotCodec::DequantizeVelocity(snapshot.gravity);
+
+	projectile->SetVelocity(velX, projectile->velocityY, velZ, grav);
 	projectile->GetTransform()->SetRotation(pitch, yaw, roll);
-	projectile->lifespan = lifespan;
-	projectile->age = age;
+	projectile->lifespan = SnapshotCodec::DequantizeTime(snapshot.lifespan);
+	projectile->Launch();
 }
 
 void NetworkManager::AddNetworkProjectile(Projectile* projectile, int index)
 {
-	//Clear buffers
-	std::fill_n(sendBuffer, 500, 0);
+	char message[RELIABLE_MAX_PAYLOAD];
+	PacketWriter writer(message, sizeof(message));
 
-	unsigned int msgType = 3;
-	int ind = index;
-
-	std::memcpy(&sendBuffer, &msgType, 4);
-	std::memcpy(&sendBuffer[0] + 4, &ind, 4);
+	writer.WriteUInt32(3);
+	writer.WriteUInt32(playerID); //Server puts it in our block of projectiles
+	writer.WriteInt32(index);
 
 	//Send initial position and velocity
-	CopyProjectileMovementData(projectile, &sendBuffer[0] + 8);
+	CopyProjectileMovementData(projectile, &writer);
+
+	//A lost spawn would leave the projectile missing for everyone else, so it goes through the reliable channel
+	reliable.Send(message, writer.GetLength());
+	FlushReliable(clientTime);
+
+}
 
-	socket.SendTo(IP, PORT, sendBuffer, 500);
+void NetworkManager::Reconcile(Player* local, const WorldSnapshot& snapshot)
+{
+	//Already applied on the server
+	while (!pendingInputs.empty() && pendingInputs.front().sequence <= snapshot.ownerInputSequence)
+		pendingInputs.pop_front();
+
+	local->GetCamera()->GetTransform()->SetPosition(snapshot.ownerPosition[0], snapshot.ownerPosition[1], snapshot.ownerPosition[2]);
+	local->SetVelocity(snapshot.ownerVelocity[0], snapshot.ownerVelocity[1], snapshot.ownerVelocity[2]);
 
+	for (size_t i = 0; i < pendingInputs.size(); i++)
+		local->ApplyInput(pendingInputs[i]);
 }
 
 void NetworkManager::Update(float dt, Player* local, Projectile** projectiles)
 {
+	//The local player already moved this frame. Remember how, so it can be sent and replayed
+	if (state == NetworkState::Connected)
+	{
+		PlayerInput input = local->GetLastInput();
+		input.sequence = ++inputSequence;
+		pendingInputs.push_back(input);
+		if (pendingInputs.size() > MAX_PENDING_INPUTS) pendingInputs.pop_front();
+	}
+
+	//Receive thread gave up on the socket
+	if (!running && state != NetworkState::Offline) Disconnect();
 
-	while (newData)
+	Datagram* packet;
+	while ((packet = NextReceived()) != nullptr)
 	{
 
-		//Handle received data
-		unsigned int* msgType = (unsigned int*)&recvBuffer;
+		//Handle received data, in place
+		PacketReader reader(packet->data, packet->length);
+		unsigned int msgType = reader.ReadUInt32();
 
-		switch (*msgType)
+		switch (msgType)
 		{
-		case 1: //Connected request accepted
+		case 20: //Reliable message, handle everything that's now in order
 		{
-			if (state == NetworkState::Connecting) state = NetworkState::Connected;
-
-			std::cout << "\nJoined as player " << *(msgType + 1) << std::endl;
-			playerID = *(msgType + 1);
-			//Create the remote players'
-			if(remotePlayers.size() != *(msgType + 2))
-				for (size_t i = 0; i < *(msgType + 2); i++)
-				{
-					if (i == playerID)
-					{
-						remotePlayers.push_back(nullptr); //Reserved spot for the local player
-						continue;
-					}
-					Player* newPlayer = new Player(playerMesh, playerMat, new Camera(0, 10, -5, 3.0f, 1.0f, 1280.0f / 720.0f), false);
-					newPlayer->GetTransform()->SetPosition(0, -1, 0);
-					newPlayer->GetTransform()->SetScale(2, 2, 2);
-					newPlayer->GetTransform()->SetParent(newPlayer->GetCamera()->GetTransform(), false);
-					remotePlayers.push_back(newPlayer);
-					entities->push_back(newPlayer);
-				}
+			//The channel id is our player ID, which we only learn from the first message on it
+			if (!reliable.Receive(packet->data, packet->length)) break;
 
+			int length;
+			while ((length = reliable.Deliver(deliverBuffer, sizeof(deliverBuffer))) > 0)
+				HandleReliableMessage(deliverBuffer, length);
 		}
 		break;
+		case 5: //Challenge, ask again with the cookie to show we really are at this address
+			if (state == NetworkState::Connecting)
+			{
+				connectCookie[0] = reader.ReadUInt32();
+				connectCookie[1] = reader.ReadUInt32();
+				if (reader.Overflowed()) break;
+
+				SendConnectRequest(local);
+				connectRetryTimer = 0;
+			}
+			break;
 		case 2:
 			if (state == NetworkState::Connected) //Player joined
 			{
-				Player* newPlayer = new Player(playerMesh, playerMat, new Camera(0, 10, -5, 3.0f, 1.0f, 1280.0f / 720.0f), false);
-				newPlayer->GetTransform()->SetPosition(0, -1, 0);
-				newPlayer->GetTransform()->SetScale(2, 2, 2);
-				newPlayer->GetTransform()->SetParent(newPlayer->GetCamera()->GetTransform(), false);
-				remotePlayers.push_back(newPlayer);
-				entities->push_back(newPlayer);
+				remotePlayers.push_back(CreateRemotePlayer());
 			}
 			break;
 			//else if (*msgType == 3 && state == NetworkState::Connected) //New projectile
@@ -293,52 +483,150 @@ void NetworkManager::Update(float dt, Player* local, Projectile** projectiles)
 		case 10:
 			if (state == NetworkState::Connected) //Remote Player Update
 			{
-				for (size_t i = 0; i < remotePlayers.size(); i++)
+				if (!SnapshotCodec::Read(&snapshot, &receivedSnapshots, packet->data, packet->length)) break;
+				receivedSnapshots.Store(snapshot);
+				snapshotsReceived++;
+
+				//Arrived out of order, keep it as a baseline but don't move anything backwards
+				if (ackedSnapshot >= 0 && !SnapshotCodec::SequenceNewer(snapshot.sequence, (uint16_t)ackedSnapshot)) break;
+				ackedSnapshot = snapshot.sequence;
+
+				if (snapshot.hasOwnerState) Reconcile(local, snapshot);
+				reliable.ProcessAck(snapshot.reliableAck, snapshot.reliableAckBits);
+
+				InterpolationSample sample;
+				sample.time = snapshotClock.Observe(snapshot.sequence, clientTime);
+
+				//Session size is whatever the server says it is
+				if (remotePlayers.size() < snapshot.players.size())
+					remotePlayers.resize(snapshot.players.size(), nullptr);
+				if (remotePlayerBuffers.size() < remotePlayers.size())
+					remotePlayerBuffers.resize(remotePlayers.size());
+				if (remoteProjectiles.size() < snapshot.projectiles.size())
 				{
-					if (remotePlayers[i] == nullptr) continue;
+					remoteProjectiles.resize(snapshot.projectiles.size(), nullptr);
+					remoteProjectileSystem.Resize((int)remoteProjectiles.size());
+				}
 
-					ReadPlayerMovementData(remotePlayers[i], &recvBuffer[0] + 4 + (36 * i));
+				for (size_t i = 0; i < snapshot.players.size(); i++)
+				{
+					if (i == playerSlot) continue;
+					if (remotePlayers[i] == nullptr)
+					{
+						if (!snapshot.players[i].present) continue;
+						remotePlayers[i] = CreateRemotePlayer();
+					}
+
+					ReadPlayerMovementData(&sample, snapshot.players[i], snapshot.positionBits);
+					remotePlayerBuffers[i].Add(sample);
 				}
-				for (size_t i = 0; i < MAX_PROJECTILES; i++)
+				for (size_t i = 0; i < snapshot.projectiles.size(); i++)
 				{
-					ReadProjectileMovementData(*(projectiles + i), &recvBuffer[0] + 4 + (36 * remotePlayers.size()) + (48 * i));
-					Projectile* p = *(projectiles + i);
-					if (p->dead && p->age < p->lifespan) p->dead = false; //Fix for when the server resurrects a projectile and doesn't tell us
+					//Our own block maps onto the local pool
+					size_t owner = i / projectilesPerPlayer;
+					size_t index = i % projectilesPerPlayer;
+					if (owner == playerSlot)
+					{
+						if (index < MAX_PROJECTILES)
+							ReadProjectileMovementData(*(projectiles + index), snapshot.projectiles[i], snapshot.positionBits);
+						continue;
+					}
+
+					if (remoteProjectiles[i] == nullptr)
+					{
+						if (!snapshot.projectiles[i].present) continue;
+						remoteProjectiles[i] = CreateRemoteProjectile((int)i);
+					}
+
+					ReadProjectileMovementData(remoteProjectiles[i], snapshot.projectiles[i], snapshot.positionBits);
 				}
 			}
 			break;
 		}
-			//Clear buffer
-			std::fill_n(recvBuffer, 500, 0);
-			newData = false;
+		packetPool.Release(packet);
 	}
 
 
+	clientTime += dt;
+
+	//No answer yet, the request or the accept may have been lost
+	if (state == NetworkState::Connecting)
+	{
+		connectRetryTimer += dt;
+		if (connectRetryTimer >= CONNECT_RETRY_INTERVAL)
+		{
+			connectRetryTimer = 0;
+			SendConnectRequest(local);
+		}
+	}
+
 	if (state == NetworkState::Connected)
 	{
+		//Draw everyone else where they were interpolationDelay ago.
+		//If the server has slowed our updates down, far enough back to still have one either side
+		double delay = interpolationDelay;
+		double updateGap = 2 * snapshot.interval * snapshotClock.GetTickLength();
+		if (updateGap > delay) delay = updateGap;
+		double renderTime = snapshotClock.GetServerTime(clientTime) - delay;
 		for (size_t i = 0; i < remotePlayers.size(); i++)
 		{
 			if (remotePlayers[i] == nullptr) continue;
 
-			remotePlayers[i]->Update(dt);
+			InterpolationSample sample;
+			if (remotePlayerBuffers[i].Sample(renderTime, MAX_EXTRAPOLATION, &sample))
+				ApplyPlayerMovementData(remotePlayers[i], sample);
 		}
 
+		//Keep other players' projectiles moving between updates
+		remoteProjectileSystem.Update(dt);
+		for (size_t i = 0; i < remoteProjectiles.size(); i++)
+		{
+			if (remoteProjectiles[i] != nullptr) remoteProjectiles[i]->Sync();
+		}
 
-		//Send current player stats
-
-		//Clear buffers
-		std::fill_n(sendBuffer, 500, 0);
-
-		unsigned int msgType = 10;
-
-		std::memcpy(&sendBuffer, &msgType, 4);
-		msgType = playerID;
-		std::memcpy(&sendBuffer[0] + 4, &msgType, 4); //send player ID so the server can identify us
 
-		//Send current position and velocity
-		CopyPlayerMovementData(local, &sendBuffer[0] + 8);
+		//Send current player stats, written straight into a pooled packet
+		Datagram* packet = packetPool.Acquire();
+		if (packet != nullptr)
+		{
+			PacketWriter writer(packet->data, MAX_DATAGRAM_SIZE);
+
+			//The newest inputs the server hasn't confirmed, at most MAX_INPUTS_PER_PACKET, so a few lost packets cost nothing.
+			//Older ones are never resent: the server skips past them once it applies a newer one, and its
+			//reported position corrects our prediction for the movement they would have made
+			int count = (int)pendingInputs.size();
+			if (count > MAX_INPUTS_PER_PACKET) count = MAX_INPUTS_PER_PACKET;
+
+			//Which server tick we're drawing other players at, so the server can check our shots against it
+			unsigned int viewTick = NO_VIEW_TICK;
+			float viewFraction = 0;
+			if (snapshotClock.IsStarted())
+				viewTick = snapshotClock.GetTickAt(renderTime, &viewFraction);
+
+			//Reliable messages we have from the server
+			uint16_t reliableAck;
+			unsigned int reliableAckBits;
+			reliable.GetAck(&reliableAck, &reliableAckBits);
+
+			writer.WriteUInt32(10);
+			writer.WriteUInt32(playerID); //send player ID so the server can identify us
+			writer.WriteInt32(ackedSnapshot); //Newest world update, so the server can send deltas against it
+			writer.WriteInt32(count);
+			writer.WriteUInt32(viewTick);
+			writer.WriteFloat(viewFraction);
+			writer.WriteUInt32(reliableAck);
+			writer.WriteUInt32(reliableAckBits);
+			writer.WriteUInt32(snapshotsReceived);
+
+			size_t first = pendingInputs.size() - count;
+			for (int i = 0; i < count; i++)
+				PlayerMovement::WriteInput(pendingInputs[first + i], writer.Reserve(PLAYER_INPUT_SIZE));
+
+			SendPacket(packet, writer.GetLength());
+		}
 
-		socket.SendTo(IP, PORT, sendBuffer, 500);
+		//Anything reliable that's new or gone unacknowledged too long
+		FlushReliable(clientTime);
 
 	}
 
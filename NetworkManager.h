@@ -1,14 +1,39 @@
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 #include "Player.h"
 #include "Projectile.h"
 #include "Network.h"
+#include "Packet.h"
+#include "Snapshot.h"
+#include "Interpolation.h"
+#include "ReliableChannel.h"
 
+//Size of the local player's projectile pool. The server gives every player a block this big
 #define MAX_PROJECTILES 6
 
+//Inputs kept for replay while waiting on the server, a few seconds' worth
+#define MAX_PENDING_INPUTS 256
+
+//View tick sent before any world update has arrived
+#define NO_VIEW_TICK 0xFFFFFFFFu
+
+//Seconds between connect requests until the server answers
+#define CONNECT_RETRY_INTERVAL 0.5f
+
+//Disconnect can't wait around for an ack, so it goes out this many times instead
+#define DISCONNECT_REPEAT 3
+
+//Packet buffers shared by the receive thread and outgoing messages
+#define PACKET_POOL_SIZE 64
+
+//Milliseconds the receive thread waits on the socket before checking if it should stop
+#define RECEIVE_POLL_MS 100
+
 enum class NetworkState
 {
 	Offline,
@@ -31,13 +56,44 @@ private:
 	WSASession session;
 	UDPSocket socket;
 
-	unsigned int playerID;
-	char sendBuffer[500];
-	char recvBuffer[500];
-	bool newData;
-	bool running;
+	unsigned int playerID;   //Session token from the server, sent in every message so it knows us
+	unsigned int playerSlot; //Our index in world updates
+	int projectilesPerPlayer = MAX_PROJECTILES;
+	bool running = false;
+
+	//Received packets wait here, in arrival order, until Update handles and releases them
+	PacketPool packetPool{ PACKET_POOL_SIZE };
+	std::deque<Datagram*> receivedPackets;
+	std::mutex receivedLock;
 
+	//Indexed by slot, null until that slot is first seen in a world update
 	std::vector<Player*> remotePlayers;
+	std::vector<Projectile*> remoteProjectiles;
+	ProjectileSystem remoteProjectileSystem;
+
+	//Remote players are drawn a little in the past, blending between buffered updates
+	std::vector<InterpolationBuffer> remotePlayerBuffers;
+	SnapshotClock snapshotClock;
+	double clientTime = 0;
+	float interpolationDelay = DEFAULT_INTERPOLATION_DELAY;
+
+	//Last decoded world update, plus recent ones the server may send deltas against
+	WorldSnapshot snapshot;
+	SnapshotHistory receivedSnapshots;
+	int ackedSnapshot = -1;
+	uint32_t snapshotsReceived = 0; //Every world update decoded this session, the server works out loss from it
+
+	//Local inputs the server hasn't confirmed yet, oldest first
+	std::deque<PlayerInput> pendingInputs;
+	uint32_t inputSequence = 0;
+
+	//Join, projectile and disconnect messages, resent until the server acks them
+	ReliableChannel reliable;
+	char deliverBuffer[RELIABLE_MAX_PAYLOAD];
+	float connectRetryTimer = 0;
+
+	//Cookie from the server's challenge, echoed in connect requests to prove this address is ours. 0 until we get one
+	uint32_t connectCookie[2] = {};
 
 	NetworkState state = NetworkState::Offline;
 
@@ -45,6 +101,27 @@ private:
 
 	void ReceiveFrom();
 
+	//Oldest packet the receive thread has queued, null if there are none. Release it when done
+	Datagram* NextReceived();
+
+	//Sends the first length bytes of a pooled packet and hands it back to the pool
+	void SendPacket(Datagram* packet, int length);
+
+	//msgType 1 with our challenge cookie and where the local player starts
+	void SendConnectRequest(Player* local);
+
+	//Handles a message unwrapped from the reliable channel
+	void HandleReliableMessage(const char* buffer, int length);
+
+	//Sends everything the reliable channel has due. now is in clientTime seconds
+	void FlushReliable(double now);
+
+	//Moves the local player to where the server has it, then replays the inputs the server hasn't seen
+	void Reconcile(Player* local, const WorldSnapshot& snapshot);
+
+	Player* CreateRemotePlayer();
+	Projectile* CreateRemoteProjectile(int index);
+
 	//Data required to make remote players
 	Mesh* playerMesh;
 	Material* playerMat;
@@ -61,14 +138,19 @@ public:
 	NetworkResult Connect(std::string ip, int port, Player* local, Mesh* mesh, Material* mat);
 	NetworkResult Disconnect();
 
-	void CopyPlayerMovementData(Player* player, char* bff);
-	void ReadPlayerMovementData(Player* player, char* buffer);
+	void CopyPlayerMovementData(Player* player, PacketWriter* writer);
+	void ReadPlayerMovementData(InterpolationSample* sample, const PlayerSnapshot& snapshot, int positionBits);
+	void ApplyPlayerMovementData(Player* player, const InterpolationSample& sample);
 
-	void CopyProjectileMovementData(Projectile* projectile, char* bff);
-	void ReadProjectileMovementData(Projectile* projectile, char* buffer);
+	void CopyProjectileMovementData(Projectile* projectile, PacketWriter* writer);
+	void ReadProjectileMovementData(Projectile* projectile, const ProjectileSnapshot& snapshot, int positionBits);
 
 	void AddNetworkProjectile(Projectile* projectile, int index);
 
+	//Seconds remote players lag behind the newest update. Higher rides out more jitter and loss
+	void SetInterpolationDelay(float seconds) { interpolationDelay = seconds; }
+	float GetInterpolationDelay() { return interpolationDelay; }
+
 	void Update(float dt, Player* local, Projectile** projectiles);
 
 };
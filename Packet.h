@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "Network.h"
+
+//Serializes fixed size fields straight into a packet buffer, in the order they're written.
+//Writing past the end sets the overflow flag instead of touching memory.
+class PacketWriter
+{
+private:
+
+	char* buffer;
+	int capacity;
+	int length = 0;
+	bool overflow = false;
+
+public:
+
+	PacketWriter(char* buffer, int capacity) : buffer(buffer), capacity(capacity) {}
+
+	void WriteBytes(const void* data, int bytes)
+	{
+		char* dest = Reserve(bytes);
+		if (dest != nullptr) std::memcpy(dest, data, bytes);
+	}
+
+	void WriteUInt32(uint32_t value) { WriteBytes(&value, 4); }
+	void WriteInt32(int32_t value) { WriteBytes(&value, 4); }
+	void WriteFloat(float value) { WriteBytes(&value, 4); }
+
+	//Claims the next bytes for the caller to fill in place. Null if they don't fit
+	char* Reserve(int bytes)
+	{
+		if (overflow || bytes > capacity - length) { overflow = true; return nullptr; }
+
+		char* dest = buffer + length;
+		length += bytes;
+		return dest;
+	}
+
+	//Bytes written so far, all that needs sending
+	int GetLength() { return length; }
+	bool Overflowed() { return overflow; }
+
+};
+
+//Reads fields written by PacketWriter. Reading past the end returns zeros and sets the overflow flag.
+class PacketReader
+{
+private:
+
+	const char* buffer;
+	int length;
+	int position = 0;
+	bool overflow = false;
+
+public:
+
+	PacketReader(const char* buffer, int length) : buffer(buffer), length(length) {}
+
+	//The next bytes, read in place. Null if there aren't that many left
+	const char* ReadBytes(int bytes)
+	{
+		if (overflow || bytes > length - position) { overflow = true; return nullptr; }
+
+		const char* src = buffer + position;
+		position += bytes;
+		return src;
+	}
+
+	uint32_t ReadUInt32()
+	{
+		uint32_t value = 0;
+		const char* src = ReadBytes(4);
+		if (src != nullptr) std::memcpy(&value, src, 4);
+		return value;
+	}
+
+	int32_t ReadInt32() { return (int32_t)ReadUInt32(); }
+
+	float ReadFloat()
+	{
+		float value = 0;
+		const char* src = ReadBytes(4);
+		if (src != nullptr) std::memcpy(&value, src, 4);
+		return value;
+	}
+
+	int GetRemaining() { return length - position; }
+	bool Overflowed() { return overflow; }
+
+};
+
+//Fixed set of datagram buffers that are handed out and returned instead of allocated or cleared per message.
+//Only the length that was written or received is ever valid, the rest of a buffer is left as it was.
+//Safe to use from more than one thread, so a receive thread can fill packets the game loop releases.
+class PacketPool
+{
+private:
+
+	std::vector<Datagram> packets;
+	std::vector<Datagram*> freePackets;
+	std::mutex lock;
+
+public:
+
+	PacketPool(int count) : packets(count)
+	{
+		freePackets.reserve(count);
+		for (int i = count - 1; i >= 0; i--)
+			freePackets.push_back(&packets[i]);
+	}
+
+	//Null when every packet is in use
+	Datagram* Acquire()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (freePackets.empty()) return nullptr;
+
+		Datagram* packet = freePackets.back();
+		freePackets.pop_back();
+		packet->length = 0;
+		return packet;
+	}
+
+	void Release(Datagram* packet)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		freePackets.push_back(packet);
+	}
+
+	int GetFreeCount()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		return (int)freePackets.size();
+	}
+
+};
@@ -10,11 +10,9 @@ Player::Player(Mesh* mesh, Material* material, Camera* camera, bool local) : Gam
 void Player::Update(float dt)
 {
 
-	float speed = moveSpeed;
-
-	float x = camera->GetTransform()->GetPosition().x;
-	float y = camera->GetTransform()->GetPosition().y;
-	float z = camera->GetTransform()->GetPosition().z;
+	// The server ignores inputs longer than MAX_INPUT_DT, so a long frame only asks for that much
+	PlayerInput in = {};
+	in.dt = dt > MAX_INPUT_DT ? MAX_INPUT_DT : dt;
 
 	// Get the input manager instance
 	Input& input = Input::GetInstance();
@@ -23,16 +21,15 @@ void Player::Update(float dt)
 	{
 
 		// Speed up or down as necessary
-		if (input.KeyDown(VK_SHIFT)) { speed *= 1.6f; }
-		if (input.KeyDown(VK_CONTROL)) { speed *= 0.5f; }
+		if (input.KeyDown(VK_SHIFT)) { in.buttons |= INPUT_SPRINT; }
+		if (input.KeyDown(VK_CONTROL)) { in.buttons |= INPUT_WALK; }
 
 		// Movement
-		if (input.KeyDown('W')) { velocityZ = speed; }
-		else if (input.KeyDown('S')) { velocityZ = -speed; }
-		else velocityZ = 0;
-		if (input.KeyDown('A')) { velocityX = -speed; }
-		else if (input.KeyDown('D')) { velocityX = speed; }
-		else velocityX = 0;
+		if (input.KeyDown('W')) { in.buttons |= INPUT_FORWARD; }
+		else if (input.KeyDown('S')) { in.buttons |= INPUT_BACK; }
+		if (input.KeyDown('A')) { in.buttons |= INPUT_LEFT; }
+		else if (input.KeyDown('D')) { in.buttons |= INPUT_RIGHT; }
+		if (input.KeyDown(' ')) { in.buttons |= INPUT_JUMP; }
 		//if (input.KeyDown('X')) { camera->GetTransform()->MoveAbsolute(0, -speed, 0); }
 
 		// Handle mouse movement only when button is down
@@ -48,24 +45,26 @@ void Player::Update(float dt)
 
 	//Movement
 
-	if (y > floorHeight)
-	{
-		velocityY += gravity * dt;
-	}
-	else if (y <= floorHeight)
-	{
-		velocityY = 0;
-		y = floorHeight;
-	}
+	DirectX::XMFLOAT3 rot = camera->GetTransform()->GetPitchYawRoll();
+	in.pitch = rot.x;
+	in.yaw = rot.y;
+	in.roll = rot.z;
 
-	//Jump
-	if (localPlayer && input.KeyDown(' ') && y <= floorHeight) { velocityY = jumpForce; }
+	lastInput = in;
+	ApplyInput(in);
+
+}
+
+void Player::ApplyInput(const PlayerInput& input)
+{
+	Transform* tf = camera->GetTransform();
+	DirectX::XMFLOAT3 pos = tf->GetPosition();
 
-	camera->GetTransform()->MoveRelative(velocityX * dt, 0, velocityZ * dt);
-	x = camera->GetTransform()->GetPosition().x;
-	z = camera->GetTransform()->GetPosition().z;
-	camera->GetTransform()->SetPosition(x, y + velocityY * dt, z);
+	MovementState state = { { pos.x, pos.y, pos.z }, { velocityX, velocityY, velocityZ } };
+	PlayerMovement::Simulate(&state, input);
 
+	tf->SetPosition(state.position[0], state.position[1], state.position[2]);
+	SetVelocity(state.velocity[0], state.velocity[1], state.velocity[2]);
 }
 
 void Player::SetVelocity(float x, float y, float z)
@@ -1,22 +1,20 @@
 #pragma once
 #include "GameEntity.h"
 #include "Camera.h"
+#include "PlayerMovement.h"
 
 class Player : public GameEntity
 {
 private:
 
-	float moveSpeed = 15.0f;
-	float gravity = -19.6f;
-	float jumpForce = 8;
 	float mouseLookSpeed = 1.0f;
 
 	Camera* camera;
 
 	bool localPlayer;
 
-	//TEMPORARY
-	float floorHeight = -3;
+	//What the local player did on the last Update
+	PlayerInput lastInput = {};
 
 public:
 
@@ -26,6 +24,10 @@ public:
 
 	void Update(float dt);
 
+	//Runs one input through the shared movement code, for both prediction and replay
+	void ApplyInput(const PlayerInput& input);
+	const PlayerInput& GetLastInput() { return lastInput; }
+
 	void SetVelocity(float x, float y, float z);
 
 	float velocityX;
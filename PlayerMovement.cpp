@@ -0,0 +1,83 @@
+#include "PlayerMovement.h"
+
+#include <cmath>
+#include <cstring>
+
+static const float MOVE_SPEED = 15.0f;
+static const float SPRINT_MULTIPLIER = 1.6f;
+static const float WALK_MULTIPLIER = 0.5f;
+static const float GRAVITY = -19.6f;
+static const float JUMP_FORCE = 8;
+
+//TEMPORARY
+static const float FLOOR_HEIGHT = -3;
+
+void PlayerMovement::Simulate(MovementState* state, const PlayerInput& input)
+{
+	//Negated so a NaN step becomes no step instead of reaching the position
+	float dt = input.dt;
+	if (!(dt >= 0)) dt = 0;
+	if (dt > MAX_INPUT_DT) dt = MAX_INPUT_DT;
+
+	float speed = MOVE_SPEED;
+	if (input.buttons & INPUT_SPRINT) speed *= SPRINT_MULTIPLIER;
+	if (input.buttons & INPUT_WALK) speed *= WALK_MULTIPLIER;
+
+	float* vel = state->velocity;
+	float* pos = state->position;
+
+	if (input.buttons & INPUT_FORWARD) vel[2] = speed;
+	else if (input.buttons & INPUT_BACK) vel[2] = -speed;
+	else vel[2] = 0;
+	if (input.buttons & INPUT_LEFT) vel[0] = -speed;
+	else if (input.buttons & INPUT_RIGHT) vel[0] = speed;
+	else vel[0] = 0;
+
+	float y = pos[1];
+	if (y > FLOOR_HEIGHT)
+	{
+		vel[1] += GRAVITY * dt;
+	}
+	else
+	{
+		vel[1] = 0;
+		y = FLOOR_HEIGHT;
+	}
+
+	if ((input.buttons & INPUT_JUMP) && y <= FLOOR_HEIGHT) vel[1] = JUMP_FORCE;
+
+	//Move along x/z rotated by roll, then pitch, then yaw, like Transform::MoveRelative.
+	//Only the horizontal part is kept, height comes from vertical velocity alone
+	float x = vel[0] * dt;
+	float z = vel[2] * dt;
+	float cp = cosf(input.pitch), sp = sinf(input.pitch);
+	float cy = cosf(input.yaw), sy = sinf(input.yaw);
+	float cr = cosf(input.roll), sr = sinf(input.roll);
+
+	float a = x * cr;
+	float c = x * sr * sp + z * cp;
+	pos[0] += a * cy + c * sy;
+	pos[2] += c * cy - a * sy;
+	pos[1] = y + vel[1] * dt;
+}
+
+//Takes 24 bytes
+void PlayerMovement::WriteInput(const PlayerInput& input, char* bff)
+{
+	std::memcpy(bff, &input.sequence, 4);
+	std::memcpy(bff + 4, &input.buttons, 4);
+	std::memcpy(bff + 8, &input.pitch, 4);
+	std::memcpy(bff + 12, &input.yaw, 4);
+	std::memcpy(bff + 16, &input.roll, 4);
+	std::memcpy(bff + 20, &input.dt, 4);
+}
+
+void PlayerMovement::ReadInput(const char* bff, PlayerInput* input)
+{
+	std::memcpy(&input->sequence, bff, 4);
+	std::memcpy(&input->buttons, bff + 4, 4);
+	std::memcpy(&input->pitch, bff + 8, 4);
+	std::memcpy(&input->yaw, bff + 12, 4);
+	std::memcpy(&input->roll, bff + 16, 4);
+	std::memcpy(&input->dt, bff + 20, 4);
+}
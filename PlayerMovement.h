@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+//Buttons held down for one input command
+#define INPUT_FORWARD (1 << 0)
+#define INPUT_BACK    (1 << 1)
+#define INPUT_LEFT    (1 << 2)
+#define INPUT_RIGHT   (1 << 3)
+#define INPUT_JUMP    (1 << 4)
+#define INPUT_SPRINT  (1 << 5)
+#define INPUT_WALK    (1 << 6)
+
+//Bytes one input takes on the wire
+#define PLAYER_INPUT_SIZE 24
+
+//Longest step a single input may ask for, in seconds
+#define MAX_INPUT_DT 0.1f
+
+//Most inputs the client packs into one msgType 10, the newest unconfirmed ones.
+//Inputs that fall out of this window before the server confirms them are never resent
+#define MAX_INPUTS_PER_PACKET 16
+
+//One frame of player input. The client predicts with it and the server replays it
+struct PlayerInput
+{
+	uint32_t sequence;
+	uint32_t buttons;
+	float pitch;
+	float yaw;
+	float roll;
+	float dt;
+};
+
+//What movement changes. velocity x/z are relative to where the player faces, y is world up
+struct MovementState
+{
+	float position[3];
+	float velocity[3];
+};
+
+//Player movement shared by the client and server, so both get the same answer from the same inputs
+class PlayerMovement
+{
+public:
+
+	static void Simulate(MovementState* state, const PlayerInput& input);
+
+	static void WriteInput(const PlayerInput& input, char* bff);
+	static void ReadInput(const char* bff, PlayerInput* input);
+
+};
@@ -1,9 +1,11 @@
 #include "Projectile.h"
 
-Projectile::Projectile(Mesh* mesh, Material* material, float lifespan) : GameEntity(mesh, material)
+Projectile::Projectile(Mesh* mesh, Material* material, float lifespan, ProjectileSystem* system, int index) : GameEntity(mesh, material)
 {
 
 	Projectile::lifespan = lifespan;
+	Projectile::system = system;
+	Projectile::index = index;
 
 	velocityX = 0;
 	velocityY = 0;
@@ -20,15 +22,41 @@ void Projectile::SetVelocity(float x, float y, float z, float g)
 	gravity = g;
 }
 
-void Projectile::Update(float dt)
+void Projectile::Launch()
 {
-	age += dt;
-
-	if (age >= lifespan) dead = true;
-
-	velocityY += gravity * dt;
-	transform.MoveRelative(velocityX * dt, velocityY * dt, velocityZ * dt);
+	if (dead)
+	{
+		system->Kill(index);
+		Sync();
+		return;
+	}
+
+	ProjectileState state;
+	DirectX::XMFLOAT3 pos = transform.GetPosition();
+	DirectX::XMFLOAT3 rot = transform.GetPitchYawRoll();
+
+	state.position[0] = pos.x;
+	state.position[1] = pos.y;
+	state.position[2] = pos.z;
+	state.rotation[0] = rot.x;
+	state.rotation[1] = rot.y;
+	state.rotation[2] = rot.z;
+	state.velocity[0] = velocityX;
+	state.velocity[1] = velocityY;
+	state.velocity[2] = velocityZ;
+	state.gravity = gravity;
+	state.lifespan = lifespan;
+	state.age = age;
+
+	system->Launch(index, state);
+}
 
-	if (transform.GetPosition().y <= -6) dead = true;
+void Projectile::Sync()
+{
+	DirectX::XMFLOAT3 pos = system->GetPosition(index);
+	transform.SetPosition(pos.x, pos.y, pos.z);
 
+	velocityY = system->GetLocalVelocityY(index);
+	age = system->GetAge(index);
+	dead = !system->IsAlive(index);
 }
@@ -1,10 +1,14 @@
 #pragma once
 #include "GameEntity.h"
+#include "ProjectileSystem.h"
 class Projectile :
     public GameEntity
 {
 private:
 
+    //Flight is simulated in here, along with the rest of the pool this projectile belongs to
+    ProjectileSystem* system;
+    int index;
 
 public:
 
@@ -17,10 +21,15 @@ public:
     float lifespan;
     float age;
 
-    Projectile(Mesh* mesh, Material* material, float lifespan);
+    Projectile(Mesh* mesh, Material* material, float lifespan, ProjectileSystem* system, int index);
 
     void SetVelocity(float x, float y, float z, float g);
-    void Update(float dt);
+
+    //Hands the transform and the fields above to the system. Call after changing any of them
+    void Launch();
+
+    //Copies where the system has moved it back into the transform and fields, after it updates
+    void Sync();
 
     bool dead = false;
 
@@ -0,0 +1,178 @@
+#include "ProjectileSystem.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PROJECTILE_SYSTEM_SSE
+#include <emmintrin.h>
+#endif
+
+using namespace VectorMath;
+
+void ProjectileSystem::Resize(int projectiles)
+{
+	if (projectiles < 0) projectiles = 0;
+	count = projectiles;
+
+	positionX.resize(count, 0); positionY.resize(count, PROJECTILE_PARKED_Y); positionZ.resize(count, 0);
+	velocityX.resize(count, 0); velocityY.resize(count, 0); velocityZ.resize(count, 0);
+	gravityX.resize(count, 0); gravityY.resize(count, 0); gravityZ.resize(count, 0);
+	localVelocityX.resize(count, 0); localVelocityY.resize(count, 0); localVelocityZ.resize(count, 0);
+	gravity.resize(count, 0);
+	age.resize(count, 0);
+	lifespan.resize(count, 0);
+	alive.resize(count, 0);
+	pitch.resize(count, 0); yaw.resize(count, 0); roll.resize(count, 0);
+}
+
+void ProjectileSystem::Launch(int index, const ProjectileState& state)
+{
+	positionX[index] = state.position[0];
+	positionY[index] = state.position[1];
+	positionZ[index] = state.position[2];
+
+	pitch[index] = state.rotation[0];
+	yaw[index] = state.rotation[1];
+	roll[index] = state.rotation[2];
+
+	localVelocityX[index] = state.velocity[0];
+	localVelocityY[index] = state.velocity[1];
+	localVelocityZ[index] = state.velocity[2];
+	gravity[index] = state.gravity;
+
+	//The only rotation a projectile ever needs
+	Vector rotation = QuaternionRotationRollPitchYaw(state.rotation[0], state.rotation[1], state.rotation[2]);
+	float3 velocity, pull;
+	StoreFloat3(&velocity, Vector3Rotate(VectorSet(state.velocity[0], state.velocity[1], state.velocity[2], 0), rotation));
+	StoreFloat3(&pull, Vector3Rotate(VectorSet(0, state.gravity, 0, 0), rotation));
+
+	velocityX[index] = velocity.x; velocityY[index] = velocity.y; velocityZ[index] = velocity.z;
+	gravityX[index] = pull.x; gravityY[index] = pull.y; gravityZ[index] = pull.z;
+
+	lifespan[index] = state.lifespan;
+	age[index] = state.age;
+	alive[index] = 0xFFFFFFFFu;
+}
+
+void ProjectileSystem::Kill(int index)
+{
+	alive[index] = 0;
+	positionX[index] = 0;
+	positionY[index] = PROJECTILE_PARKED_Y;
+	positionZ[index] = 0;
+}
+
+void ProjectileSystem::UpdateScalar(float dt, int begin, int end)
+{
+	for (int i = begin; i < end; i++)
+	{
+		if (!alive[i]) continue;
+
+		age[i] += dt;
+		localVelocityY[i] += gravity[i] * dt;
+		velocityX[i] += gravityX[i] * dt;
+		velocityY[i] += gravityY[i] * dt;
+		velocityZ[i] += gravityZ[i] * dt;
+		positionX[i] += velocityX[i] * dt;
+		positionY[i] += velocityY[i] * dt;
+		positionZ[i] += velocityZ[i] * dt;
+
+		if (age[i] >= lifespan[i] || positionY[i] <= PROJECTILE_FLOOR_Y) Kill(i);
+	}
+}
+
+#ifdef PROJECTILE_SYSTEM_SSE
+
+//mask ? a : b, lane by lane
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//value += step * dt in the lanes of live projectiles
+static inline __m128 Integrate(float* value, const float* step, __m128 dt, __m128 live)
+{
+	__m128 old = _mm_loadu_ps(value);
+	__m128 next = _mm_add_ps(old, _mm_mul_ps(_mm_loadu_ps(step), dt));
+	next = Select(live, next, old);
+	_mm_storeu_ps(value, next);
+	return next;
+}
+
+void ProjectileSystem::Update(float dt, int begin, int end)
+{
+	if (end > count) end = count;
+
+	__m128 step = _mm_set1_ps(dt);
+	__m128 floorY = _mm_set1_ps(PROJECTILE_FLOOR_Y);
+	__m128 parkedY = _mm_set1_ps(PROJECTILE_PARKED_Y);
+	__m128 zero = _mm_setzero_ps();
+
+	int i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 live = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&alive[i])));
+		if (_mm_movemask_ps(live) == 0) continue; //Four dead ones, already parked
+
+		__m128 newAge = _mm_add_ps(_mm_loadu_ps(&age[i]), step);
+		_mm_storeu_ps(&age[i], Select(live, newAge, _mm_loadu_ps(&age[i])));
+
+		Integrate(&localVelocityY[i], &gravity[i], step, live);
+		Integrate(&velocityX[i], &gravityX[i], step, live);
+		Integrate(&velocityY[i], &gravityY[i], step, live);
+		Integrate(&velocityZ[i], &gravityZ[i], step, live);
+
+		__m128 x = _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(_mm_loadu_ps(&velocityX[i]), step));
+		__m128 y = _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(_mm_loadu_ps(&velocityY[i]), step));
+		__m128 z = _mm_add_ps(_mm_loadu_ps(&positionZ[i]), _mm_mul_ps(_mm_loadu_ps(&velocityZ[i]), step));
+
+		//Still flying if it was, hasn't outlived its lifespan and is above the floor. The rest get parked
+		__m128 flying = _mm_and_ps(live, _mm_and_ps(_mm_cmplt_ps(newAge, _mm_loadu_ps(&lifespan[i])), _mm_cmpgt_ps(y, floorY)));
+		_mm_storeu_ps(&positionX[i], Select(flying, x, zero));
+		_mm_storeu_ps(&positionY[i], Select(flying, y, parkedY));
+		_mm_storeu_ps(&positionZ[i], Select(flying, z, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&alive[i]), _mm_castps_si128(flying));
+	}
+
+	UpdateScalar(dt, i, end);
+}
+
+#else
+
+void ProjectileSystem::Update(float dt, int begin, int end)
+{
+	if (end > count) end = count;
+	UpdateScalar(dt, begin, end);
+}
+
+#endif
+
+void ProjectileSystem::GetState(int index, ProjectileState* state)
+{
+	state->position[0] = positionX[index];
+	state->position[1] = positionY[index];
+	state->position[2] = positionZ[index];
+
+	state->rotation[0] = pitch[index];
+	state->rotation[1] = yaw[index];
+	state->rotation[2] = roll[index];
+
+	state->velocity[0] = localVelocityX[index];
+	state->velocity[1] = localVelocityY[index];
+	state->velocity[2] = localVelocityZ[index];
+
+	state->gravity = gravity[index];
+	state->lifespan = lifespan[index];
+	state->age = age[index];
+}
+
+void ProjectileSystem::GetSweep(int index, float timeStep, float3* start, float3* end)
+{
+	//Same steps as Update: velocity first, then position
+	float vx = velocityX[index] + gravityX[index] * timeStep;
+	float vy = velocityY[index] + gravityY[index] * timeStep;
+	float vz = velocityZ[index] + gravityZ[index] * timeStep;
+
+	*start = GetPosition(index);
+	end->x = start->x + vx * timeStep;
+	end->y = start->y + vy * timeStep;
+	end->z = start->z + vz * timeStep;
+}
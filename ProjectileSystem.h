@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "VectorMath.h"
+
+//Where dead projectiles are kept, far below the world
+#define PROJECTILE_PARKED_Y -5000.0f
+
+//Projectiles that fall to here are dead
+#define PROJECTILE_FLOOR_Y -6.0f
+
+//One projectile the way it's launched and sent over the network: a velocity relative to
+//its orientation, with gravity pulling along its own up axis
+struct ProjectileState
+{
+	float position[3];
+	float rotation[3]; //pitch/yaw/roll
+	float velocity[3]; //Local space, only y changes in flight
+	float gravity;
+	float lifespan;
+	float age;
+};
+
+//Flight of every projectile in a pool, shared by the client and server so both move them the same way.
+//Orientation never changes after launch, so the local velocity and gravity are rotated into world space once
+//in Launch. Update is then plain adds over flat per-axis arrays, four projectiles at a time.
+class ProjectileSystem
+{
+private:
+
+	int count = 0;
+
+	//Touched every update
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> velocityX, velocityY, velocityZ; //World space
+	std::vector<float> gravityX, gravityY, gravityZ;    //World space acceleration
+	std::vector<float> localVelocityY;
+	std::vector<float> gravity;
+	std::vector<float> age, lifespan;
+	std::vector<uint32_t> alive; //All bits set or none, so it doubles as a SIMD mask
+
+	//Only read to describe a projectile to the network
+	std::vector<float> localVelocityX, localVelocityZ;
+	std::vector<float> pitch, yaw, roll;
+
+	void UpdateScalar(float dt, int begin, int end);
+
+public:
+
+	//Keeps existing projectiles, new ones start dead
+	void Resize(int projectiles);
+	int Count() { return count; }
+
+	//Starts or corrects a projectile from its network description
+	void Launch(int index, const ProjectileState& state);
+
+	//Parks it out of the world until it's launched again
+	void Kill(int index);
+
+	//Moves every live projectile in [begin, end) by dt and kills any that expire or hit the floor.
+	//Separate ranges can update on separate threads
+	void Update(float dt, int begin, int end);
+	void Update(float dt) { Update(dt, 0, count); }
+
+	//Current state in the form Launch takes
+	void GetState(int index, ProjectileState* state);
+
+	//World space segment the projectile covers over the next update of timeStep
+	void GetSweep(int index, float timeStep, VectorMath::float3* start, VectorMath::float3* end);
+
+	bool IsAlive(int index) { return alive[index] != 0; }
+	float GetAge(int index) { return age[index]; }
+	float GetLocalVelocityY(int index) { return localVelocityY[index]; }
+	VectorMath::float3 GetPosition(int index) { return VectorMath::float3(positionX[index], positionY[index], positionZ[index]); }
+
+};
@@ -0,0 +1,153 @@
+#include "ReliableChannel.h"
+
+#include <cstring>
+
+static bool SequenceNewer(uint16_t a, uint16_t b)
+{
+	return (int16_t)(a - b) > 0;
+}
+
+void ReliableChannel::Reset()
+{
+	for (int i = 0; i < RELIABLE_WINDOW; i++)
+	{
+		outgoing[i].pending = false;
+		incoming[i].ready = false;
+	}
+	nextSequence = 0;
+	oldestUnacked = 0;
+	nextDeliver = 0;
+	receivedAny = false;
+	newestReceived = 0;
+	receivedBits = 0;
+}
+
+bool ReliableChannel::Send(const char* data, int length)
+{
+	if (length <= 0 || length > RELIABLE_MAX_PAYLOAD) return false;
+	if ((uint16_t)(nextSequence - oldestUnacked) >= RELIABLE_WINDOW) return false;
+
+	Outgoing& o = outgoing[nextSequence % RELIABLE_WINDOW];
+	o.pending = true;
+	o.sequence = nextSequence;
+	o.length = length;
+	o.lastSent = -1;
+	std::memcpy(o.data, data, length);
+
+	nextSequence++;
+	return true;
+}
+
+int ReliableChannel::WriteDue(double now, uint32_t connectionID, char* buffer, int capacity)
+{
+	for (uint16_t s = oldestUnacked; s != nextSequence; s++)
+	{
+		Outgoing& o = outgoing[s % RELIABLE_WINDOW];
+		if (!o.pending) continue;
+		if (o.lastSent >= 0 && now - o.lastSent < RELIABLE_RESEND_INTERVAL) continue;
+
+		int length = RELIABLE_HEADER_SIZE + o.length;
+		if (length > capacity) return 0;
+
+		unsigned int msgType = 20;
+		unsigned int sequence = o.sequence;
+		unsigned int payloadLength = o.length;
+		std::memcpy(buffer, &msgType, 4);
+		std::memcpy(buffer + 4, &connectionID, 4);
+		std::memcpy(buffer + 8, &sequence, 4);
+		std::memcpy(buffer + 12, &payloadLength, 4);
+		std::memcpy(buffer + RELIABLE_HEADER_SIZE, o.data, o.length);
+
+		o.lastSent = now;
+		return length;
+	}
+	return 0;
+}
+
+bool ReliableChannel::Receive(const char* buffer, int length)
+{
+	if (length < RELIABLE_HEADER_SIZE) return false;
+
+	unsigned int sequence, payloadLength;
+	std::memcpy(&sequence, buffer + 8, 4);
+	std::memcpy(&payloadLength, buffer + 12, 4);
+	if (payloadLength == 0 || payloadLength > RELIABLE_MAX_PAYLOAD || (int)payloadLength > length - RELIABLE_HEADER_SIZE) return false;
+
+	uint16_t seq = (uint16_t)sequence;
+
+	//Further ahead than we can buffer. The sender's window should stop this ever happening
+	if ((uint16_t)(seq - nextDeliver) >= RELIABLE_WINDOW && SequenceNewer(seq, nextDeliver)) return false;
+
+	Acknowledge(seq);
+
+	//Already delivered, the sender just hasn't heard our ack yet
+	if (SequenceNewer(nextDeliver, seq)) return true;
+
+	Incoming& in = incoming[seq % RELIABLE_WINDOW];
+	if (in.ready && in.sequence == seq) return true;
+
+	in.ready = true;
+	in.sequence = seq;
+	in.length = (int)payloadLength;
+	std::memcpy(in.data, buffer + RELIABLE_HEADER_SIZE, payloadLength);
+	return true;
+}
+
+void ReliableChannel::Acknowledge(uint16_t sequence)
+{
+	if (!receivedAny)
+	{
+		receivedAny = true;
+		newestReceived = sequence;
+		receivedBits = 0;
+		return;
+	}
+
+	if (SequenceNewer(sequence, newestReceived))
+	{
+		//Slide the bitfield along, the old newest becomes bit shift - 1
+		int shift = (uint16_t)(sequence - newestReceived);
+		receivedBits = shift >= 32 ? 0 : receivedBits << shift;
+		if (shift <= 32) receivedBits |= 1u << (shift - 1);
+		newestReceived = sequence;
+		return;
+	}
+
+	int back = (uint16_t)(newestReceived - sequence);
+	if (back >= 1 && back <= 32) receivedBits |= 1u << (back - 1);
+}
+
+int ReliableChannel::Deliver(char* buffer, int capacity)
+{
+	Incoming& in = incoming[nextDeliver % RELIABLE_WINDOW];
+	if (!in.ready || in.sequence != nextDeliver || in.length > capacity) return 0;
+
+	std::memcpy(buffer, in.data, in.length);
+	in.ready = false;
+	nextDeliver++;
+	return in.length;
+}
+
+void ReliableChannel::GetAck(uint16_t* ack, uint32_t* ackBits)
+{
+	//Nothing yet: claim the sequence before the first so nothing real is acked
+	*ack = receivedAny ? newestReceived : (uint16_t)(nextDeliver - 1);
+	*ackBits = receivedAny ? receivedBits : 0;
+}
+
+void ReliableChannel::ProcessAck(uint16_t ack, uint32_t ackBits)
+{
+	for (uint16_t s = oldestUnacked; s != nextSequence; s++)
+	{
+		Outgoing& o = outgoing[s % RELIABLE_WINDOW];
+		if (!o.pending) continue;
+
+		int back = (uint16_t)(ack - s);
+		if (back == 0 || (back >= 1 && back <= 32 && (ackBits & (1u << (back - 1)))))
+			o.pending = false;
+	}
+
+	//Free the front of the window up to the first message still waiting
+	while (oldestUnacked != nextSequence && !outgoing[oldestUnacked % RELIABLE_WINDOW].pending)
+		oldestUnacked++;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+//Messages that can be in flight, unacknowledged, at once. Must fit the 32 bit ack field
+#define RELIABLE_WINDOW 32
+
+//Largest message the channel carries. Join, projectile and disconnect messages all fit
+#define RELIABLE_MAX_PAYLOAD 96
+
+//msgType 20 header: type, connection id, sequence, payload length
+#define RELIABLE_HEADER_SIZE 16
+
+//Seconds before an unacknowledged message is sent again
+#define RELIABLE_RESEND_INTERVAL 0.1
+
+//Reliable, ordered messages over unreliable datagrams, one channel per peer.
+//Each message goes out in its own msgType 20 datagram and is resent on its own until acknowledged.
+//Acks are the newest sequence received plus a bitfield of the 32 before it, and ride along on
+//the regular traffic (client inputs and world updates) rather than getting packets of their own.
+class ReliableChannel
+{
+private:
+
+	struct Outgoing
+	{
+		bool pending;
+		uint16_t sequence;
+		int length;
+		double lastSent; //Negative until first sent
+		char data[RELIABLE_MAX_PAYLOAD];
+	};
+
+	struct Incoming
+	{
+		bool ready;
+		uint16_t sequence;
+		int length;
+		char data[RELIABLE_MAX_PAYLOAD];
+	};
+
+	//Sending
+	Outgoing outgoing[RELIABLE_WINDOW];
+	uint16_t nextSequence = 0;
+	uint16_t oldestUnacked = 0;
+
+	//Receiving
+	Incoming incoming[RELIABLE_WINDOW];
+	uint16_t nextDeliver = 0;
+	bool receivedAny = false;
+	uint16_t newestReceived = 0;
+	uint32_t receivedBits = 0; //Bit n set if newestReceived - 1 - n arrived
+
+	void Acknowledge(uint16_t sequence);
+
+public:
+
+	ReliableChannel() { Reset(); }
+
+	void Reset();
+
+	//Queues a message. Returns false if it's too big or the window is full
+	bool Send(const char* data, int length);
+
+	//Writes the next message due to go out (new, or unacknowledged for resendInterval) as a complete
+	//msgType 20 datagram and marks it sent. Returns its length, 0 once nothing else is due
+	int WriteDue(double now, uint32_t connectionID, char* buffer, int capacity);
+
+	//Takes a msgType 20 datagram. Returns false if it was malformed or too far ahead to hold
+	bool Receive(const char* buffer, int length);
+
+	//Next message in order, if it has arrived. Returns its length, 0 if there isn't one
+	int Deliver(char* buffer, int capacity);
+
+	//What to tell the other side we have
+	void GetAck(uint16_t* ack, uint32_t* ackBits);
+
+	//What the other side told us it has
+	void ProcessAck(uint16_t ack, uint32_t ackBits);
+
+	bool HasUnacked() { return oldestUnacked != nextSequence; }
+
+};
@@ -118,7 +118,8 @@ void Renderer::Render(Camera* camera, float totalTime, int lightCount, SimpleVer
 		1.0f,
 		0);
 
-
+	// Every world matrix that changed this frame, in one pass before anything reads them
+	TransformSystem::GetInstance().UpdateWorldMatrices();
 
 	RenderShadowMap();
 
@@ -0,0 +1,206 @@
+// CollisionBench.cpp : Cost of a tick's projectile hit checks as the projectile count grows.
+//
+// Players wander around a square arena while projectiles fly across it, relaunched as they die.
+// Every tick runs the server's path (player grid sync, sweeps, ProjectileCollider over the
+// SpatialHash) and, on the same sweeps, a plain every projectile against every player loop with the
+// same swept-sphere test. Both are spread over the same thread pool, and their hits are compared.
+//
+// From Server/GameServer/Benchmarks:
+// g++ -std=c++14 -O2 CollisionBench.cpp ../GameServer/SpatialHash.cpp ../GameServer/ProjectileCollider.cpp ../GameServer/PositionHistory.cpp ../GameServer/ThreadPool.cpp ../../../ProjectileSystem.cpp -o CollisionBench -lpthread
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "../GameServer/SpatialHash.h"
+#include "../GameServer/ProjectileCollider.h"
+#include "../GameServer/PositionHistory.h"
+#include "../GameServer/ThreadPool.h"
+#include "../GameServer/Helpers.h"
+#include "../../../ProjectileSystem.h"
+
+using namespace std::chrono;
+
+#define DEFAULT_PLAYERS 32
+#define DEFAULT_TICKS 300
+#define DEFAULT_WORKERS 1
+#define TICK_RATE 60
+
+//Side of the square everyone stays in
+#define ARENA_SIZE 120.0f
+
+//Same as the server's player grid
+#define PLAYER_CELL_SIZE 4.0f
+
+#define PLAYER_SPEED 6.0f
+
+//Same launch values the game uses for a new bullet
+#define PROJECTILE_SPEED 35.0f
+#define PROJECTILE_LIFT 2.0f
+#define PROJECTILE_GRAVITY -4.9f
+#define PROJECTILE_LIFESPAN 5.0f
+
+//Small deterministic generator so runs repeat exactly
+struct Random
+{
+    uint32_t state;
+
+    Random(uint32_t seed) : state(seed) {}
+
+    //Uniform in [0, 1)
+    float Next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0f;
+    }
+};
+
+struct Result
+{
+    double gridMicroseconds = 0;
+    double bruteMicroseconds = 0;
+    long long hits = 0;
+    long long mismatches = 0;
+};
+
+static void LaunchRandom(ProjectileSystem& projectiles, int index, Random& random)
+{
+    ProjectileState state = {};
+    state.position[0] = random.Next() * ARENA_SIZE;
+    state.position[1] = 1 + random.Next() * 2;
+    state.position[2] = random.Next() * ARENA_SIZE;
+    state.rotation[1] = random.Next() * 6.2831853f;
+    state.velocity[1] = PROJECTILE_LIFT;
+    state.velocity[2] = PROJECTILE_SPEED;
+    state.gravity = PROJECTILE_GRAVITY;
+    state.lifespan = PROJECTILE_LIFESPAN;
+    projectiles.Launch(index, state);
+}
+
+static Result Run(int projectileCount, int playerCount, int ticks, ThreadPool& pool)
+{
+    const float dt = 1.0f / TICK_RATE;
+    Random random(projectileCount);
+
+    std::vector<float> px(playerCount), pz(playerCount), heading(playerCount);
+    for (int i = 0; i < playerCount; i++)
+    {
+        px[i] = random.Next() * ARENA_SIZE;
+        pz[i] = random.Next() * ARENA_SIZE;
+        heading[i] = random.Next() * 6.2831853f;
+    }
+
+    ProjectileSystem projectiles;
+    projectiles.Resize(projectileCount);
+    for (int j = 0; j < projectileCount; j++)
+        LaunchRandom(projectiles, j, random);
+
+    SpatialHash grid(PLAYER_CELL_SIZE);
+    ProjectileCollider collider;
+    collider.Resize(projectileCount);
+    PositionHistory history;
+    history.Resize(4, playerCount);
+
+    std::vector<int> bruteHits(projectileCount);
+    Result result;
+
+    for (uint32_t tick = 1; tick <= (uint32_t)ticks; tick++)
+    {
+        //Players turn a little and keep walking, bouncing off the arena edges
+        history.BeginTick(tick);
+        for (int i = 0; i < playerCount; i++)
+        {
+            heading[i] += (random.Next() - 0.5f) * 0.2f;
+            px[i] = fminf(fmaxf(px[i] + sinf(heading[i]) * PLAYER_SPEED * dt, 0.0f), ARENA_SIZE);
+            pz[i] = fminf(fmaxf(pz[i] + cosf(heading[i]) * PLAYER_SPEED * dt, 0.0f), ARENA_SIZE);
+            history.Record(i, px[i], 2, pz[i]);
+        }
+
+        projectiles.Update(dt, 0, projectileCount);
+        for (int j = 0; j < projectileCount; j++)
+        {
+            if (!projectiles.IsAlive(j)) LaunchRandom(projectiles, j, random);
+        }
+
+        //Server path
+        auto start = steady_clock::now();
+        for (int j = 0; j < projectileCount; j++)
+        {
+            VectorMath::float3 s, e;
+            projectiles.GetSweep(j, dt, &s, &e);
+            collider.SetSweep(j, s.x, s.y, s.z, e.x, e.y, e.z, PROJECTILE_HIT_RADIUS, (double)tick);
+        }
+        for (int i = 0; i < playerCount; i++)
+            grid.Update(i, px[i], 2 - 1, pz[i]);
+        collider.Collide(&pool, grid, history);
+        auto mid = steady_clock::now();
+
+        //Everyone against everything, lowest slot wins
+        pool.ParallelFor(projectileCount, [&](int j)
+        {
+            VectorMath::float3 s, e;
+            projectiles.GetSweep(j, dt, &s, &e);
+
+            int hit = -1;
+            for (int i = 0; i < playerCount && hit == -1; i++)
+            {
+                float position[3];
+                if (!history.Sample((double)tick, i, position)) continue;
+                if (Helpers::SweptSphereHit(s, e, Helpers::GetPlayerHitCenter(position), PROJECTILE_HIT_RADIUS))
+                    hit = i;
+            }
+            bruteHits[j] = hit;
+        });
+        auto end = steady_clock::now();
+
+        result.gridMicroseconds += duration<double, std::micro>(mid - start).count();
+        result.bruteMicroseconds += duration<double, std::micro>(end - mid).count();
+
+        //Hits don't kill anything, so the load stays the same every tick
+        for (int j = 0; j < projectileCount; j++)
+        {
+            if (collider.GetHit(j) != -1) result.hits++;
+            if (collider.GetHit(j) != bruteHits[j]) result.mismatches++;
+        }
+    }
+
+    result.gridMicroseconds /= ticks;
+    result.bruteMicroseconds /= ticks;
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int playerCount = DEFAULT_PLAYERS;
+    int ticks = DEFAULT_TICKS;
+    int workerCount = DEFAULT_WORKERS;
+
+    //CollisionBench [-players N] [-ticks N] [-workers N]
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "-players") playerCount = atoi(argv[i + 1]);
+        else if (arg == "-ticks") ticks = atoi(argv[i + 1]);
+        else if (arg == "-workers") workerCount = atoi(argv[i + 1]);
+    }
+    if (playerCount < 1) playerCount = 1;
+    if (ticks < 1) ticks = 1;
+
+    ThreadPool pool(workerCount);
+
+    std::cout << playerCount << " players, " << ticks << " ticks, " << pool.GetWorkerCount() << " workers plus the caller" << std::endl;
+    std::cout << "projectiles  grid us/tick  all pairs us/tick  hits  mismatches" << std::endl;
+
+    const int counts[] = { 100, 300, 1000, 3000, 10000 };
+    for (int n : counts)
+    {
+        Result r = Run(n, playerCount, ticks, pool);
+        std::cout << n << "  " << r.gridMicroseconds << "  " << r.bruteMicroseconds
+            << "  " << r.hits << "  " << r.mismatches << std::endl;
+    }
+
+    return 0;
+}
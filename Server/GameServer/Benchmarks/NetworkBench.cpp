@@ -0,0 +1,253 @@
+// NetworkBench.cpp : Packets per second through UDPSocket over loopback.
+//
+// One thread blasts small datagrams at a bound socket while another drains it. Receiving is
+// timed with one RecvFrom per datagram against RecvBatch, sending with one SendTo per datagram
+// against SendBatch. On Windows both batch calls fall back to a loop, so expect no difference there.
+//
+// Those runs need a core per thread, with one the two sides just take turns. The burst cases that
+// follow use a single thread: a burst is queued up untimed, then only taking it (or sending it) is
+// timed, for the cost per datagram. Over loopback most of that is the kernel handling each datagram,
+// which batching can't save, only the cost of entering the kernel once per call. So expect batches
+// of 16 or more to be a little cheaper than a call per datagram (about a tenth receiving and a fifth
+// sending on a one core VM), and a batch of one to be dearer.
+// The server keeps batching because its receive thread takes whatever is queued, often many at
+// once under load, and sends a whole tick of world updates together. The calls win more where
+// each system call costs more.
+//
+// From Server/GameServer/Benchmarks:
+// g++ -std=c++14 -O2 NetworkBench.cpp -o NetworkBench -lpthread
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "../../../Network.h"
+
+using namespace std::chrono;
+
+#define DEFAULT_PORT 47123
+#define DEFAULT_RUN_SECONDS 2
+#define DEFAULT_PAYLOAD 64
+
+//Drain timeout once the sender has stopped
+#define IDLE_TIMEOUT_MS 100
+
+//Datagrams queued before each timed burst. Small enough to fit the default receive buffer
+//everywhere even at MAX_DATAGRAM_SIZE, since a lost one would leave the drain blocked
+#define BURST_SIZE 32
+#define BURST_ROUNDS 3000
+
+unsigned short port = DEFAULT_PORT;
+int runSeconds = DEFAULT_RUN_SECONDS;
+int payload = DEFAULT_PAYLOAD;
+
+//Loopback datagrams to the benchmark port
+static void FillDatagrams(std::vector<Datagram>& datagrams)
+{
+    for (size_t i = 0; i < datagrams.size(); i++)
+    {
+        Datagram& d = datagrams[i];
+        d.address.sin_family = AF_INET;
+        d.address.sin_addr.s_addr = inet_addr("127.0.0.1");
+        d.address.sin_port = htons(port);
+        d.length = payload;
+        memset(d.data, (int)i, payload);
+    }
+}
+
+//Sends as fast as it can until told to stop, returns how many datagrams went out
+static long long Blast(bool batched, std::atomic<bool>* stop)
+{
+    UDPSocket socket;
+    std::vector<Datagram> datagrams(MAX_DATAGRAM_BATCH);
+    FillDatagrams(datagrams);
+
+    long long sent = 0;
+    while (!stop->load())
+    {
+        if (batched)
+        {
+            socket.SendBatch(datagrams.data(), (int)datagrams.size());
+        }
+        else
+        {
+            for (size_t i = 0; i < datagrams.size(); i++)
+                socket.SendTo(datagrams[i].address, datagrams[i].data, datagrams[i].length);
+        }
+        sent += (long long)datagrams.size();
+    }
+    return sent;
+}
+
+//Reads until the sender has stopped and the socket stays quiet, returns how many datagrams arrived
+static long long Drain(UDPSocket* socket, bool batched, std::atomic<bool>* stop)
+{
+    std::vector<Datagram> datagrams(MAX_DATAGRAM_BATCH);
+    char buffer[MAX_DATAGRAM_SIZE + 1];
+
+    long long received = 0;
+    while (true)
+    {
+        //Checked before waiting, so once the sender has stopped one quiet timeout ends it. Only reads
+        //once something is waiting, since a blocking read after the last datagram would never return
+        bool stopped = stop->load();
+        if (!socket->WaitReadable(IDLE_TIMEOUT_MS))
+        {
+            if (stopped) break;
+            continue;
+        }
+
+        if (batched)
+        {
+            received += socket->RecvBatch(datagrams.data(), (int)datagrams.size());
+        }
+        else
+        {
+            socket->RecvFrom(buffer, MAX_DATAGRAM_SIZE);
+            received++;
+        }
+    }
+    return received;
+}
+
+//Nanoseconds per datagram to take a queued burst, with RecvFrom if batchSize is 0
+static void ReceiveBurst(const char* name, int batchSize)
+{
+    UDPSocket receiver;
+    receiver.Bind(port);
+    UDPSocket sender;
+    std::vector<Datagram> outgoing(BURST_SIZE);
+    FillDatagrams(outgoing);
+    std::vector<Datagram> incoming(BURST_SIZE);
+    char buffer[MAX_DATAGRAM_SIZE + 1];
+
+    double nanoseconds = 0;
+    long long received = 0;
+    for (int round = 0; round < BURST_ROUNDS; round++)
+    {
+        sender.SendBatch(outgoing.data(), BURST_SIZE);
+        if (!receiver.WaitReadable(IDLE_TIMEOUT_MS)) break;
+
+        auto start = steady_clock::now();
+        int taken = 0;
+        while (taken < BURST_SIZE)
+        {
+            if (batchSize == 0)
+            {
+                receiver.RecvFrom(buffer, MAX_DATAGRAM_SIZE);
+                taken++;
+            }
+            else
+            {
+                taken += receiver.RecvBatch(incoming.data(), std::min(batchSize, BURST_SIZE - taken));
+            }
+        }
+        nanoseconds += duration<double, std::nano>(steady_clock::now() - start).count();
+        received += taken;
+    }
+
+    std::cout << "  " << name << ": " << (received > 0 ? (long long)(nanoseconds / received) : 0) << " ns per datagram" << std::endl;
+}
+
+//Nanoseconds per datagram to send a burst, the receiver emptied between bursts untimed
+static void SendBurst(const char* name, bool batched)
+{
+    UDPSocket receiver;
+    receiver.Bind(port);
+    UDPSocket sender;
+    std::vector<Datagram> outgoing(BURST_SIZE);
+    FillDatagrams(outgoing);
+    std::vector<Datagram> incoming(MAX_DATAGRAM_BATCH);
+
+    double nanoseconds = 0;
+    for (int round = 0; round < BURST_ROUNDS; round++)
+    {
+        auto start = steady_clock::now();
+        if (batched)
+        {
+            sender.SendBatch(outgoing.data(), BURST_SIZE);
+        }
+        else
+        {
+            for (int i = 0; i < BURST_SIZE; i++)
+                sender.SendTo(outgoing[i].address, outgoing[i].data, outgoing[i].length);
+        }
+        nanoseconds += duration<double, std::nano>(steady_clock::now() - start).count();
+
+        while (receiver.WaitReadable(0))
+            receiver.RecvBatch(incoming.data(), MAX_DATAGRAM_BATCH);
+    }
+
+    std::cout << "  " << name << ": " << (long long)(nanoseconds / ((double)BURST_ROUNDS * BURST_SIZE)) << " ns per datagram" << std::endl;
+}
+
+static void Run(const char* name, bool batchedSend, bool batchedRecv)
+{
+    UDPSocket receiver;
+    receiver.Bind(port);
+
+    std::atomic<bool> stop(false);
+    long long received = 0;
+    std::thread reader([&]() { received = Drain(&receiver, batchedRecv, &stop); });
+
+    long long sent = 0;
+    auto start = steady_clock::now();
+    std::thread writer([&]() { sent = Blast(batchedSend, &stop); });
+
+    std::this_thread::sleep_for(std::chrono::seconds(runSeconds));
+    stop = true;
+    writer.join();
+    float elapsed = duration<float>(steady_clock::now() - start).count();
+    reader.join();
+
+    std::cout << "  " << name << ": " << (long long)(sent / elapsed) << " sent/s, "
+        << (long long)(received / elapsed) << " received/s ("
+        << (sent > 0 ? 100.0 * (sent - received) / sent : 0.0) << "% dropped)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    //NetworkBench [-port N] [-seconds N] [-payload N]
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "-port") port = (unsigned short)atoi(argv[i + 1]);
+        else if (arg == "-seconds") runSeconds = atoi(argv[i + 1]);
+        else if (arg == "-payload") payload = atoi(argv[i + 1]);
+    }
+    if (runSeconds < 1) runSeconds = 1;
+    if (payload < 1) payload = 1;
+    if (payload > MAX_DATAGRAM_SIZE) payload = MAX_DATAGRAM_SIZE;
+
+    WSASession Session;
+
+    std::cout << payload << " byte datagrams over loopback for " << runSeconds << "s each" << std::endl;
+
+    //Batched sender so the receiver is the bottleneck
+    std::cout << "Receive" << std::endl;
+    Run("RecvFrom per datagram", true, false);
+    Run("RecvBatch", true, true);
+
+    //Batched receiver so the sender is the bottleneck
+    std::cout << "Send" << std::endl;
+    Run("SendTo per datagram", false, true);
+    Run("SendBatch", true, true);
+
+    std::cout << "Receive " << BURST_SIZE << " queued, one thread" << std::endl;
+    ReceiveBurst("RecvFrom per datagram", 0);
+    ReceiveBurst("RecvBatch of 1", 1);
+    ReceiveBurst("RecvBatch of 4", 4);
+    ReceiveBurst("RecvBatch of 16", 16);
+    ReceiveBurst("RecvBatch of 32", 32);
+
+    std::cout << "Send " << BURST_SIZE << " at once, one thread" << std::endl;
+    SendBurst("SendTo per datagram", false);
+    SendBurst("SendBatch", true);
+
+    return 0;
+}
@@ -0,0 +1,404 @@
+// TransformBench.cpp : World matrix updates in TransformSystem against the original per-object Transform.
+//
+// The same random hierarchy is built twice: once from Transform handles over the shared TransformSystem,
+// and once from PerObjectTransform below, which is the original Transform's update moved to VectorMath.
+// Every object builds scale * rotation * translation, multiplies in its parent's world matrix
+// (fetched recursively), and inverts the result with a general matrix inverse. Each frame changes
+// some rotations, then reads every world and inverse transpose matrix as the renderer would.
+// Both sides' matrices are compared at the end.
+//
+// The aim was 100000 transforms updated in well under 1 ms a frame, and each update case prints whether
+// it made TARGET_UPDATE_MS. Only the lightest case does. A change updates the changed transform's whole
+// subtree, which in this forest is a few transforms each, and past a few thousand transforms the
+// matrix math and cache misses alone take longer than that.
+//
+// The hierarchy cases then stress what the old recursion was worst at: a root moved many times a frame
+// above one long chain, random reparenting under a wide root, and removing every child of that root.
+//
+// From Server/GameServer/Benchmarks:
+// g++ -std=c++14 -O2 TransformBench.cpp ../../../Transform.cpp ../../../TransformSystem.cpp -o TransformBench
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "../../../Transform.h"
+
+using namespace std::chrono;
+using namespace VectorMath;
+
+#define DEFAULT_TRANSFORMS 100000
+#define DEFAULT_FRAMES 20
+#define DEFAULT_DEPTH 5000
+#define DEFAULT_CHILDREN 20000
+
+//Root moves per frame above the chain, and reparents per frame under the wide root
+#define MOVES_PER_FRAME 100
+#define REPARENTS_PER_FRAME 100
+
+//Chance a new transform is parented to an earlier one
+#define PARENT_CHANCE 0.75f
+
+//What UpdateWorldMatrices is meant to take per frame at DEFAULT_TRANSFORMS, each update case says if it made it
+#define TARGET_UPDATE_MS 1.0
+
+//Small deterministic generator so runs repeat exactly
+struct Random
+{
+    uint32_t state;
+
+    Random(uint32_t seed) : state(seed) {}
+
+    //Uniform in [0, 1)
+    float Next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0f;
+    }
+};
+
+//The original Transform: its own matrices, a dirty flag pushed down to every descendant on
+//each change, and a world matrix rebuilt from the parent's on demand
+struct PerObjectTransform
+{
+    float3 position = float3(0, 0, 0);
+    float3 pitchYawRoll = float3(0, 0, 0);
+    float3 scale = float3(1, 1, 1);
+    float4x4 worldMatrix;
+    float4x4 worldInverseTransposeMatrix;
+    bool matricesDirty = true;
+
+    PerObjectTransform* parent = nullptr;
+    std::vector<PerObjectTransform*> children;
+
+    //Leaves it unparented if the new parent is below it, like RemoveChild then AddChild on a Transform
+    void SetParent(PerObjectTransform* newParent)
+    {
+        if (parent) parent->RemoveChild(this);
+        for (PerObjectTransform* p = newParent; p; p = p->parent)
+        {
+            if (p == this) return;
+        }
+
+        parent = newParent;
+        newParent->children.push_back(this);
+        matricesDirty = true;
+        MarkChildTransformsDirty();
+    }
+
+    void RemoveChild(PerObjectTransform* child)
+    {
+        auto it = std::find(children.begin(), children.end(), child);
+        if (it == children.end()) return;
+
+        children.erase(it);
+        child->parent = nullptr;
+        child->matricesDirty = true;
+        child->MarkChildTransformsDirty();
+    }
+
+    void MoveAbsolute(float x, float y, float z)
+    {
+        position = float3(position.x + x, position.y + y, position.z + z);
+        matricesDirty = true;
+        MarkChildTransformsDirty();
+    }
+
+    void SetPosition(float x, float y, float z)
+    {
+        position = float3(x, y, z);
+        matricesDirty = true;
+        MarkChildTransformsDirty();
+    }
+
+    void SetRotation(float p, float y, float r)
+    {
+        pitchYawRoll = float3(p, y, r);
+        matricesDirty = true;
+        MarkChildTransformsDirty();
+    }
+
+    void SetScale(float x, float y, float z)
+    {
+        scale = float3(x, y, z);
+        matricesDirty = true;
+        MarkChildTransformsDirty();
+    }
+
+    void MarkChildTransformsDirty()
+    {
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            children[i]->matricesDirty = true;
+            children[i]->MarkChildTransformsDirty();
+        }
+    }
+
+    void UpdateMatrices()
+    {
+        if (!matricesDirty) return;
+
+        Matrix wm = MatrixMultiply(MatrixMultiply(
+            MatrixScalingFromVector(LoadFloat3(&scale)),
+            MatrixRotationRollPitchYawFromVector(LoadFloat3(&pitchYawRoll))),
+            MatrixTranslationFromVector(LoadFloat3(&position)));
+        if (parent)
+        {
+            float4x4 pW = parent->GetWorldMatrix();
+            wm = MatrixMultiply(wm, LoadFloat4x4(&pW));
+        }
+        StoreFloat4x4(&worldMatrix, wm);
+        StoreFloat4x4(&worldInverseTransposeMatrix, MatrixInverse(0, MatrixTranspose(wm)));
+
+        matricesDirty = false;
+    }
+
+    float4x4 GetWorldMatrix() { UpdateMatrices(); return worldMatrix; }
+    float4x4 GetWorldInverseTransposeMatrix() { UpdateMatrices(); return worldInverseTransposeMatrix; }
+};
+
+//Largest difference between two matrices, relative to the size of the entries
+static float MatrixError(const float4x4& a, const float4x4& b)
+{
+    float error = 0;
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+            error = fmaxf(error, fabsf(a.m[r][c] - b.m[r][c]) / (1 + fabsf(b.m[r][c])));
+    }
+    return error;
+}
+
+static void UpdateCases(int count, int frames)
+{
+    //Same random forest on both sides, with small scales so deep chains stay in range
+    Random random(1);
+    std::vector<Transform> batched(count);
+    std::vector<PerObjectTransform> perObject(count);
+    for (int i = 0; i < count; i++)
+    {
+        float x = random.Next() * 4 - 2, y = random.Next() * 4 - 2, z = random.Next() * 4 - 2;
+        float s = 0.9f + random.Next() * 0.2f;
+        batched[i].SetPosition(x, y, z);
+        batched[i].SetScale(s, s, s);
+        perObject[i].SetPosition(x, y, z);
+        perObject[i].SetScale(s, s, s);
+
+        if (i > 0 && random.Next() < PARENT_CHANCE)
+        {
+            int p = (int)(random.Next() * i);
+            batched[i].SetParent(&batched[p], false);
+            perObject[i].SetParent(&perObject[p]);
+        }
+    }
+
+    std::cout << count << " transforms in a random forest, " << frames << " frames per case" << std::endl;
+    std::cout << "changed per frame  TransformSystem ms/frame (update only)  per object ms/frame  update under " << TARGET_UPDATE_MS << " ms" << std::endl;
+
+    const float fractions[] = { 1.0f, 0.1f, 0.01f, 0.001f };
+    for (float fraction : fractions)
+    {
+        int changed = (int)(count * fraction);
+        if (changed < 1) changed = 1;
+
+        double batchedMs = 0, updateMs = 0, perObjectMs = 0;
+        for (int f = 0; f < frames; f++)
+        {
+            //Which transforms change this frame, and to what
+            std::vector<int> targets(changed);
+            std::vector<float3> angles(changed);
+            for (int k = 0; k < changed; k++)
+            {
+                targets[k] = changed == count ? k : (int)(random.Next() * count);
+                angles[k] = float3(random.Next() * 6 - 3, random.Next() * 6 - 3, random.Next() * 6 - 3);
+            }
+
+            float checksum = 0;
+            auto start = steady_clock::now();
+            for (int k = 0; k < changed; k++)
+                batched[targets[k]].SetRotation(angles[k].x, angles[k].y, angles[k].z);
+            auto updateStart = steady_clock::now();
+            TransformSystem::GetInstance().UpdateWorldMatrices();
+            updateMs += duration<double, std::milli>(steady_clock::now() - updateStart).count();
+            for (int i = 0; i < count; i++)
+                checksum += batched[i].GetWorldMatrix()._41 + batched[i].GetWorldInverseTransposeMatrix()._14;
+            auto mid = steady_clock::now();
+
+            for (int k = 0; k < changed; k++)
+                perObject[targets[k]].SetRotation(angles[k].x, angles[k].y, angles[k].z);
+            for (int i = 0; i < count; i++)
+                checksum -= perObject[i].GetWorldMatrix()._41 + perObject[i].GetWorldInverseTransposeMatrix()._14;
+            auto end = steady_clock::now();
+
+            batchedMs += duration<double, std::milli>(mid - start).count();
+            perObjectMs += duration<double, std::milli>(end - mid).count();
+            if (!std::isfinite(checksum)) std::cout << "Matrices went out of range" << std::endl;
+        }
+
+        std::cout << changed << "  " << batchedMs / frames << " (" << updateMs / frames << ")  " << perObjectMs / frames
+            << "  " << (updateMs / frames < TARGET_UPDATE_MS ? "met" : "MISSED") << std::endl;
+    }
+
+    float worldError = 0, inverseError = 0;
+    for (int i = 0; i < count; i++)
+    {
+        worldError = fmaxf(worldError, MatrixError(batched[i].GetWorldMatrix(), perObject[i].GetWorldMatrix()));
+        inverseError = fmaxf(inverseError, MatrixError(batched[i].GetWorldInverseTransposeMatrix(), perObject[i].GetWorldInverseTransposeMatrix()));
+    }
+    std::cout << "Largest relative difference: world " << worldError << ", inverse transpose " << inverseError << std::endl;
+
+}
+
+static void HierarchyCases(int depth, int childCount, int frames)
+{
+    Random random(2);
+
+    //One long chain, the root moved over and over before the leaf is read
+    {
+        std::vector<Transform> batched(depth);
+        std::vector<PerObjectTransform> perObject(depth);
+        for (int i = 1; i < depth; i++)
+        {
+            batched[i].SetPosition(0, 0.01f, 0);
+            batched[i].SetParent(&batched[i - 1], false);
+            perObject[i].SetPosition(0, 0.01f, 0);
+            perObject[i].SetParent(&perObject[i - 1]);
+        }
+
+        double batchedMs = 0, perObjectMs = 0;
+        float error = 0;
+        for (int f = 0; f < frames; f++)
+        {
+            auto start = steady_clock::now();
+            for (int k = 0; k < MOVES_PER_FRAME; k++)
+                batched[0].MoveAbsolute(0.001f, 0, 0);
+            float4x4 batchedLeaf = batched[depth - 1].GetWorldMatrix();
+            auto mid = steady_clock::now();
+            for (int k = 0; k < MOVES_PER_FRAME; k++)
+                perObject[0].MoveAbsolute(0.001f, 0, 0);
+            float4x4 perObjectLeaf = perObject[depth - 1].GetWorldMatrix();
+            auto end = steady_clock::now();
+
+            batchedMs += duration<double, std::milli>(mid - start).count();
+            perObjectMs += duration<double, std::milli>(end - mid).count();
+            error = fmaxf(error, MatrixError(batchedLeaf, perObjectLeaf));
+        }
+
+        std::cout << depth << " deep chain, " << MOVES_PER_FRAME << " root moves then a leaf read per frame: "
+            << batchedMs / frames << " ms vs " << perObjectMs / frames << " ms per object (difference " << error << ")" << std::endl;
+    }
+
+    //Many children under one root, shuffled into each other so the arrays need sorting
+    {
+        std::vector<Transform> batched(childCount + 1);
+        std::vector<PerObjectTransform> perObject(childCount + 1);
+        for (int i = 1; i <= childCount; i++)
+        {
+            float x = random.Next() * 2 - 1, z = random.Next() * 2 - 1;
+            batched[i].SetPosition(x, 0, z);
+            batched[i].SetParent(&batched[0], false);
+            perObject[i].SetPosition(x, 0, z);
+            perObject[i].SetParent(&perObject[0]);
+        }
+
+        double batchedMs = 0, perObjectMs = 0;
+        for (int f = 0; f < frames; f++)
+        {
+            //Unparented without baking in the old parent's transform, which SetParent would do. A move
+            //that would make a cycle leaves the transform unparented on both sides
+            std::vector<int> moved(REPARENTS_PER_FRAME), onto(REPARENTS_PER_FRAME);
+            for (int k = 0; k < REPARENTS_PER_FRAME; k++)
+            {
+                moved[k] = 1 + (int)(random.Next() * childCount);
+                onto[k] = 1 + (int)(random.Next() * childCount);
+            }
+
+            float checksum = 0;
+            auto start = steady_clock::now();
+            for (int k = 0; k < REPARENTS_PER_FRAME; k++)
+            {
+                Transform* oldParent = batched[moved[k]].GetParent();
+                if (oldParent) oldParent->RemoveChild(&batched[moved[k]], false);
+                batched[onto[k]].AddChild(&batched[moved[k]], false);
+            }
+            for (int i = 0; i <= childCount; i++)
+                checksum += batched[i].GetWorldMatrix()._41;
+            auto mid = steady_clock::now();
+            for (int k = 0; k < REPARENTS_PER_FRAME; k++)
+                perObject[moved[k]].SetParent(&perObject[onto[k]]);
+            for (int i = 0; i <= childCount; i++)
+                checksum -= perObject[i].GetWorldMatrix()._41;
+            auto end = steady_clock::now();
+
+            batchedMs += duration<double, std::milli>(mid - start).count();
+            perObjectMs += duration<double, std::milli>(end - mid).count();
+            if (!std::isfinite(checksum)) std::cout << "Matrices went out of range" << std::endl;
+        }
+
+        float error = 0;
+        for (int i = 0; i <= childCount; i++)
+            error = fmaxf(error, MatrixError(batched[i].GetWorldMatrix(), perObject[i].GetWorldMatrix()));
+
+        std::cout << childCount << " children, " << REPARENTS_PER_FRAME << " reparented then all read per frame: "
+            << batchedMs / frames << " ms vs " << perObjectMs / frames << " ms per object (difference " << error << ")" << std::endl;
+    }
+
+    //Every child taken off one wide root, in random order
+    {
+        std::vector<Transform> batched(childCount + 1);
+        std::vector<PerObjectTransform> perObject(childCount + 1);
+        std::vector<int> order(childCount);
+        for (int i = 1; i <= childCount; i++)
+        {
+            batched[i].SetParent(&batched[0], false);
+            perObject[i].SetParent(&perObject[0]);
+            order[i - 1] = i;
+        }
+        for (int i = childCount - 1; i > 0; i--)
+            std::swap(order[i], order[(int)(random.Next() * (i + 1))]);
+
+        auto start = steady_clock::now();
+        for (int i : order)
+            batched[0].RemoveChild(&batched[i], false);
+        auto mid = steady_clock::now();
+        for (int i : order)
+            perObject[0].RemoveChild(&perObject[i]);
+        auto end = steady_clock::now();
+
+        std::cout << childCount << " children removed from one root: " << duration<double, std::milli>(mid - start).count()
+            << " ms vs " << duration<double, std::milli>(end - mid).count() << " ms per object ("
+            << batched[0].GetChildCount() << " and " << perObject[0].children.size() << " left)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int count = DEFAULT_TRANSFORMS;
+    int frames = DEFAULT_FRAMES;
+    int depth = DEFAULT_DEPTH;
+    int childCount = DEFAULT_CHILDREN;
+
+    //TransformBench [-transforms N] [-frames N] [-depth N] [-children N]
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "-transforms") count = atoi(argv[i + 1]);
+        else if (arg == "-frames") frames = atoi(argv[i + 1]);
+        else if (arg == "-depth") depth = atoi(argv[i + 1]);
+        else if (arg == "-children") childCount = atoi(argv[i + 1]);
+    }
+    if (count < 1) count = 1;
+    if (frames < 1) frames = 1;
+    if (depth < 1) depth = 1;
+    if (childCount < 1) childCount = 1;
+
+    //Each case's transforms are gone before the next starts, so the arrays only hold that case
+    UpdateCases(count, frames);
+    HierarchyCases(depth, childCount, frames);
+
+    return 0;
+}
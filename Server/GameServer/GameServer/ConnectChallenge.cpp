@@ -0,0 +1,59 @@
+#include "ConnectChallenge.h"
+
+#include <cstring>
+
+static uint64_t RotateLeft(uint64_t x, int b)
+{
+	return (x << b) | (x >> (64 - b));
+}
+
+static void SipRound(uint64_t v[4])
+{
+	v[0] += v[1]; v[1] = RotateLeft(v[1], 13); v[1] ^= v[0]; v[0] = RotateLeft(v[0], 32);
+	v[2] += v[3]; v[3] = RotateLeft(v[3], 16); v[3] ^= v[2];
+	v[0] += v[3]; v[3] = RotateLeft(v[3], 21); v[3] ^= v[0];
+	v[2] += v[1]; v[1] = RotateLeft(v[1], 17); v[1] ^= v[2]; v[2] = RotateLeft(v[2], 32);
+}
+
+//SipHash-2-4 of length bytes, little endian words as in the reference
+static uint64_t SipHash(const uint64_t key[2], const unsigned char* data, int length)
+{
+	uint64_t v[4] = {
+		key[0] ^ 0x736f6d6570736575ull, key[1] ^ 0x646f72616e646f6dull,
+		key[0] ^ 0x6c7967656e657261ull, key[1] ^ 0x7465646279746573ull };
+
+	int whole = length - length % 8;
+	for (int i = 0; i <= whole; i += 8)
+	{
+		//Last word holds the leftover bytes and the length in its top byte
+		uint64_t m = 0;
+		int bytes = i < whole ? 8 : length - whole;
+		for (int b = 0; b < bytes; b++) m |= (uint64_t)data[i + b] << (8 * b);
+		if (i == whole) m |= (uint64_t)(length & 0xFF) << 56;
+
+		v[3] ^= m;
+		SipRound(v);
+		SipRound(v);
+		v[0] ^= m;
+	}
+
+	v[2] ^= 0xFF;
+	for (int r = 0; r < 4; r++) SipRound(v);
+	return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+uint64_t ConnectChallenge::Hash(const sockaddr_in& address, uint32_t window)
+{
+	//Address and port as on the wire, then the window
+	unsigned char message[10];
+	std::memcpy(message, &address.sin_addr.s_addr, 4);
+	std::memcpy(message + 4, &address.sin_port, 2);
+	for (int b = 0; b < 4; b++) message[6 + b] = (unsigned char)(window >> (8 * b));
+	return SipHash(key, message, sizeof(message));
+}
+
+bool ConnectChallenge::Check(const sockaddr_in& address, uint64_t cookie, uint32_t window)
+{
+	if (cookie == Hash(address, window)) return true;
+	return window > 0 && cookie == Hash(address, window - 1);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../../../Network.h"
+
+//Seconds a cookie window lasts. A cookie is good for the window it was made in and the one after
+#define CHALLENGE_WINDOW_SECONDS 5
+
+//Stateless proof that a connect request really comes from the address it says.
+//The first request gets a cookie back, a SipHash-2-4 of the address and the current time window
+//under a secret key, and only a request that echoes it takes a slot. Nothing is stored per request,
+//and the reply is smaller than the request, so forged senders can neither fill the server nor
+//use it to bounce more traffic at someone else.
+class ConnectChallenge
+{
+private:
+
+	uint64_t key[2] = {};
+
+	uint64_t Hash(const sockaddr_in& address, uint32_t window);
+
+public:
+
+	void SetKey(uint64_t k0, uint64_t k1) { key[0] = k0; key[1] = k1; }
+
+	uint64_t MakeCookie(const sockaddr_in& address, uint32_t window) { return Hash(address, window); }
+
+	//True if the cookie was made for this address in this window or the one before
+	bool Check(const sockaddr_in& address, uint64_t cookie, uint32_t window);
+
+};
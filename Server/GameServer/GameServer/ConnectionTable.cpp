@@ -0,0 +1,84 @@
+#include "ConnectionTable.h"
+
+uint64_t ConnectionTable::KeyOf(const sockaddr_in& address)
+{
+	return ((uint64_t)address.sin_addr.s_addr << 16) | address.sin_port;
+}
+
+uint32_t ConnectionTable::Home(uint64_t key)
+{
+	//Fibonacci hashing spreads neighbouring ports and addresses across the table
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+void ConnectionTable::Resize(int capacity)
+{
+	//Power of two, at least twice the connections so probe runs stay short
+	uint32_t size = 16;
+	while (size < (uint32_t)capacity * 2) size <<= 1;
+
+	entries.assign(size, Entry{ 0, CONNECTION_TABLE_EMPTY });
+	mask = size - 1;
+	count = 0;
+}
+
+bool ConnectionTable::Insert(const sockaddr_in& address, uint32_t handle)
+{
+	if ((uint32_t)(count + 1) * 2 > entries.size()) return false;
+
+	uint64_t key = KeyOf(address);
+	uint32_t i = Home(key);
+	while (entries[i].handle != CONNECTION_TABLE_EMPTY)
+	{
+		if (entries[i].key == key) return false;
+		i = (i + 1) & mask;
+	}
+
+	entries[i].key = key;
+	entries[i].handle = handle;
+	count++;
+	return true;
+}
+
+uint32_t ConnectionTable::Find(const sockaddr_in& address)
+{
+	if (entries.empty()) return CONNECTION_TABLE_EMPTY;
+
+	uint64_t key = KeyOf(address);
+	for (uint32_t i = Home(key); entries[i].handle != CONNECTION_TABLE_EMPTY; i = (i + 1) & mask)
+	{
+		if (entries[i].key == key) return entries[i].handle;
+	}
+	return CONNECTION_TABLE_EMPTY;
+}
+
+void ConnectionTable::Remove(const sockaddr_in& address)
+{
+	if (entries.empty()) return;
+
+	uint64_t key = KeyOf(address);
+	uint32_t i = Home(key);
+	while (entries[i].key != key || entries[i].handle == CONNECTION_TABLE_EMPTY)
+	{
+		if (entries[i].handle == CONNECTION_TABLE_EMPTY) return;
+		i = (i + 1) & mask;
+	}
+
+	//Pull back any later entry in the run that could live in the hole, so no probe run gets cut short
+	uint32_t hole = i;
+	for (uint32_t j = (i + 1) & mask; entries[j].handle != CONNECTION_TABLE_EMPTY; j = (j + 1) & mask)
+	{
+		uint32_t home = Home(entries[j].key);
+
+		//Can move if its home isn't in the cyclic range (hole, j]
+		bool between = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+		if (!between)
+		{
+			entries[hole] = entries[j];
+			hole = j;
+		}
+	}
+
+	entries[hole].handle = CONNECTION_TABLE_EMPTY;
+	count--;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../../../Network.h"
+
+#define CONNECTION_TABLE_EMPTY 0xFFFFFFFFu
+
+//Maps client addresses to player handles in O(1), so a packet's sender is found without
+//walking every slot. Open addressing with linear probing, kept at most half full.
+//Removal shifts later entries back instead of leaving tombstones, so lookups never slow down
+//as clients come and go.
+class ConnectionTable
+{
+private:
+
+	struct Entry
+	{
+		uint64_t key;
+		uint32_t handle; //CONNECTION_TABLE_EMPTY for a free entry
+	};
+
+	std::vector<Entry> entries;
+	uint32_t mask = 0;
+	int count = 0;
+
+	static uint64_t KeyOf(const sockaddr_in& address);
+	uint32_t Home(uint64_t key);
+
+public:
+
+	//Only valid while empty. Room for this many connections
+	void Resize(int capacity);
+
+	//False if the address is already in the table or the table is full
+	bool Insert(const sockaddr_in& address, uint32_t handle);
+
+	//CONNECTION_TABLE_EMPTY if nobody is connected from there
+	uint32_t Find(const sockaddr_in& address);
+
+	void Remove(const sockaddr_in& address);
+
+	int Count() { return count; }
+
+};
@@ -4,276 +4,1024 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <thread>
 #include <vector>
 #include <bitset>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
 #include "Player.h"
+#include "ConnectChallenge.h"
+#include "ConnectionTable.h"
 #include "Helpers.h"
+#include "PacketRing.h"
+#include "PositionHistory.h"
+#include "ProjectileCollider.h"
+#include "SlotMap.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+#include "TickProfiler.h"
+#include "TickScheduler.h"
+#include "TrafficLog.h"
 #include "../../../Network.h"
 
 using namespace std::chrono;
 
-#define MAX_PLAYERS 4
-#define MAX_PROJECTILES 6
+#define DEFAULT_MAX_PLAYERS 4
 
-using frame = duration<int32_t, std::ratio<1, 60>>;
-using ms = duration<float, std::milli>;
+//Each player owns a fixed block of projectile slots, indexed by the client's own projectile index
+#define PROJECTILES_PER_PLAYER 6
+
+#define DEFAULT_TICK_RATE 60
+#define DEFAULT_INTEREST_RADIUS 100.0f
+
+//Furthest back in seconds a hit check will rewind to match what the shooter saw
+#define MAX_REWIND_SECONDS 0.5f
+
+//Fastest a player can cover ground, bounds how far a rewound player can be from where they are now
+#define MAX_REWIND_SPEED 30.0f
+
+//View tick a client sends before it has seen any world update
+#define NO_VIEW_TICK 0xFFFFFFFFu
+
+//Indices per parallel simulation job. Small sessions stay on the game loop thread
+#define PLAYER_JOB_GRAIN 256
+#define PROJECTILE_JOB_GRAIN 128
+
+//Clients that send nothing for this long are dropped, freeing their slot
+#define CLIENT_TIMEOUT_SECONDS 5
+
+//Seconds between stats file updates
+#define DEFAULT_STATS_INTERVAL 5
+
+//Packets queued between RecvFromLoop and GameLoop, and the most one tick handles. Whatever arrives
+//past that waits for the next tick, so a flood can't keep the tick from getting past receiving
+#define INBOUND_QUEUE_SIZE 256
 
 bool gameLoopRunning = true;
 bool recvLoopRunning = true;
 
 WSASession Session;
 UDPSocket Socket;
-char buffer[500];
-char sendbuffer[500];
-bool newData;
 
-Player* players[MAX_PLAYERS];
-Projectile projectiles[MAX_PROJECTILES];
+//Messages unwrapped from a client's reliable channel
+Datagram delivered;
+char reliableBuffer[RELIABLE_HEADER_SIZE + RELIABLE_MAX_PAYLOAD];
+
+//Packets handed from RecvFromLoop to GameLoop
+PacketRing<INBOUND_QUEUE_SIZE> inbound;
+Datagram overflow[MAX_DATAGRAM_BATCH];
+
+std::vector<Datagram> sendBatch;
+
+//Fractional bits of the snapshot position grid
+int positionBits = SNAPSHOT_DEFAULT_POSITION_BITS;
+
+int tickRate = DEFAULT_TICK_RATE;
+uint32_t serverTick = 0;
+
+//Snapshots are numbered by the server tick they were taken on,
+//so clients can tell how far apart in time any two of them are
+WorldSnapshot snapshot;
+
+//Sized from the command line at startup
+SlotMap<Player> players;
+ConnectionTable connections;
+
+//Session tokens. Seeded from the traffic log in a replay so every client gets the token it had live
+std::mt19937 tokenGenerator;
+
+//Cookies a connect request has to echo before it gets a slot. Keyed from the log in a replay too
+ConnectChallenge challenge;
+
+ProjectileSystem projectiles;
+
+//Broadphase for projectile hits, cells a bit bigger than a player
+SpatialHash playerGrid(4.0f);
+ProjectileCollider collider;
+
+//Where every player was over the last MAX_REWIND_SECONDS, for lag compensated hits
+PositionHistory positionHistory;
+
+//Clients only hear about things within this distance of them. 0 sends everything
+float interestRadius = DEFAULT_INTEREST_RADIUS;
+SpatialHash interestPlayerGrid(DEFAULT_INTEREST_RADIUS);
+SpatialHash interestProjectileGrid(DEFAULT_INTEREST_RADIUS);
 
+//Simulation and per-client snapshot encoding run on these
+ThreadPool* workerPool;
+std::vector<int> connectedSlots;
+std::vector<int> dueSlots; //Connected clients getting a world update this tick
 
+//Phase timings and traffic, written out every statsInterval seconds when there's a stats file
+TickProfiler profiler;
+TrafficCounters serverTraffic;
+std::string statsPath;
+int statsInterval = DEFAULT_STATS_INTERVAL;
+uint64_t unsentUpdates = 0; //World updates that didn't fit a datagram since the last report
+std::atomic<uint64_t> trimmedUpdates(0); //World updates that only fit after holding some entities back
 
-//Receives all client communications
+//Inbound traffic is logged here with -record, and played back from a log with -replay.
+//A replay has no clients to answer, so nothing is sent
+TrafficRecorder recorder;
+TrafficReplayer replayer;
+bool replaying = false;
+
+
+
+//Receives all client communications and queues them for the game loop
 void RecvFromLoop()
 {
     while (recvLoopRunning)
     {
-        while (!newData)
+        int freeSlots;
+        Datagram* slots = inbound.WriteSlots(&freeSlots);
+
+        try
         {
-            try
+            if (freeSlots > 0)
             {
-                sockaddr_in sender = Socket.RecvFrom(&buffer[0], 500);
-                newData = true;
-                
-                //Can we handle this data ourselves?
-                unsigned int* msgType = (unsigned int*)&buffer;
-                
-                //Connection Request
-                if (*msgType == 1)
-                {
-                    int firstOpen = -1;
-                    for (size_t i = 0; i < MAX_PLAYERS; i++)
-                    {
-                        if (players[i] == nullptr)
-                        {
-                            firstOpen = i;
-                            break;
-                        }
-                    }
-                    if (firstOpen != -1)
-                    {
-
-                        ////Tell every other played someone joined
-                        //for (size_t i = 0; i < MAX_PLAYERS; i++)
-                        //{
-                        //    if (players[i] == nullptr) continue;
-                        //    //Send a response
-                        //    std::fill_n(sendbuffer, 500, 0);
-
-                        //    unsigned int data = 2;
-                        //    std::memcpy(&sendbuffer, &data, 4);
-                        //    Socket.SendTo(players[i]->client, sendbuffer, 500);
-                        //}
-
-
-                        //Respond with 1 to accept, followed by a player ID
-
-                        int newID = firstOpen;
-                        Player* np = new Player(sender, newID);
-                        players[firstOpen] = np;
-
-                        //Read player initial position and velocity
-                        Helpers::ReadPlayerMovementData(np, &buffer[0] + 1);
-
-                        /*for (size_t i = 0; i < 8; i++)
-                        {
-                            std::bitset<8> x(sendbuffer[i]);
-                            std::cout << x << " ";
-                        }*/
-
-                        //Send a response
-                        std::fill_n(sendbuffer, 500, 0);
-
-                        unsigned int data = 1;
-                        std::memcpy(&sendbuffer, &data, 4);
-                        data = np->GetID();
-                        std::memcpy(&sendbuffer[4], &data, 4);
-                        data = MAX_PLAYERS;
-                        std::memcpy(&sendbuffer[8], &data, 4);
-
-                        Socket.SendTo(sender, sendbuffer, 500);
-
-                        std::cout << "Player " << np->GetID() << " joined.\n";
-
-                        //Clear buffer
-                        std::fill_n(buffer, 500, 0);
-                        newData = false;
-                    }
-                }
-                else if (*msgType == 3) //New projectile
-                {
-                    int* index = (int*)(&buffer[0] + 4);
-
-                    Projectile* p = &projectiles[*index];
-                    Helpers::ReadProjectileMovementData(p, &buffer[0] + 8);
-
-                    newData = false;
-
-                }
-                else if (*msgType == 4) //Intentional Disconnect
-                {
-                    unsigned int* pID = (unsigned int*)(&buffer[0] + 4);
-
-                    std::cout << "Player " << *pID << " disconnected." << std::endl;
-
-                    Socket.SendTo(players[*pID]->client, sendbuffer, 500); //Send garbage to free the recvfrom
-
-                    Player* dc = players[*pID];
-                    players[*pID] = nullptr;
-                    delete dc;
-
-                    //Clear buffer
-                    std::fill_n(buffer, 500, 0);
-                    newData = false;
-
-                }
-                else if(*msgType == 10) //Player update
-                { 
-                    unsigned int playerID = *(msgType + 1);
-                    //Find that player
-                    Player* p = nullptr;
-                    for (size_t i = 0; i < MAX_PLAYERS; i++)
-                    {
-                        if (players[i] == nullptr) continue;
-                        if (players[i]->ID == playerID)
-                        {
-                            p = players[i];
-                            break;
-                        }
-                    }
-                    if (p == nullptr)
-                    {
-                        //Clear buffer
-                        std::fill_n(buffer, 500, 0);
-                        newData = false;
-                        continue;
-                    }
-
-                    //Read player initial position and velocity
-                    float posX, posY, posZ, velX, velY, velZ;
-                    float* posData = (float*)&buffer;
-                    posX = *(posData + 2);
-                    posY = *(posData + 3);
-                    posZ = *(posData + 4);
-                    velX = *(posData + 5);
-                    velY = *(posData + 6);
-                    velZ = *(posData + 7);
-
-                    p->SetPosition(posX, posY, posZ);
-                    p->SetVelocity(velX, velY, velZ);
-
-                    //Clear buffer
-                    std::fill_n(buffer, 500, 0);
-                    newData = false;
-                }
-                //Socket.SendTo(sender, "awrfawfr", 8);
+                //Blocks until something arrives, then takes everything that fits
+                int received = Socket.RecvBatch(slots, freeSlots);
+                inbound.Publish(received);
             }
-            catch (std::exception& ex)
+            else
             {
-                std::cout << ex.what() << std::endl;
+                //Game loop is behind. Keep the socket drained and count what we lose
+                int received = Socket.RecvBatch(overflow, MAX_DATAGRAM_BATCH);
+                inbound.CountDropped(received);
             }
         }
+        catch (std::exception& ex)
+        {
+            std::cout << ex.what() << std::endl;
+        }
     }
 }
 
-//Updates at 60 frames
-void GameLoop()
+//Sends to one client, unless there's nobody on the other end
+void SendToClient(sockaddr_in& address, const char* buffer, int length)
 {
-    time_point<steady_clock> fpsTimer(steady_clock::now());
-    frame FPS{};
+    if (!replaying) Socket.SendTo(address, buffer, length);
+}
 
-    while (gameLoopRunning)
+//Sends whatever this player's reliable channel has due, new or unacknowledged for too long
+void FlushReliable(Player* p)
+{
+    double now = (double)serverTick / tickRate;
+    int length;
+    while ((length = p->reliable.WriteDue(now, p->token, reliableBuffer, sizeof(reliableBuffer))) > 0)
     {
-        FPS = duration_cast<frame>(steady_clock::now() - fpsTimer);
-        if (FPS.count() >= 1)
+        SendToClient(p->client, reliableBuffer, length);
+        p->traffic.CountOut(length);
+        serverTraffic.CountOut(length);
+    }
+}
+
+//The player connected from this address, if any
+Player* FindPlayerByAddress(const sockaddr_in& address)
+{
+    uint32_t handle = connections.Find(address);
+    return handle == CONNECTION_TABLE_EMPTY ? nullptr : players.Get(handle);
+}
+
+//The player a message claims to be from, only if it came from their address with their token
+Player* FindSession(const sockaddr_in& address, uint32_t token)
+{
+    Player* p = FindPlayerByAddress(address);
+    return p != nullptr && p->token == token ? p : nullptr;
+}
+
+//Frees a player's slot and address and takes their projectiles out of the world
+void RemovePlayer(Player* p)
+{
+    int slot = SlotMap<Player>::IndexOf(p->GetID());
+    for (int i = 0; i < PROJECTILES_PER_PLAYER; i++)
+        projectiles.Kill(slot * PROJECTILES_PER_PLAYER + i);
+
+    connections.Remove(p->client);
+    players.Remove(p->GetID());
+    delete p;
+}
+
+//Drops clients that stopped sending without saying goodbye.
+//Every connected client sends input at its network rate, so a quiet one is gone
+void RemoveTimedOutPlayers()
+{
+    uint32_t timeoutTicks = (uint32_t)(tickRate * CLIENT_TIMEOUT_SECONDS);
+    for (int i = 0; i < players.Capacity(); i++)
+    {
+        Player* p = players.At(i);
+        if (p == nullptr || serverTick - p->lastHeardTick <= timeoutTicks) continue;
+
+        std::cout << "Player " << i << " timed out." << std::endl;
+        RemovePlayer(p);
+    }
+}
+
+//Charges a datagram straight off the socket to the player that sent it.
+//Messages unwrapped from a reliable one were already counted with it
+void CountReceived(Player* p, Datagram* datagram)
+{
+    if (datagram != &delivered) p->traffic.CountIn(datagram->length);
+}
+
+//Handles a single client message. Runs on the game loop thread.
+void HandleDatagram(Datagram* datagram)
+{
+    sockaddr_in sender = datagram->address;
+
+    //Read in place, only as far as the client actually sent
+    PacketReader reader(datagram->data, datagram->length);
+    unsigned int msgType = reader.ReadUInt32();
+    if (reader.Overflowed()) return;
+
+    //Connection Request: cookie, then the player's starting movement data
+    if (msgType == 1)
+    {
+        if (reader.GetRemaining() < 44) return;
+
+        //Client retries until it hears back. The accept is already on its way again through the reliable channel
+        if (FindPlayerByAddress(sender) != nullptr) return;
+
+        //No slot or reliable channel until the client shows it gets mail at the address it claims.
+        //Anyone else hears back once, with less than they sent
+        uint32_t window = serverTick / (uint32_t)(tickRate * CHALLENGE_WINDOW_SECONDS);
+        uint64_t cookie = reader.ReadUInt32();
+        cookie |= (uint64_t)reader.ReadUInt32() << 32;
+        if (!challenge.Check(sender, cookie, window))
         {
-            fpsTimer = steady_clock::now();
-            float deltaTime = duration_cast<ms>(FPS).count() / 1000;
-            //std::cout << "LastFrame: " << duration_cast<ms>(FPS).count() << "ms  |  FPS: " << FPS.count() * 60 << std::endl;
-        
-            //Update every player
-            for (size_t i = 0; i < MAX_PLAYERS; i++)
-            {
-                if (players[i] == nullptr) continue;
-                players[i]->Update(deltaTime);
-            }
+            cookie = challenge.MakeCookie(sender, window);
+            char reply[12];
+            PacketWriter writer(reply, sizeof(reply));
+            writer.WriteUInt32(5);
+            writer.WriteUInt32((uint32_t)cookie);
+            writer.WriteUInt32((uint32_t)(cookie >> 32));
+            SendToClient(sender, reply, writer.GetLength());
+            return;
+        }
 
-            //Update every projectile
-            for (int i = 0; i < MAX_PROJECTILES; i++)
-            {
-                Projectile* p = &(projectiles[i]);
-                if (!p->dead)
-                {
-                    p->Update(deltaTime);
-                    if (p->dead)
-                    {
-                        //Do nothing I guess?? lmao
-                        p->GetTransform()->SetPosition(0, -5000, 0);
-                    }
-                }
-            }
+        Player* np = new Player(sender, 0);
+        uint32_t handle = players.Insert(np);
+        if (handle == SLOT_MAP_INVALID_HANDLE)
+        {
+            //Server full
+            delete np;
+        }
+        else if (!connections.Insert(sender, handle))
+        {
+            players.Remove(handle);
+            delete np;
+        }
+        else
+        {
 
-            for (int i = 0; i < MAX_PLAYERS; i++)
-            {
-                if (players[i] == nullptr) continue;
-                for (int j = 0; j < MAX_PROJECTILES; j++)
-                {
-                    //ignore a few frames to avoid instant self collision
-                    if (projectiles[j].dead || projectiles[j].age < 0.1f) continue; 
-                    if (Helpers::CheckProjectileCollision(players[i], &projectiles[j], deltaTime, 3))
-                    {
-                        std::cout << "Player " << i << " is hit!" << std::endl;
-                        projectiles[j].dead = true;
-                        projectiles[j].age = projectiles[j].lifespan + 1; //tells the clients it's dead
-                        projectiles[j].GetTransform()->SetPosition(0, -5000, 0);
-                    }
-                }
-            }
-        
-            //Send player position and velocity data to each client
-            std::fill_n(sendbuffer, 500, 0);
+            ////Tell every other played someone joined
+            //for (int i = 0; i < players.Capacity(); i++)
+            //{
+            //    if (players.At(i) == nullptr) continue;
+            //    //Send a response
+            //    std::fill_n(sendbuffer, 500, 0);
+
+            //    unsigned int data = 2;
+            //    std::memcpy(&sendbuffer, &data, 4);
+            //    Socket.SendTo(players.At(i)->client, sendbuffer, 500);
+            //}
+
+
+            //Respond with 1 to accept, followed by a player ID
+
+            np->ID = handle;
+            np->lastHeardTick = serverTick;
+            np->sendRate.Reset(serverTick);
+            do np->token = tokenGenerator(); while (np->token == 0);
+            positionHistory.ClearSlot(SlotMap<Player>::IndexOf(handle)); //Don't rewind into whoever had the slot before
 
-            int msgtyp = 10;
+            //Read player initial position and velocity
+            Helpers::ReadPlayerMovementData(np, &reader);
 
-            std::memcpy(&sendbuffer, &msgtyp, 4);
-            for (size_t i = 0; i < MAX_PLAYERS; i++)
+            //Send a response, which with the reliable header is still smaller than the request
+            char accept[24];
+            PacketWriter writer(accept, sizeof(accept));
+            writer.WriteUInt32(1);
+            writer.WriteUInt32(np->token); //The client's ID from now on
+            writer.WriteUInt32(players.Capacity());
+            writer.WriteUInt32(SlotMap<Player>::IndexOf(handle)); //Our slot in world updates
+            writer.WriteUInt32(PROJECTILES_PER_PLAYER);
+            writer.WriteUInt32(tickRate); //How far apart snapshot sequence numbers are
+
+            //Resent until the client acks it, a lost accept would leave it stuck connecting
+            np->reliable.Send(accept, writer.GetLength());
+            FlushReliable(np);
+
+            std::cout << "Player " << SlotMap<Player>::IndexOf(handle) << " joined.\n";
+        }
+        return;
+    }
+
+    //Everything else comes from a connected client, which puts its session token right after the type.
+    //Anything not from a known address with that address's token is dropped here
+    unsigned int token = reader.ReadUInt32();
+    Player* p = FindSession(sender, token);
+    if (p == nullptr) return;
+    CountReceived(p, datagram);
+    p->lastHeardTick = serverTick;
+
+    if (msgType == 3) //New projectile
+    {
+        int index = reader.ReadInt32();
+        if (reader.GetRemaining() < 48) return;
+        if (index < 0 || index >= PROJECTILES_PER_PLAYER) return;
+
+        //Straight into the owner's block
+        Helpers::ReadProjectileMovementData(&projectiles, SlotMap<Player>::IndexOf(p->GetID()) * PROJECTILES_PER_PLAYER + index, &reader);
+    }
+    else if (msgType == 20) //Reliable message, unwrap and handle everything now in order
+    {
+        if (!p->reliable.Receive(datagram->data, datagram->length)) return;
+
+        uint32_t handle = p->GetID();
+        delivered.address = sender;
+        while ((delivered.length = p->reliable.Deliver(delivered.data, MAX_DATAGRAM_SIZE)) > 0)
+        {
+            if (*(unsigned int*)delivered.data == 20) continue;
+            HandleDatagram(&delivered);
+
+            //That message may have been a disconnect
+            if (players.Get(handle) == nullptr) return;
+        }
+    }
+    else if (msgType == 4) //Intentional Disconnect
+    {
+        std::cout << "Player " << SlotMap<Player>::IndexOf(p->GetID()) << " disconnected." << std::endl;
+
+        //Echo the disconnect back, which also frees a client blocked in recvfrom
+        char goodbye[4];
+        PacketWriter writer(goodbye, sizeof(goodbye));
+        writer.WriteUInt32(4);
+        SendToClient(p->client, goodbye, writer.GetLength());
+
+        RemovePlayer(p);
+    }
+    else if (msgType == 6) //Tick times, for load testing. Answers with every tick since the last request that asked for a reset
+    {
+        unsigned int reset = reader.ReadUInt32();
+        if (reader.Overflowed()) return;
+
+        //Microseconds, with the request's reset flag echoed so a late answer can't pass for another
+        LatencyHistogram& ticks = profiler.GetSpan();
+        char reply[44];
+        PacketWriter writer(reply, sizeof(reply));
+        writer.WriteUInt32(6);
+        writer.WriteUInt32(reset);
+        writer.WriteUInt32((uint32_t)profiler.GetBudget());
+        writer.WriteUInt32((uint32_t)ticks.GetCount());
+        writer.WriteUInt32((uint32_t)ticks.GetMean());
+        writer.WriteUInt32((uint32_t)ticks.GetPercentile(0.5));
+        writer.WriteUInt32((uint32_t)ticks.GetPercentile(0.9));
+        writer.WriteUInt32((uint32_t)ticks.GetPercentile(0.99));
+        writer.WriteUInt32((uint32_t)ticks.GetPercentile(0.999));
+        writer.WriteUInt32((uint32_t)ticks.GetMax());
+        writer.WriteUInt32((uint32_t)profiler.GetSpanOverBudgetCount());
+        SendToClient(p->client, reply, writer.GetLength());
+
+        if (reset != 0) profiler.ResetSpan();
+    }
+    else if(msgType == 10) //Player input
+    { 
+        int ack = reader.ReadInt32();
+        int count = reader.ReadInt32();
+        unsigned int viewTick = reader.ReadUInt32();
+        float viewFraction = reader.ReadFloat();
+        uint16_t reliableAck = (uint16_t)reader.ReadUInt32();
+        uint32_t reliableAckBits = reader.ReadUInt32();
+        uint32_t snapshotsReceived = reader.ReadUInt32();
+        if (reader.Overflowed()) return;
+
+        //Newest world update the client has, used as the baseline for its next one
+        if (ack >= 0 && (p->ackedSnapshot < 0 || SnapshotCodec::SequenceNewer((uint16_t)ack, (uint16_t)p->ackedSnapshot)))
+            p->ackedSnapshot = ack;
+
+        //Round trip and loss for this client's send rate
+        if (ack >= 0) p->sendRate.OnAck((uint16_t)ack, snapshotsReceived, serverTick);
+
+        //Tick the client is drawing everyone else at, so its shots can be checked against that
+        if (viewTick == NO_VIEW_TICK)
+        {
+            p->viewLagTicks = 0;
+        }
+        else
+        {
+            float lag = (int16_t)((uint16_t)serverTick - (uint16_t)viewTick) - viewFraction;
+            float maxLag = (float)(positionHistory.GetTickCapacity() - 1);
+            p->viewLagTicks = fminf(fmaxf(lag, 0), maxLag);
+        }
+
+        //Reliable messages the client has from us
+        p->reliable.ProcessAck(reliableAck, reliableAckBits);
+
+        //Inputs oldest first. The client keeps resending them until a world update tells it we have them
+        if (count > MAX_INPUTS_PER_PACKET) count = MAX_INPUTS_PER_PACKET;
+        if (count > reader.GetRemaining() / PLAYER_INPUT_SIZE) count = reader.GetRemaining() / PLAYER_INPUT_SIZE;
+
+        for (int i = 0; i < count; i++)
+        {
+            PlayerInput input;
+            PlayerMovement::ReadInput(reader.ReadBytes(PLAYER_INPUT_SIZE), &input);
+            if (input.sequence > p->lastInputSequence) p->ApplyInput(input);
+        }
+    }
+}
+
+//Handles what the receive thread has queued, up to INBOUND_QUEUE_SIZE packets. The rest stay queued
+void HandleInbound()
+{
+    int budget = INBOUND_QUEUE_SIZE;
+    int count;
+    Datagram* slots = inbound.ReadSlots(&count);
+    while (count > 0 && budget > 0)
+    {
+        if (count > budget) count = budget;
+        for (int i = 0; i < count; i++)
+        {
+            serverTraffic.CountIn(slots[i].length);
+            if (recorder.IsOpen()) recorder.RecordDatagram(&slots[i]);
+            try
             {
-                if (players[i] == nullptr)
-                {
-                    float z = -5000;
-                    std::memcpy(&sendbuffer[0] + (i * 36) + 12, &z, 4);
-                    continue;
-                }
-                Helpers::CopyPlayerMovementData(players[i], &sendbuffer[0] + (i * 36) + 4);
+                HandleDatagram(&slots[i]);
             }
-            for (size_t i = 0; i < MAX_PROJECTILES; i++)
+            catch (std::exception& ex)
             {
-                Helpers::CopyProjectileMovementData(&projectiles[i], &sendbuffer[0] + (MAX_PLAYERS * 36) + (i * 48) + 4);
+                std::cout << ex.what() << std::endl;
             }
-            for (size_t i = 0; i < MAX_PLAYERS; i++)
+        }
+        inbound.Release(count);
+        budget -= count;
+        slots = inbound.ReadSlots(&count);
+    }
+}
+
+//Advances the world by one fixed step.
+//Players and projectiles are stepped in parallel runs of slots, hit checks in parallel by region,
+//then hits are applied in projectile order so the outcome matches a single threaded step
+void Simulate(float deltaTime)
+{
+    TickProfiler::clock::time_point start = TickProfiler::Now();
+    serverTick++;
+
+    //Update every player, and remember where they ended up this tick
+    positionHistory.BeginTick(serverTick);
+    workerPool->ParallelForRange(players.Capacity(), PLAYER_JOB_GRAIN, [deltaTime](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            Player* p = players.At(i);
+            if (p == nullptr) continue;
+            p->Update(deltaTime);
+            positionHistory.Record(i, p->positionX, p->positionY, p->positionZ);
+        }
+    });
+
+    //Update every projectile and work out where it will sweep through next
+    workerPool->ParallelForRange(projectiles.Count(), PROJECTILE_JOB_GRAIN, [deltaTime](int begin, int end)
+    {
+        projectiles.Update(deltaTime, begin, end);
+
+        for (int j = begin; j < end; j++)
+        {
+            //ignore a few frames to avoid instant self collision
+            if (!projectiles.IsAlive(j) || projectiles.GetAge(j) < 0.1f)
             {
-                if (players[i] == nullptr) continue;
-                Socket.SendTo(players[i]->client, sendbuffer, 500);
+                collider.SetInactive(j);
+                continue;
             }
+
+            VectorMath::float3 start, end;
+            projectiles.GetSweep(j, deltaTime, &start, &end);
+
+            //Check against everyone where the shooter saw them, not where they are now
+            Player* shooter = players.At(j / PROJECTILES_PER_PLAYER);
+            float lag = shooter != nullptr ? shooter->viewLagTicks : 0;
+
+            //Only players in cells the sweep passes near, allowing for how far they could have moved since
+            float margin = PROJECTILE_HIT_RADIUS + lag * deltaTime * MAX_REWIND_SPEED;
+            collider.SetSweep(j, start.x, start.y, start.z, end.x, end.y, end.z, margin, (double)serverTick - lag);
+        }
+    });
+
+    //Keep the player grid in sync. Players only change buckets when they cross a cell
+    for (int i = 0; i < players.Capacity(); i++)
+    {
+        Player* p = players.At(i);
+        if (p == nullptr)
+        {
+            playerGrid.Remove(i);
+            continue;
+        }
+        VectorMath::float3 c = Helpers::GetPlayerHitCenter(p);
+        playerGrid.Update(i, c.x, c.y, c.z);
+    }
+
+    start = profiler.Record(TickPhase::Simulate, start);
+
+    collider.Collide(workerPool, playerGrid, positionHistory);
+
+    //Apply hits in a fixed order, whichever threads found them
+    for (int j = 0; j < projectiles.Count(); j++)
+    {
+        int hit = collider.GetHit(j);
+        if (hit != -1)
+        {
+            std::cout << "Player " << hit << " is hit!" << std::endl;
+            projectiles.Kill(j);
+        }
+    }
+
+    profiler.Record(TickPhase::Collide, start);
+}
+
+//Leaves a player or projectile (indexed after the players) as the client already has it in the baseline,
+//or out of the update if the client has nothing for it
+void HoldBack(WorldSnapshot& visible, const WorldSnapshot* baseline, int index)
+{
+    int count = (int)visible.players.size();
+    if (index < count)
+    {
+        if (baseline != nullptr && index < (int)baseline->players.size() && baseline->players[index].present)
+            visible.players[index] = baseline->players[index];
+        else
+            visible.players[index].present = false;
+        return;
+    }
+
+    index -= count;
+    if (baseline != nullptr && index < (int)baseline->projectiles.size() && baseline->projectiles[index].present)
+        visible.projectiles[index] = baseline->projectiles[index];
+    else
+        visible.projectiles[index].present = false;
+}
+
+//Encodes a client's world update into one datagram. If it's too big, the players and projectiles farthest
+//from the client are held back, a quarter of what's left at a time, until it fits. They catch up in later
+//updates, since those are built against what this one actually sent. Returns 0 if even that didn't fit
+int WriteToFit(Player* p, int slot, WorldSnapshot& visible, const WorldSnapshot* baseline, char* buffer)
+{
+    int length = SnapshotCodec::Write(visible, baseline, buffer, MAX_DATAGRAM_SIZE);
+    if (length > 0) return length;
+
+    //A baseline on another grid is ignored by Write, so there's nothing to fall back on
+    if (baseline != nullptr && baseline->positionBits != visible.positionBits) baseline = nullptr;
+
+    //Everything present but the client itself, farthest first
+    const int32_t* own = visible.players[slot].position;
+    int playerCount = (int)visible.players.size();
+    p->farthest.clear();
+    for (int i = 0; i < playerCount; i++)
+    {
+        if (i == slot || !visible.players[i].present) continue;
+        const int32_t* pos = visible.players[i].position;
+        float dx = (float)(pos[0] - own[0]), dy = (float)(pos[1] - own[1]), dz = (float)(pos[2] - own[2]);
+        p->farthest.push_back(std::make_pair(dx * dx + dy * dy + dz * dz, i));
+    }
+    for (int i = 0; i < (int)visible.projectiles.size(); i++)
+    {
+        if (!visible.projectiles[i].present) continue;
+        const int32_t* pos = visible.projectiles[i].position;
+        float dx = (float)(pos[0] - own[0]), dy = (float)(pos[1] - own[1]), dz = (float)(pos[2] - own[2]);
+        p->farthest.push_back(std::make_pair(dx * dx + dy * dy + dz * dz, playerCount + i));
+    }
+    std::sort(p->farthest.begin(), p->farthest.end(), std::greater<std::pair<float, int>>());
+
+    size_t held = 0;
+    while (length == 0 && held < p->farthest.size())
+    {
+        size_t next = held + (p->farthest.size() - held + 3) / 4;
+        for (; held < next; held++)
+            HoldBack(visible, baseline, p->farthest[held].second);
+        length = SnapshotCodec::Write(visible, baseline, buffer, MAX_DATAGRAM_SIZE);
+    }
+
+    if (length > 0) trimmedUpdates++;
+    return length;
+}
+
+//Builds and encodes one client's world update from the shared snapshot.
+//Only touches that player's own data, so clients can be encoded in parallel
+void EncodeForClient(int slot, Datagram* d)
+{
+    Player* p = players.At(slot);
+    WorldSnapshot& visible = p->visibleSnapshot;
+
+    if (interestRadius <= 0)
+    {
+        //Everyone sees everything
+        visible = snapshot;
+    }
+    else
+    {
+        visible.sequence = snapshot.sequence;
+        visible.positionBits = snapshot.positionBits;
+        visible.players.resize(snapshot.players.size());
+        visible.projectiles.resize(snapshot.projectiles.size());
+        for (size_t i = 0; i < visible.players.size(); i++) visible.players[i].present = false;
+        for (size_t i = 0; i < visible.projectiles.size(); i++) visible.projectiles[i].present = false;
+
+        //Always see yourself
+        visible.players[slot] = snapshot.players[slot];
+
+        float x = p->positionX, y = p->positionY, z = p->positionZ;
+        float r = interestRadius;
+
+        p->nearby.clear();
+        interestPlayerGrid.Query(x - r, y - r, z - r, x + r, y + r, z + r, p->nearby);
+        for (size_t i = 0; i < p->nearby.size(); i++)
+        {
+            Player* other = players.At(p->nearby[i]);
+            float dx = other->positionX - x, dy = other->positionY - y, dz = other->positionZ - z;
+            if (dx * dx + dy * dy + dz * dz <= r * r)
+                visible.players[p->nearby[i]] = snapshot.players[p->nearby[i]];
+        }
+
+        p->nearby.clear();
+        interestProjectileGrid.Query(x - r, y - r, z - r, x + r, y + r, z + r, p->nearby);
+        for (size_t i = 0; i < p->nearby.size(); i++)
+        {
+            VectorMath::float3 pos = projectiles.GetPosition(p->nearby[i]);
+            float dx = pos.x - x, dy = pos.y - y, dz = pos.z - z;
+            if (dx * dx + dy * dy + dz * dz <= r * r)
+                visible.projectiles[p->nearby[i]] = snapshot.projectiles[p->nearby[i]];
+        }
+    }
+
+    //Where the server has this client, for it to reconcile its own prediction against
+    visible.hasOwnerState = true;
+    visible.ownerInputSequence = p->lastInputSequence;
+    visible.ownerPosition[0] = p->positionX;
+    visible.ownerPosition[1] = p->positionY;
+    visible.ownerPosition[2] = p->positionZ;
+    visible.ownerVelocity[0] = p->velocityX;
+    visible.ownerVelocity[1] = p->velocityY;
+    visible.ownerVelocity[2] = p->velocityZ;
+    p->reliable.GetAck(&visible.reliableAck, &visible.reliableAckBits);
+
+    //A backed off client gets coarser positions as well as fewer updates
+    visible.interval = p->sendRate.GetInterval();
+    int bits = p->sendRate.GetPositionBits(snapshot.positionBits);
+    if (bits != snapshot.positionBits)
+    {
+        visible.positionBits = bits;
+        for (size_t i = 0; i < visible.players.size(); i++)
+        {
+            if (!visible.players[i].present) continue;
+            for (int k = 0; k < 3; k++)
+                visible.players[i].position[k] = SnapshotCodec::RequantizePosition(visible.players[i].position[k], snapshot.positionBits, bits);
+        }
+        for (size_t i = 0; i < visible.projectiles.size(); i++)
+        {
+            if (!visible.projectiles[i].present) continue;
+            for (int k = 0; k < 3; k++)
+                visible.projectiles[i].position[k] = SnapshotCodec::RequantizePosition(visible.projectiles[i].position[k], snapshot.positionBits, bits);
         }
     }
+
+    //Only what changed since the last update this client acknowledged
+    const WorldSnapshot* baseline = nullptr;
+    if (p->ackedSnapshot >= 0) baseline = p->sentSnapshots.Find((uint16_t)p->ackedSnapshot);
+
+    d->address = p->client;
+    d->length = WriteToFit(p, slot, visible, baseline, d->data);
+    if (d->length > 0)
+    {
+        p->sentSnapshots.Store(visible);
+        p->sendRate.OnSent(visible.sequence, serverTick);
+    }
+}
+
+//Send player position and velocity data to each client
+void BroadcastState()
+{
+    TickProfiler::clock::time_point start = TickProfiler::Now();
+
+    snapshot.sequence = (uint16_t)serverTick;
+    snapshot.positionBits = positionBits;
+    snapshot.players.resize(players.Capacity());
+    snapshot.projectiles.resize(projectiles.Count());
+
+    connectedSlots.clear();
+    dueSlots.clear();
+    for (int i = 0; i < players.Capacity(); i++)
+    {
+        if (players.At(i) == nullptr)
+        {
+            snapshot.players[i].present = false;
+            interestPlayerGrid.Remove(i);
+            continue;
+        }
+        Helpers::CopyPlayerMovementData(players.At(i), &snapshot.players[i], positionBits);
+        interestPlayerGrid.Update(i, players.At(i)->positionX, players.At(i)->positionY, players.At(i)->positionZ);
+        connectedSlots.push_back(i);
+
+        //Clients at the same reduced rate are spread over different ticks by slot, so the send load stays even
+        players.At(i)->sendRate.Update(serverTick, tickRate);
+        if (players.At(i)->sendRate.IsDue(serverTick, i)) dueSlots.push_back(i);
+    }
+    for (int i = 0; i < projectiles.Count(); i++)
+    {
+        Helpers::CopyProjectileMovementData(&projectiles, i, &snapshot.projectiles[i], positionBits);
+        if (!projectiles.IsAlive(i))
+        {
+            interestProjectileGrid.Remove(i);
+            continue;
+        }
+        VectorMath::float3 pos = projectiles.GetPosition(i);
+        interestProjectileGrid.Update(i, pos.x, pos.y, pos.z);
+    }
+
+    //Each client gets its own filtered, delta encoded update
+    workerPool->ParallelFor((int)dueSlots.size(), [](int i)
+    {
+        EncodeForClient(dueSlots[i], &sendBatch[i]);
+    });
+
+    //Drop any that didn't fit, keeping the rest contiguous
+    int sendCount = 0;
+    for (size_t i = 0; i < dueSlots.size(); i++)
+    {
+        if (sendBatch[i].length == 0)
+        {
+            unsentUpdates++;
+            continue;
+        }
+        if ((int)i != sendCount) sendBatch[sendCount] = sendBatch[i];
+        sendCount++;
+
+        players.At(dueSlots[i])->traffic.CountOut(sendBatch[i].length);
+        serverTraffic.CountOut(sendBatch[i].length);
+    }
+
+    start = profiler.Record(TickPhase::Encode, start);
+
+    try
+    {
+        if (!replaying) Socket.SendBatch(sendBatch.data(), sendCount);
+
+        //Anything reliable that's gone unacknowledged too long
+        for (size_t i = 0; i < connectedSlots.size(); i++)
+            FlushReliable(players.At(connectedSlots[i]));
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+
+    profiler.Record(TickPhase::Send, start);
 }
 
-int main()
+//Writes phase timings and traffic since the last report, then starts the next period.
+//Goes to a temporary file first so anything watching the stats file never sees half of one
+void WriteStats(float seconds)
+{
+    std::string tempPath = statsPath + ".tmp";
+    {
+        std::ofstream out(tempPath.c_str(), std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "Couldn't write stats to " << tempPath << std::endl;
+            return;
+        }
+
+        out << "GameServer tick " << serverTick << ", " << tickRate << " ticks per second, "
+            << players.Count() << "/" << players.Capacity() << " players, last " << seconds << "s\n\n";
+
+        profiler.WriteReport(out);
+
+        out << "\nInbound " << serverTraffic.packetsIn / seconds << " packets/s " << serverTraffic.bytesIn / seconds << " bytes/s, "
+            << inbound.GetDroppedCount() << " dropped since start\n";
+        out << "Outbound " << serverTraffic.packetsOut / seconds << " packets/s " << serverTraffic.bytesOut / seconds << " bytes/s, "
+            << trimmedUpdates.load() << " world updates trimmed to fit, " << unsentUpdates << " too big to send\n";
+
+        out << "\nslot  address                  in packets/s  in bytes/s  out packets/s  out bytes/s  view lag ticks  rtt ms  loss %  send level\n";
+        for (int i = 0; i < players.Capacity(); i++)
+        {
+            Player* p = players.At(i);
+            if (p == nullptr) continue;
+
+            float rttMs = p->sendRate.GetRttTicks() < 0 ? 0 : p->sendRate.GetRttTicks() * 1000.0f / tickRate;
+
+            char line[200];
+            snprintf(line, sizeof(line), "%-5d %-24s %12.1f %11.0f %14.1f %12.0f %15.2f %7.0f %7.1f %11d\n", i,
+                (std::string(inet_ntoa(p->client.sin_addr)) + ":" + std::to_string(ntohs(p->client.sin_port))).c_str(),
+                p->traffic.packetsIn / seconds, p->traffic.bytesIn / seconds,
+                p->traffic.packetsOut / seconds, p->traffic.bytesOut / seconds, p->viewLagTicks,
+                rttMs, p->sendRate.GetLoss() * 100.0f, p->sendRate.GetLevel());
+            out << line;
+            p->traffic.Reset();
+        }
+    }
+
+    //rename won't replace an existing file everywhere
+    std::remove(statsPath.c_str());
+    std::rename(tempPath.c_str(), statsPath.c_str());
+
+    profiler.Reset();
+    serverTraffic.Reset();
+    unsentUpdates = 0;
+    trimmedUpdates = 0;
+}
+
+//Runs the simulation at a fixed tick rate
+void GameLoop()
+{
+    TickScheduler scheduler(tickRate);
+    float deltaTime = scheduler.GetDeltaTime();
+    profiler.SetBudget((uint64_t)(1000000 / tickRate));
+
+    uint64_t reportedOverruns = 0;
+
+    while (gameLoopRunning)
+    {
+        int ticks = scheduler.WaitForNextTick();
+        TickProfiler::clock::time_point tickStart = TickProfiler::Now();
+
+        //Apply every client message that arrived since last tick
+        HandleInbound();
+        RemoveTimedOutPlayers();
+        profiler.Record(TickPhase::Receive, tickStart);
+
+        //If we fell behind, catch up with the same fixed step rather than one big one
+        for (int i = 0; i < ticks; i++)
+            Simulate(deltaTime);
+
+        BroadcastState();
+        profiler.Record(TickPhase::Tick, tickStart);
+
+        if (recorder.IsOpen()) recorder.RecordTick(ticks);
+
+        if (!statsPath.empty() && scheduler.GetTickCount() % (uint64_t)(scheduler.GetTickRate() * statsInterval) < (uint64_t)ticks)
+            WriteStats((float)statsInterval);
+
+        //Report overruns about once every 10 seconds
+        if (scheduler.GetTickCount() % (uint64_t)(scheduler.GetTickRate() * 10) < (uint64_t)ticks &&
+            scheduler.GetOverrunCount() != reportedOverruns)
+        {
+            reportedOverruns = scheduler.GetOverrunCount();
+            std::cout << "Tick overruns: " << reportedOverruns << " (" << scheduler.GetSkippedTicks() << " ticks skipped)" << std::endl;
+        }
+    }
+}
+
+//Queues one recorded game loop pass's datagrams and handles them.
+//Returns how many steps that pass simulated, 0 once the log runs out
+int ReplayInbound()
+{
+    int steps = 0;
+    uint64_t micros;
+    while (true)
+    {
+        int freeSlots;
+        Datagram* slots = inbound.WriteSlots(&freeSlots);
+        if (freeSlots == 0)
+        {
+            //Only logs from before passes were capped at INBOUND_QUEUE_SIZE packets get here.
+            //Handling a full ring empties it, since nothing else is adding to it
+            HandleInbound();
+            continue;
+        }
+
+        int type = replayer.Next(slots, &steps, &micros);
+        if (type != TRAFFIC_LOG_DATAGRAM) break;
+        inbound.Publish(1);
+    }
+
+    HandleInbound();
+    return steps;
+}
+
+//Runs a recorded session through the same message handling and simulation as GameLoop, as fast as it can.
+//Every pass gets the same messages and steps it did live, so the world ends up the same
+void ReplayLoop()
+{
+    float deltaTime = 1.0f / tickRate;
+    profiler.SetBudget((uint64_t)(1000000 / tickRate));
+
+    steady_clock::time_point started = steady_clock::now();
+    uint64_t tickCount = 0;
+
+    while (true)
+    {
+        TickProfiler::clock::time_point tickStart = TickProfiler::Now();
+
+        int ticks = ReplayInbound();
+        if (ticks == 0) break;
+        RemoveTimedOutPlayers();
+        profiler.Record(TickPhase::Receive, tickStart);
+
+        for (int i = 0; i < ticks; i++)
+            Simulate(deltaTime);
+
+        BroadcastState();
+        profiler.Record(TickPhase::Tick, tickStart);
+
+        tickCount += ticks;
+        if (!statsPath.empty() && tickCount % (uint64_t)(tickRate * statsInterval) < (uint64_t)ticks)
+            WriteStats((float)statsInterval);
+    }
+
+    float elapsed = duration_cast<duration<float>>(steady_clock::now() - started).count();
+    float played = (float)tickCount / tickRate;
+    std::cout << "Replayed " << tickCount << " ticks (" << played << "s) in " << elapsed << "s, "
+        << (elapsed > 0 ? played / elapsed : 0) << " times real time. " << players.Count() << " players connected at the end" << std::endl;
+    profiler.WriteReport(std::cout);
+}
+
+int main(int argc, char* argv[])
 {
     std::string IP = "127.0.0.1";
     int PORT = 8888;
+    int maxPlayers = DEFAULT_MAX_PLAYERS;
+    int workerCount = 0;
+    std::string recordPath;
+    std::string replayPath;
+    std::random_device entropy;
+    uint32_t tokenSeed = entropy();
+    uint64_t challengeKey[2];
+    for (int k = 0; k < 2; k++) challengeKey[k] = ((uint64_t)entropy() << 32) | entropy();
+
+    //GameServer [-port N] [-tickrate N] [-gridbits N] [-maxplayers N] [-interestradius R] [-workers N] [-stats FILE] [-statsinterval S] [-record FILE] [-replay FILE]
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "-port") PORT = atoi(argv[i + 1]);
+        else if (arg == "-tickrate") tickRate = atoi(argv[i + 1]);
+        else if (arg == "-gridbits") positionBits = atoi(argv[i + 1]);
+        else if (arg == "-maxplayers") maxPlayers = atoi(argv[i + 1]);
+        else if (arg == "-interestradius") interestRadius = (float)atof(argv[i + 1]);
+        else if (arg == "-workers") workerCount = atoi(argv[i + 1]);
+        else if (arg == "-stats") statsPath = argv[i + 1];
+        else if (arg == "-statsinterval") statsInterval = atoi(argv[i + 1]);
+        else if (arg == "-record") recordPath = argv[i + 1];
+        else if (arg == "-replay") replayPath = argv[i + 1];
+    }
+    if (positionBits < 0) positionBits = 0;
+    if (positionBits > 15) positionBits = 15;
+    if (tickRate < 1) tickRate = 1;
+    if (maxPlayers < 1) maxPlayers = 1;
+    if (statsInterval < 1) statsInterval = 1;
+    if (maxPlayers > SNAPSHOT_MAX_PLAYERS) maxPlayers = SNAPSHOT_MAX_PLAYERS;
+    if (maxPlayers > SNAPSHOT_MAX_PROJECTILES / PROJECTILES_PER_PLAYER) maxPlayers = SNAPSHOT_MAX_PROJECTILES / PROJECTILES_PER_PLAYER;
+
+    if (!replayPath.empty())
+    {
+        if (!replayer.Open(replayPath))
+        {
+            std::cout << "Couldn't read traffic log " << replayPath << std::endl;
+            return 1;
+        }
+
+        //Steps and player slots only line up with the settings the session was recorded with
+        replaying = true;
+        tickRate = replayer.GetTickRate();
+        maxPlayers = replayer.GetMaxPlayers();
+        tokenSeed = replayer.GetTokenSeed();
+        challengeKey[0] = replayer.GetChallengeKey(0);
+        challengeKey[1] = replayer.GetChallengeKey(1);
+    }
+    tokenGenerator.seed(tokenSeed);
+    challenge.SetKey(challengeKey[0], challengeKey[1]);
+
+    players.Resize(maxPlayers);
+    connections.Resize(maxPlayers);
+    projectiles.Resize(maxPlayers * PROJECTILES_PER_PLAYER);
+    collider.Resize(projectiles.Count());
+    sendBatch.resize(maxPlayers);
+    positionHistory.Resize((int)ceilf(tickRate * MAX_REWIND_SECONDS) + 1, maxPlayers);
+
+    if (interestRadius > 0)
+    {
+        //Cells as big as the radius, so a query only ever touches the neighbouring cells
+        interestPlayerGrid = SpatialHash(interestRadius);
+        interestProjectileGrid = SpatialHash(interestRadius);
+    }
+    workerPool = new ThreadPool(workerCount);
+
+    if (replaying)
+    {
+        std::cout << "Replaying " << replayPath << ", " << tickRate << " ticks per second, " << maxPlayers << " players" << std::endl;
+        ReplayLoop();
+        return 0;
+    }
+
+    if (!recordPath.empty())
+    {
+        if (recorder.Open(recordPath, tickRate, maxPlayers, tokenSeed, challengeKey))
+            std::cout << "Recording inbound traffic to " << recordPath << std::endl;
+        else
+            std::cout << "Couldn't write traffic log " << recordPath << std::endl;
+    }
 
     std::thread gameLoop;
     std::thread recvLoop;
@@ -285,12 +1033,7 @@ int main()
         gameLoop = std::thread(&GameLoop);
         recvLoop = std::thread(&RecvFromLoop);
 
-        for (int i = 0; i < MAX_PROJECTILES; i++)
-        {
-            projectiles[i].GetTransform()->SetPosition(0, -5000, 0);
-        }
-
-        std::cout << "Server online. Port number " << PORT << std::endl;
+        std::cout << "Server online. Port number " << PORT << ", " << tickRate << " ticks per second, " << maxPlayers << " players" << std::endl;
 
     }
     catch (std::exception& ex)
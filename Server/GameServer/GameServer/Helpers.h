@@ -3,188 +3,150 @@
 #include <cmath>
 
 #include "Player.h"
-#include "Projectile.h"
+#include "../../../Snapshot.h"
+#include "../../../Packet.h"
+#include "../../../ProjectileSystem.h"
 
-static class Helpers
+//Player radius 1.0 plus projectile radius 0.1
+#define PROJECTILE_HIT_RADIUS 1.1f
+
+class Helpers
 {
 public:
-	static void CopyPlayerMovementData(Player* player, char* bff)
+	static void CopyPlayerMovementData(Player* player, PlayerSnapshot* snapshot, int positionBits)
 	{
+		snapshot->present = true;
+
 		//Position x/y/z
-		std::memcpy(bff, &player->positionX, 4);
-		std::memcpy(bff + 4, &player->positionY, 4);
-		std::memcpy(bff + 8, &player->positionZ, 4);
+		snapshot->position[0] = SnapshotCodec::QuantizePosition(player->positionX, positionBits);
+		snapshot->position[1] = SnapshotCodec::QuantizePosition(player->positionY, positionBits);
+		snapshot->position[2] = SnapshotCodec::QuantizePosition(player->positionZ, positionBits);
 
 		//Velocity x/y/z
-		std::memcpy(bff + 12, &player->velocityX, 4);
-		std::memcpy(bff + 16, &player->velocityY, 4);
-		std::memcpy(bff + 20, &player->velocityZ, 4);
+		snapshot->velocity[0] = SnapshotCodec::QuantizeVelocity(player->velocityX);
+		snapshot->velocity[1] = SnapshotCodec::QuantizeVelocity(player->velocityY);
+		snapshot->velocity[2] = SnapshotCodec::QuantizeVelocity(player->velocityZ);
 
 		//pitch/yaw/roll
-		std::memcpy(bff + 24, &player->pitch, 4);
-		std::memcpy(bff + 28, &player->yaw, 4);
-		std::memcpy(bff + 32, &player->roll, 4);
+		snapshot->rotation[0] = SnapshotCodec::QuantizeAngle(player->pitch);
+		snapshot->rotation[1] = SnapshotCodec::QuantizeAngle(player->yaw);
+		snapshot->rotation[2] = SnapshotCodec::QuantizeAngle(player->roll);
 
 	}
 
-	static void ReadPlayerMovementData(Player* player, char* buffer)
+	//Takes 36 bytes
+	static void ReadPlayerMovementData(Player* player, PacketReader* reader)
 	{
-		float* bff = (float*)buffer;
-		player->positionX = *bff;
-		player->positionY = *(bff+1);
-		player->positionZ = *(bff+2);
-
-		player->velocityX = *(bff + 3);
-		player->velocityY = *(bff + 4);
-		player->velocityZ = *(bff + 5);
+		player->positionX = reader->ReadFloat();
+		player->positionY = reader->ReadFloat();
+		player->positionZ = reader->ReadFloat();
+
+		player->velocityX = reader->ReadFloat();
+		player->velocityY = reader->ReadFloat();
+		player->velocityZ = reader->ReadFloat();
 		
-		player->pitch = *(bff + 6);
-		player->yaw = *(bff + 7);
-		player->roll = *(bff + 8);
+		player->pitch = reader->ReadFloat();
+		player->yaw = reader->ReadFloat();
+		player->roll = reader->ReadFloat();
 
 	}
 
-	//Takes 40 bytes
-	static void CopyProjectileMovementData(Projectile* projectile, char* bff)
+	static void CopyProjectileMovementData(ProjectileSystem* projectiles, int index, ProjectileSnapshot* snapshot, int positionBits)
 	{
-		float x = projectile->GetTransform()->GetPosition().x;
-		float y = projectile->GetTransform()->GetPosition().y;
-		float z = projectile->GetTransform()->GetPosition().z;
+		snapshot->present = projectiles->IsAlive(index);
+		if (!snapshot->present) return;
+
+		ProjectileState state;
+		projectiles->GetState(index, &state);
 
 		//Position x/y/z
-		std::memcpy(bff, &x, 4);
-		std::memcpy(bff + 4, &y, 4);
-		std::memcpy(bff + 8, &z, 4);
+		snapshot->position[0] = SnapshotCodec::QuantizePosition(state.position[0], positionBits);
+		snapshot->position[1] = SnapshotCodec::QuantizePosition(state.position[1], positionBits);
+		snapshot->position[2] = SnapshotCodec::QuantizePosition(state.position[2], positionBits);
 
-		//Velocity x/y/z
-		std::memcpy(bff + 12, &projectile->velocityX, 4);
-		std::memcpy(bff + 16, &projectile->velocityY, 4);
-		std::memcpy(bff + 20, &projectile->velocityZ, 4);
+		//Only Y velocity changes in flight
+		snapshot->velocityY = SnapshotCodec::QuantizeVelocity(state.velocity[1]);
 
-		//Rotation pitch/yaw/roll
-
-		float pitch = projectile->GetTransform()->GetPitchYawRoll().x;
-		float yaw = projectile->GetTransform()->GetPitchYawRoll().y;
-		float roll = projectile->GetTransform()->GetPitchYawRoll().z;
-		float gravity = projectile->gravity;
+		//Age
+		snapshot->age = SnapshotCodec::QuantizeTime(state.age);
 
-		std::memcpy(bff + 24, &pitch, 4);
-		std::memcpy(bff + 28, &yaw, 4);
-		std::memcpy(bff + 32, &roll, 4);
-		std::memcpy(bff + 36, &gravity, 4);
+		//Everything else is fixed at spawn, the codec only sends it when the baseline doesn't match
+		snapshot->velocityX = SnapshotCodec::QuantizeVelocity(state.velocity[0]);
+		snapshot->velocityZ = SnapshotCodec::QuantizeVelocity(state.velocity[2]);
 
-		//Age
-		float lifespan = projectile->lifespan;
-		float age = projectile->age;
+		//Rotation pitch/yaw/roll
+		snapshot->rotation[0] = SnapshotCodec::QuantizeAngle(state.rotation[0]);
+		snapshot->rotation[1] = SnapshotCodec::QuantizeAngle(state.rotation[1]);
+		snapshot->rotation[2] = SnapshotCodec::QuantizeAngle(state.rotation[2]);
 
-		std::memcpy(bff + 40, &lifespan, 4);
-		std::memcpy(bff + 44, &age, 4);
+		snapshot->gravity = SnapshotCodec::QuantizeVelocity(state.gravity);
+		snapshot->lifespan = SnapshotCodec::QuantizeTime(state.lifespan);
 
 	}
 
-	static void ReadProjectileMovementData(Projectile* projectile, char* buffer)
+	//Takes 48 bytes
+	static void ReadProjectileMovementData(ProjectileSystem* projectiles, int index, PacketReader* reader)
 	{
-		float* bff = (float*)buffer;
-
-		float x, y, z, pitch, yaw, roll;
+		ProjectileState state;
 
-		x = *bff;
-		y = *(bff + 1);
-		z = *(bff + 2);
-		projectile->GetTransform()->SetPosition(x, y, z);
+		state.position[0] = reader->ReadFloat();
+		state.position[1] = reader->ReadFloat();
+		state.position[2] = reader->ReadFloat();
 
-		projectile->velocityX = *(bff + 3);
-		projectile->velocityY = *(bff + 4);
-		projectile->velocityZ = *(bff + 5);
+		state.velocity[0] = reader->ReadFloat();
+		state.velocity[1] = reader->ReadFloat();
+		state.velocity[2] = reader->ReadFloat();
 
-		pitch = *(bff + 6);
-		yaw = *(bff + 7);
-		roll = *(bff + 8);
-		projectile->GetTransform()->SetRotation(pitch, yaw, roll);
+		state.rotation[0] = reader->ReadFloat();
+		state.rotation[1] = reader->ReadFloat();
+		state.rotation[2] = reader->ReadFloat();
 
-		projectile->gravity = *(bff + 9);
-		projectile->lifespan = *(bff + 10);
-		projectile->age = *(bff + 11);
+		state.gravity = reader->ReadFloat();
+		state.lifespan = reader->ReadFloat();
+		state.age = reader->ReadFloat();
 
-		projectile->dead = false;
+		projectiles->Launch(index, state);
 
 	}
 
-private:
-
-	//Simulates a couple positions to interpolate collision checking
-	static void SimulatePositions(Projectile* projectile, float timeStep, float* x, float* y, float* z)
+	//Hit sphere of a player, centered below the camera
+	static VectorMath::float3 GetPlayerHitCenter(Player* player)
 	{
-		float x1, y1, z1, p, w, r;
-		float vX, vY, vZ;
-		x1 = projectile->GetTransform()->GetPosition().x;
-		y1 = projectile->GetTransform()->GetPosition().y;
-		z1 = projectile->GetTransform()->GetPosition().z;
-		vX = projectile->velocityX;
-		vY = projectile->velocityY;
-		vZ = projectile->velocityZ;
-		p = projectile->GetTransform()->GetPitchYawRoll().x;
-		w = projectile->GetTransform()->GetPitchYawRoll().y;
-		r = projectile->GetTransform()->GetPitchYawRoll().z;
-
-		vY += projectile->gravity * timeStep;
-		Transform tf = Transform();
-		tf.SetPosition(x1, y1, z1);
-		tf.SetRotation(p, w, r);
-		tf.MoveRelative(vX * timeStep, vY * timeStep, vZ * timeStep);
-
-		*x = tf.GetPosition().x;
-		*y = tf.GetPosition().y;
-		*z = tf.GetPosition().z;
-
+		return VectorMath::float3(player->positionX, player->positionY - 1, player->positionZ); //adj. camera height
 	}
 
-	static float GetDistanceBetweenPoints(float x1, float x2, float y1, float y2, float z1, float z2)
+	//Same for a camera position taken from PositionHistory
+	static VectorMath::float3 GetPlayerHitCenter(const float* position)
 	{
-		return sqrt(
-			pow(x1 - x2, 2) +
-			pow(y1 - y2, 2) +
-			pow(z1 - z2, 2));
+		return VectorMath::float3(position[0], position[1] - 1, position[2]);
 	}
 
-public:
-
-	//Checks for collision between a projectile and player. Also simulates sever positions between current pos and next frame pos
-	static bool CheckProjectileCollision(Player* player, Projectile* projectile, float deltaTime, int simulations = 3)
+	//Does a sphere moving from start to end touch a static sphere at center.
+	//radius is the sum of both radii
+	static bool SweptSphereHit(const VectorMath::float3& start, const VectorMath::float3& end, const VectorMath::float3& center, float radius)
 	{
-		//Projectile radius - .1? Diameter .2?
-		//Player Radius 1.0
-
-		float x1, x2, y1, y2, z1, z2;
-		x1 = player->positionX;
-		y1 = player->positionY - 1; //adj. camera height
-		z1 = player->positionZ;
-
-		x2 = projectile->GetTransform()->GetPosition().x;
-		y2 = projectile->GetTransform()->GetPosition().y;
-		z2 = projectile->GetTransform()->GetPosition().z;
-
-		float result = GetDistanceBetweenPoints(x1, x2, y1, y2, z1, z2);
-
-		//Don't bother interping if we collided this frame
-		if (result <= 1.1f)
-			return true;
-		else if (result > 10)
-			return false;
-
-		float timestep = deltaTime / (float)simulations; //I think we simulate 1 step past the next frame but i don't care
-		float x3, y3, z3;
-
-		for (int i = 1; i <= simulations; i++)
+		float dx = end.x - start.x;
+		float dy = end.y - start.y;
+		float dz = end.z - start.z;
+
+		float cx = center.x - start.x;
+		float cy = center.y - start.y;
+		float cz = center.z - start.z;
+
+		//Closest point on the segment to the center
+		float lengthSq = dx * dx + dy * dy + dz * dz;
+		float t = 0;
+		if (lengthSq > 0)
 		{
-			SimulatePositions(projectile, timestep * i, &x3, &y3, &z3);
-			float rs = GetDistanceBetweenPoints(x1, x3, y1, y3, z1, z3);
-			if (rs < result) result = rs;
+			t = (cx * dx + cy * dy + cz * dz) / lengthSq;
+			if (t < 0) t = 0;
+			else if (t > 1) t = 1;
 		}
 
-		if (result <= 1.1f) return true;
-		return false;
-
+		float ox = cx - dx * t;
+		float oy = cy - dy * t;
+		float oz = cz - dz * t;
+		return ox * ox + oy * oy + oz * oz <= radius * radius;
 	}
 
 };
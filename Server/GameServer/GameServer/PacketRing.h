@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "../../../Network.h"
+
+//Bounded single-producer/single-consumer ring of datagram slots.
+//The receive thread writes straight into free slots and publishes them,
+//the game loop reads them in place and releases them once handled.
+//Capacity must be a power of two.
+template<size_t Capacity>
+class PacketRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "PacketRing capacity must be a power of two");
+
+private:
+
+	Datagram slots[Capacity];
+
+	//Each index is written by one side only, keep them on separate cache lines
+	alignas(64) std::atomic<size_t> head{ 0 }; //Next slot the producer fills
+	alignas(64) std::atomic<size_t> tail{ 0 }; //Next slot the consumer reads
+
+	alignas(64) std::atomic<size_t> dropped{ 0 };
+
+public:
+
+	//Producer: contiguous run of free slots starting at the returned pointer.
+	//count is 0 when the ring is full.
+	Datagram* WriteSlots(int* count)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_acquire);
+
+		size_t free = Capacity - (h - t);
+		size_t untilWrap = Capacity - (h & (Capacity - 1));
+		*count = (int)(free < untilWrap ? free : untilWrap);
+		return &slots[h & (Capacity - 1)];
+	}
+
+	//Producer: makes the first n slots from WriteSlots visible to the consumer
+	void Publish(int n)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		head.store(h + n, std::memory_order_release);
+	}
+
+	//Consumer: contiguous run of filled slots starting at the returned pointer.
+	//count is 0 when the ring is empty.
+	Datagram* ReadSlots(int* count)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t h = head.load(std::memory_order_acquire);
+
+		size_t used = h - t;
+		size_t untilWrap = Capacity - (t & (Capacity - 1));
+		*count = (int)(used < untilWrap ? used : untilWrap);
+		return &slots[t & (Capacity - 1)];
+	}
+
+	//Consumer: hands the first n slots from ReadSlots back to the producer
+	void Release(int n)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		tail.store(t + n, std::memory_order_release);
+	}
+
+	void CountDropped(int n) { dropped.fetch_add(n, std::memory_order_relaxed); }
+	size_t GetDroppedCount() { return dropped.load(std::memory_order_relaxed); }
+
+};
@@ -1,7 +1,8 @@
 #include "Player.h"
-#include <DirectXMath.h>
 
-Player::Player(sockaddr_in sender, int id)
+#include <cmath>
+
+Player::Player(sockaddr_in sender, unsigned int id)
 {
 	client = sender;
 	ID = id;
@@ -21,6 +22,33 @@ void Player::SetVelocity(float x, float y, float z)
 	velocityZ = z;
 }
 
+void Player::ApplyInput(const PlayerInput& input)
+{
+	//Written so NaN fails too. A negative step would pay the budget back, a NaN one would poison it for good
+	if (!(input.dt >= 0 && input.dt <= MAX_INPUT_DT)) return;
+	if (!std::isfinite(input.pitch) || !std::isfinite(input.yaw) || !std::isfinite(input.roll)) return;
+
+	lastInputSequence = input.sequence;
+
+	pitch = input.pitch;
+	yaw = input.yaw;
+	roll = input.roll;
+
+	//Asking for more time than has passed, e.g. a sped up client.
+	//Skip the movement, its prediction gets corrected by the next world update
+	if (input.dt > inputTimeBudget) return;
+	inputTimeBudget -= input.dt;
+
+	MovementState state = { { positionX, positionY, positionZ }, { velocityX, velocityY, velocityZ } };
+	PlayerMovement::Simulate(&state, input);
+
+	SetPosition(state.position[0], state.position[1], state.position[2]);
+	SetVelocity(state.velocity[0], state.velocity[1], state.velocity[2]);
+}
+
 void Player::Update(float dt)
 {
+	//Movement happens as inputs arrive, just keep track of how much time they may use
+	inputTimeBudget += dt;
+	if (inputTimeBudget > MAX_INPUT_BACKLOG) inputTimeBudget = MAX_INPUT_BACKLOG;
 }
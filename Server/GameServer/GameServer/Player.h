@@ -1,21 +1,28 @@
 #pragma once
 
 #include "../../../Network.h"
+#include "../../../Snapshot.h"
+#include "../../../PlayerMovement.h"
+#include "../../../ReliableChannel.h"
+#include "TickProfiler.h"
+#include "SendRateController.h"
+
+//Most seconds of movement a client can bank up, so bursts of delayed inputs still get applied
+#define MAX_INPUT_BACKLOG 0.25f
 
 class Player
 {
-private:
-	//Constants
-	float moveSpeed = 15.0f;
-	float gravity = -19.6f;
-	float jumpForce = 8;
-	float mouseLookSpeed = 1.0f;
-
 public:
 
-	int ID;
+	unsigned int ID; //Slot map handle, see SlotMap
 	sockaddr_in client;
 
+	//Random number the client has to put in every message, so packets with a forged sender address are dropped
+	uint32_t token = 0;
+
+	//Server tick we last heard anything from this client, it's dropped after going quiet too long
+	uint32_t lastHeardTick = 0;
+
 	float positionX;
 	float positionY;
 	float positionZ;
@@ -28,13 +35,42 @@ public:
 	float yaw;
 	float roll;
 
-	Player(sockaddr_in sender, int id);
+	//Newest input applied, and how much movement time the client is still owed
+	uint32_t lastInputSequence = 0;
+	float inputTimeBudget = MAX_INPUT_BACKLOG;
+
+	//How many ticks behind the server this client draws other players, shots are checked that far back
+	float viewLagTicks = 0;
+
+	//Join accept and anything else that must arrive, acked through this client's inputs
+	ReliableChannel reliable;
 
-	int GetID() { return ID; }
+	//World updates sent to this client, and the newest one it acknowledged (-1 for none)
+	SnapshotHistory sentSnapshots;
+	int ackedSnapshot = -1;
+
+	//How often and how precisely this client is sent world updates, backed off when its link can't keep up
+	SendRateController sendRate;
+
+	//What this client sent us and we sent it since the last stats report
+	TrafficCounters traffic;
+
+	//Scratch space for building this client's filtered world update
+	WorldSnapshot visibleSnapshot;
+	std::vector<int> nearby;
+	std::vector<std::pair<float, int>> farthest; //Squared distance and slot, for trimming an update to fit
+
+	Player(sockaddr_in sender, unsigned int id);
+
+	unsigned int GetID() { return ID; }
 
 	void SetPosition(float x, float y, float z);
 	void SetVelocity(float x, float y, float z);
 
+	//Moves the player by one input command from its client.
+	//Ignored if its step is outside 0..MAX_INPUT_DT or its angles aren't finite
+	void ApplyInput(const PlayerInput& input);
+
 	void Update(float dt);
 
 };
@@ -0,0 +1,81 @@
+#include "PositionHistory.h"
+
+#include <cmath>
+
+void PositionHistory::Resize(int ticks, int players)
+{
+	if (ticks < 1) ticks = 1;
+	if (players < 0) players = 0;
+
+	tickCount = ticks;
+	playerCount = players;
+
+	size_t size = (size_t)ticks * players;
+	x.assign(size, 0);
+	y.assign(size, 0);
+	z.assign(size, 0);
+	present.assign(size, 0);
+	rowTick.assign(ticks, 0);
+
+	newestTick = 0;
+	storedTicks = 0;
+}
+
+void PositionHistory::BeginTick(uint32_t tick)
+{
+	int row = Row(tick);
+	rowTick[row] = tick;
+
+	uint8_t* p = &present[(size_t)row * playerCount];
+	for (int i = 0; i < playerCount; i++) p[i] = 0;
+
+	newestTick = tick;
+	if (storedTicks < tickCount) storedTicks++;
+}
+
+void PositionHistory::Record(int slot, float px, float py, float pz)
+{
+	size_t i = (size_t)Row(newestTick) * playerCount + slot;
+	x[i] = px;
+	y[i] = py;
+	z[i] = pz;
+	present[i] = 1;
+}
+
+void PositionHistory::ClearSlot(int slot)
+{
+	for (int row = 0; row < tickCount; row++)
+		present[(size_t)row * playerCount + slot] = 0;
+}
+
+bool PositionHistory::Sample(double tick, int slot, float* position)
+{
+	if (storedTicks == 0) return false;
+
+	double oldest = (double)(newestTick - (uint32_t)(storedTicks - 1));
+	if (tick > newestTick) tick = newestTick;
+	if (tick < oldest) tick = oldest;
+
+	uint32_t before = (uint32_t)std::floor(tick);
+	uint32_t after = before == newestTick ? before : before + 1;
+	float t = (float)(tick - before);
+
+	size_t a = (size_t)Row(before) * playerCount + slot;
+	size_t b = (size_t)Row(after) * playerCount + slot;
+
+	//Joined or left in between, use whichever end has them
+	if (!present[a] || !present[b])
+	{
+		size_t i = present[b] ? b : a;
+		if (!present[i]) return false;
+		position[0] = x[i];
+		position[1] = y[i];
+		position[2] = z[i];
+		return true;
+	}
+
+	position[0] = x[a] + (x[b] - x[a]) * t;
+	position[1] = y[a] + (y[b] - y[a]) * t;
+	position[2] = z[a] + (z[b] - z[a]) * t;
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//Recent player positions, one row per server tick, for rewinding hit checks to what a shooter saw.
+//Rows live in a fixed ring and each axis is its own array (row * playerCount + slot),
+//so recording a tick is one pass over contiguous floats and memory never grows.
+class PositionHistory
+{
+private:
+
+	int tickCount = 0;
+	int playerCount = 0;
+
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<uint8_t> present;
+	std::vector<uint32_t> rowTick; //Tick each row holds
+
+	uint32_t newestTick = 0;
+	int storedTicks = 0;
+
+	int Row(uint32_t tick) { return (int)(tick % (uint32_t)tickCount); }
+
+public:
+
+	//Only valid while nothing is recorded
+	void Resize(int ticks, int players);
+
+	//Starts the row for a tick, overwriting the oldest one. Every slot starts out absent
+	void BeginTick(uint32_t tick);
+	void Record(int slot, float px, float py, float pz);
+
+	//Forgets a slot's past, for when it's handed to a new player
+	void ClearSlot(int slot);
+
+	//Position at a possibly fractional tick, blending between recorded ticks.
+	//Clamped to the oldest and newest stored. Returns false if the slot was empty then
+	bool Sample(double tick, int slot, float* position);
+
+	uint32_t GetNewestTick() { return newestTick; }
+	int GetStoredTicks() { return storedTicks; }
+	int GetTickCapacity() { return tickCount; }
+
+};
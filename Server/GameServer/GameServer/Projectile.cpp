@@ -1,18 +0,0 @@
-#include "Projectile.h"
-
-#include <DirectXMath.h>
-
-using namespace DirectX;
-
-void Projectile::Update(float dt)
-{
-	age += dt;
-
-	if (age >= lifespan) dead = true;
-
-	velocityY += gravity * dt;
-	transform.MoveRelative(velocityX * dt, velocityY * dt, velocityZ * dt);
-
-	if (transform.GetPosition().y <= -6) dead = true;
-
-}
@@ -0,0 +1,131 @@
+#include "ProjectileCollider.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Helpers.h"
+
+//Cell coordinates packed into one sortable key, 21 bits per axis
+static uint64_t CellKey(int x, int y, int z)
+{
+	const int offset = 1 << 20;
+	return ((uint64_t)((x + offset) & 0x1FFFFF) << 42) | ((uint64_t)((y + offset) & 0x1FFFFF) << 21) | (uint64_t)((z + offset) & 0x1FFFFF);
+}
+
+void ProjectileCollider::Resize(int projectiles)
+{
+	count = projectiles;
+
+	startX.assign(count, 0); startY.assign(count, 0); startZ.assign(count, 0);
+	endX.assign(count, 0); endY.assign(count, 0); endZ.assign(count, 0);
+	margin.assign(count, 0);
+	rewindTick.assign(count, 0);
+	active.assign(count, 0);
+	hitSlot.assign(count, -1);
+	cellKeys.assign(count, 0);
+
+	order.reserve(count);
+	cellStarts.reserve(count + 1);
+}
+
+void ProjectileCollider::SetSweep(int index, float sx, float sy, float sz, float ex, float ey, float ez, float queryMargin, double tick)
+{
+	startX[index] = sx; startY[index] = sy; startZ[index] = sz;
+	endX[index] = ex; endY[index] = ey; endZ[index] = ez;
+	margin[index] = queryMargin;
+	rewindTick[index] = tick;
+	active[index] = 1;
+	hitSlot[index] = -1;
+}
+
+void ProjectileCollider::SetInactive(int index)
+{
+	active[index] = 0;
+	hitSlot[index] = -1;
+}
+
+void ProjectileCollider::Collide(ThreadPool* pool, SpatialHash& grid, PositionHistory& history)
+{
+	//Group live projectiles by the cell they start in. Sorting by index within a cell keeps the order fixed
+	order.clear();
+	for (int i = 0; i < count; i++)
+	{
+		if (!active[i]) continue;
+		cellKeys[i] = CellKey(grid.CellCoord(startX[i]), grid.CellCoord(startY[i]), grid.CellCoord(startZ[i]));
+		order.push_back(i);
+	}
+
+	std::sort(order.begin(), order.end(), [this](int a, int b)
+	{
+		if (cellKeys[a] != cellKeys[b]) return cellKeys[a] < cellKeys[b];
+		return a < b;
+	});
+
+	cellStarts.clear();
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (i == 0 || cellKeys[order[i]] != cellKeys[order[i - 1]])
+			cellStarts.push_back((int)i);
+	}
+	cellStarts.push_back((int)order.size());
+
+	pool->ParallelFor(GetCellCount(), [this, &grid, &history](int cell)
+	{
+		CollideCell(cell, grid, history);
+	});
+}
+
+void ProjectileCollider::CollideCell(int cell, SpatialHash& grid, PositionHistory& history)
+{
+	//Each thread keeps its own, so cells never share scratch space
+	static thread_local std::vector<int> candidates;
+
+	int first = cellStarts[cell];
+	int last = cellStarts[cell + 1];
+
+	//One query covering every sweep in the cell
+	float minX = INFINITY, minY = INFINITY, minZ = INFINITY;
+	float maxX = -INFINITY, maxY = -INFINITY, maxZ = -INFINITY;
+	for (int k = first; k < last; k++)
+	{
+		int j = order[k];
+		minX = fminf(minX, fminf(startX[j], endX[j]) - margin[j]);
+		minY = fminf(minY, fminf(startY[j], endY[j]) - margin[j]);
+		minZ = fminf(minZ, fminf(startZ[j], endZ[j]) - margin[j]);
+		maxX = fmaxf(maxX, fmaxf(startX[j], endX[j]) + margin[j]);
+		maxY = fmaxf(maxY, fmaxf(startY[j], endY[j]) + margin[j]);
+		maxZ = fmaxf(maxZ, fmaxf(startZ[j], endZ[j]) + margin[j]);
+	}
+
+	candidates.clear();
+	grid.Query(minX, minY, minZ, maxX, maxY, maxZ, candidates);
+	if (candidates.empty()) return;
+
+	for (int k = first; k < last; k++)
+	{
+		int j = order[k];
+		VectorMath::float3 start(startX[j], startY[j], startZ[j]);
+		VectorMath::float3 end(endX[j], endY[j], endZ[j]);
+
+		float bMinX = fminf(startX[j], endX[j]) - margin[j], bMaxX = fmaxf(startX[j], endX[j]) + margin[j];
+		float bMinY = fminf(startY[j], endY[j]) - margin[j], bMaxY = fmaxf(startY[j], endY[j]) + margin[j];
+		float bMinZ = fminf(startZ[j], endZ[j]) - margin[j], bMaxZ = fmaxf(startZ[j], endZ[j]) + margin[j];
+
+		//Lowest slot wins, same as checking players in order
+		int hit = -1;
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			int i = candidates[c];
+			if (hit != -1 && i > hit) continue;
+
+			//Only the players this projectile's own query would have found
+			if (!grid.InBox(i, bMinX, bMinY, bMinZ, bMaxX, bMaxY, bMaxZ)) continue;
+
+			float position[3];
+			if (!history.Sample(rewindTick[j], i, position)) continue; //Wasn't here yet
+			if (Helpers::SweptSphereHit(start, end, Helpers::GetPlayerHitCenter(position), PROJECTILE_HIT_RADIUS))
+				hit = i;
+		}
+		hitSlot[j] = hit;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PositionHistory.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+
+//Projectile against player hit checks for one tick, split into parallel jobs by world region.
+//Each projectile's sweep is kept in flat per-axis arrays. Live ones are grouped by the grid cell
+//their sweep starts in, and every cell is one job that looks up nearby players once for all of them.
+//A projectile's result only depends on its own sweep and the recorded player positions,
+//so the hits come out the same however the cells are spread over threads.
+class ProjectileCollider
+{
+private:
+
+	int count = 0;
+
+	//Sweep for this tick, indexed by projectile
+	std::vector<float> startX, startY, startZ;
+	std::vector<float> endX, endY, endZ;
+	std::vector<float> margin; //Extra query distance for how far rewound players may have moved
+	std::vector<double> rewindTick;
+	std::vector<uint8_t> active;
+
+	//Slot of the player hit, -1 for none
+	std::vector<int> hitSlot;
+
+	//Active projectiles sorted by cell, and where each cell's run starts (plus one past the end)
+	std::vector<uint64_t> cellKeys;
+	std::vector<int> order;
+	std::vector<int> cellStarts;
+
+	void CollideCell(int cell, SpatialHash& grid, PositionHistory& history);
+
+public:
+
+	//Only valid between ticks
+	void Resize(int projectiles);
+
+	//Called once per projectile per tick, from any thread, each index by one thread only
+	void SetSweep(int index, float sx, float sy, float sz, float ex, float ey, float ez, float queryMargin, double tick);
+	void SetInactive(int index);
+
+	//Finds this tick's hits. Cells run in parallel on pool
+	void Collide(ThreadPool* pool, SpatialHash& grid, PositionHistory& history);
+
+	int GetHit(int index) { return hitSlot[index]; }
+	int GetCellCount() { return (int)cellStarts.size() - 1; }
+
+};
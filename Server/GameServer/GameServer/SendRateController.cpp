@@ -0,0 +1,100 @@
+#include "SendRateController.h"
+
+#include "../../../Snapshot.h"
+
+//Fewest updates a control period needs acked before its loss means anything
+#define SEND_RATE_MIN_SAMPLE 4
+
+SendRateController::SendRateController()
+{
+	for (int i = 0; i < SEND_RATE_RTT_WINDOW; i++) periodMinRtt[i] = -1;
+}
+
+const SendRateController::SentUpdate* SendRateController::FindSent(uint16_t sequence)
+{
+	for (int i = 0; i < SEND_RATE_HISTORY; i++)
+	{
+		if (sent[i].count != 0 && sent[i].sequence == sequence) return &sent[i];
+	}
+	return nullptr;
+}
+
+float SendRateController::GetMinRtt()
+{
+	float lowest = -1;
+	for (int i = 0; i < SEND_RATE_RTT_WINDOW; i++)
+	{
+		if (periodMinRtt[i] >= 0 && (lowest < 0 || periodMinRtt[i] < lowest)) lowest = periodMinRtt[i];
+	}
+	return lowest;
+}
+
+void SendRateController::Reset(uint32_t tick)
+{
+	*this = SendRateController();
+	periodStartTick = tick;
+}
+
+void SendRateController::OnSent(uint16_t sequence, uint32_t tick)
+{
+	sentCount++;
+	sent[nextSent].sequence = sequence;
+	sent[nextSent].tick = tick;
+	sent[nextSent].count = sentCount;
+	nextSent = (nextSent + 1) % SEND_RATE_HISTORY;
+}
+
+void SendRateController::OnAck(uint16_t sequence, uint32_t receivedCount, uint32_t tick)
+{
+	if (newestAck >= 0 && !SnapshotCodec::SequenceNewer(sequence, (uint16_t)newestAck)) return;
+
+	const SentUpdate* update = FindSent(sequence);
+	if (update == nullptr) return; //Older than we remember
+	newestAck = sequence;
+
+	//Same smoothing as TCP's round trip estimate
+	float sample = (float)(tick - update->tick);
+	smoothedRtt = smoothedRtt < 0 ? sample : smoothedRtt * 0.875f + sample * 0.125f;
+	float& lowest = periodMinRtt[period % SEND_RATE_RTT_WINDOW];
+	if (lowest < 0 || sample < lowest) lowest = sample;
+
+	ackedSentCount = update->count;
+	ackedReceivedCount = receivedCount;
+}
+
+void SendRateController::Update(uint32_t tick, int tickRate)
+{
+	if (tick - periodStartTick < (uint32_t)tickRate) return;
+
+	//Of the updates sent up to the newest ack this period, how many the client says it got
+	uint32_t sentDelta = ackedSentCount - periodSentCount;
+	uint32_t receivedDelta = ackedReceivedCount - periodReceivedCount;
+	bool measured = sentDelta >= SEND_RATE_MIN_SAMPLE;
+	if (measured)
+	{
+		loss = 1 - (float)receivedDelta / (float)sentDelta;
+		if (loss < 0) loss = 0; //Counts race each other a little around the period edges
+	}
+
+	bool queueing = smoothedRtt >= 0 && smoothedRtt > GetMinRtt() + SEND_RATE_QUEUE_SECONDS * tickRate;
+	if ((measured && loss > SEND_RATE_LOSS_HIGH) || queueing)
+	{
+		if (level < SEND_RATE_MAX_INTERVAL - 1) level++;
+		cleanPeriods = 0;
+	}
+	else if (measured && loss < SEND_RATE_LOSS_LOW)
+	{
+		if (++cleanPeriods >= SEND_RATE_RECOVER_PERIODS && level > 0)
+		{
+			level--;
+			cleanPeriods = 0;
+		}
+	}
+
+	periodSentCount = ackedSentCount;
+	periodReceivedCount = ackedReceivedCount;
+	periodStartTick = tick;
+
+	period++;
+	periodMinRtt[period % SEND_RATE_RTT_WINDOW] = -1;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+//World updates remembered for matching acks to when they were sent
+#define SEND_RATE_HISTORY 64
+
+//Slowest a client is backed off to, one world update every this many ticks
+#define SEND_RATE_MAX_INTERVAL 4
+
+//Loss over a control period above this backs off, below the lower one counts as a clean period
+#define SEND_RATE_LOSS_HIGH 0.05f
+#define SEND_RATE_LOSS_LOW 0.01f
+
+//Round trip this far over the best seen means updates are queueing somewhere on the way
+#define SEND_RATE_QUEUE_SECONDS 0.1f
+
+//Control periods the best round trip is taken over, so a route that got slower becomes the new normal
+#define SEND_RATE_RTT_WINDOW 10
+
+//Clean control periods in a row before speeding back up
+#define SEND_RATE_RECOVER_PERIODS 3
+
+//Per client round trip and loss estimates from world update acks, and the send rate and position
+//precision that follow from them. Backs off a level at once when the link looks congested and only
+//recovers one level after several clean periods, so a struggling client settles instead of oscillating.
+//Level n sends every n + 1 ticks with n fewer fractional position bits.
+class SendRateController
+{
+private:
+
+	struct SentUpdate
+	{
+		uint16_t sequence;
+		uint32_t tick;
+		uint32_t count; //Updates sent to this client up to and including this one
+	};
+
+	SentUpdate sent[SEND_RATE_HISTORY] = {};
+	int nextSent = 0;
+	uint32_t sentCount = 0;
+
+	//Smoothed round trip in ticks, negative until the first ack.
+	//Lowest sample of each recent period, the smallest of those is the link's round trip with nothing queued
+	float smoothedRtt = -1;
+	float periodMinRtt[SEND_RATE_RTT_WINDOW];
+	int period = 0;
+
+	//Newest ack, and the counts at the start of the control period
+	int newestAck = -1;
+	uint32_t ackedSentCount = 0;
+	uint32_t ackedReceivedCount = 0;
+	uint32_t periodSentCount = 0;
+	uint32_t periodReceivedCount = 0;
+	uint32_t periodStartTick = 0;
+
+	float loss = 0;
+	int level = 0;
+	int cleanPeriods = 0;
+
+	const SentUpdate* FindSent(uint16_t sequence);
+	float GetMinRtt();
+
+public:
+
+	SendRateController();
+
+	//Forgets everything, for a new session in the slot
+	void Reset(uint32_t tick);
+
+	//Whether this client is due a world update this tick. slot spreads clients at the same rate over different ticks
+	bool IsDue(uint32_t tick, int slot) { return (tick + (uint32_t)slot) % (uint32_t)GetInterval() == 0; }
+
+	void OnSent(uint16_t sequence, uint32_t tick);
+
+	//The client's newest world update, and how many it has received in total
+	void OnAck(uint16_t sequence, uint32_t receivedCount, uint32_t tick);
+
+	//Called every tick, reassesses the level once per period
+	void Update(uint32_t tick, int tickRate);
+
+	int GetInterval() { return level + 1; }
+	int GetPositionBits(int serverBits) { return serverBits - level > 0 ? serverBits - level : 0; }
+	int GetLevel() { return level; }
+
+	float GetRttTicks() { return smoothedRtt; }
+	float GetLoss() { return loss; }
+
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define SLOT_MAP_INVALID_HANDLE 0xFFFFFFFFu
+
+//Fixed capacity table of pointers addressed by generational handles.
+//A handle is (generation << 16) | slot index, so lookups are a single array access
+//and handles to a slot that has since been reused are rejected.
+template<typename T>
+class SlotMap
+{
+private:
+
+	struct Slot
+	{
+		T* item;
+		uint16_t generation;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint16_t> freeSlots;
+	int count = 0;
+
+public:
+
+	SlotMap(int capacity = 0) { Resize(capacity); }
+
+	//Only valid while empty
+	void Resize(int capacity)
+	{
+		if (capacity < 0) capacity = 0;
+		if (capacity > 0xFFFF) capacity = 0xFFFF;
+
+		slots.assign(capacity, Slot{ nullptr, 1 });
+		freeSlots.clear();
+
+		//Hand out low indices first
+		for (int i = capacity - 1; i >= 0; i--)
+			freeSlots.push_back((uint16_t)i);
+		count = 0;
+	}
+
+	//Returns SLOT_MAP_INVALID_HANDLE when full
+	uint32_t Insert(T* item)
+	{
+		if (freeSlots.empty()) return SLOT_MAP_INVALID_HANDLE;
+
+		uint16_t index = freeSlots.back();
+		freeSlots.pop_back();
+
+		slots[index].item = item;
+		count++;
+		return ((uint32_t)slots[index].generation << 16) | index;
+	}
+
+	//Null if the handle is stale or out of range
+	T* Get(uint32_t handle)
+	{
+		uint32_t index = handle & 0xFFFF;
+		if (index >= slots.size()) return nullptr;
+
+		Slot& s = slots[index];
+		if (s.item == nullptr || s.generation != (handle >> 16)) return nullptr;
+		return s.item;
+	}
+
+	//Frees the slot and returns what was in it, or null for a stale handle
+	T* Remove(uint32_t handle)
+	{
+		T* item = Get(handle);
+		if (item == nullptr) return nullptr;
+
+		Slot& s = slots[handle & 0xFFFF];
+		s.item = nullptr;
+		s.generation++;
+		if (s.generation == 0) s.generation = 1; //Keep handles from ever matching SLOT_MAP_INVALID_HANDLE
+		freeSlots.push_back((uint16_t)(handle & 0xFFFF));
+		count--;
+		return item;
+	}
+
+	//Direct slot access for iteration, null for empty slots
+	T* At(int index) { return slots[index].item; }
+
+	int Capacity() { return (int)slots.size(); }
+	int Count() { return count; }
+
+	static int IndexOf(uint32_t handle) { return (int)(handle & 0xFFFF); }
+
+};
@@ -0,0 +1,115 @@
+#include "SpatialHash.h"
+
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize, int bucketCount)
+{
+	SpatialHash::cellSize = cellSize;
+	inverseCellSize = 1.0f / cellSize;
+
+	int size = 1;
+	while (size < bucketCount) size <<= 1;
+	buckets.assign(size, -1);
+}
+
+int SpatialHash::CellCoord(float v)
+{
+	return (int)std::floor(v * inverseCellSize);
+}
+
+int SpatialHash::Hash(int x, int y, int z)
+{
+	uint32_t h = (uint32_t)x * 73856093u ^ (uint32_t)y * 19349663u ^ (uint32_t)z * 83492791u;
+	return (int)(h & (uint32_t)(buckets.size() - 1));
+}
+
+void SpatialHash::Link(int id)
+{
+	Entry& e = entries[id];
+	e.bucket = Hash(e.cellX, e.cellY, e.cellZ);
+	e.prev = -1;
+	e.next = buckets[e.bucket];
+	if (e.next != -1) entries[e.next].prev = id;
+	buckets[e.bucket] = id;
+	e.inserted = true;
+}
+
+void SpatialHash::Unlink(int id)
+{
+	Entry& e = entries[id];
+	if (e.prev != -1) entries[e.prev].next = e.next;
+	else buckets[e.bucket] = e.next;
+	if (e.next != -1) entries[e.next].prev = e.prev;
+	e.inserted = false;
+}
+
+void SpatialHash::Update(int id, float x, float y, float z)
+{
+	if (id >= (int)entries.size())
+		entries.resize(id + 1, Entry{ false, 0, 0, 0, 0, -1, -1 });
+
+	int cx = CellCoord(x);
+	int cy = CellCoord(y);
+	int cz = CellCoord(z);
+
+	Entry& e = entries[id];
+	if (e.inserted)
+	{
+		//Still in the same cell, nothing to do
+		if (e.cellX == cx && e.cellY == cy && e.cellZ == cz) return;
+		Unlink(id);
+	}
+
+	e.cellX = cx;
+	e.cellY = cy;
+	e.cellZ = cz;
+	Link(id);
+}
+
+void SpatialHash::Remove(int id)
+{
+	if (id < 0 || id >= (int)entries.size() || !entries[id].inserted) return;
+	Unlink(id);
+}
+
+void SpatialHash::Clear()
+{
+	for (size_t i = 0; i < buckets.size(); i++)
+		buckets[i] = -1;
+	for (size_t i = 0; i < entries.size(); i++)
+		entries[i].inserted = false;
+}
+
+void SpatialHash::Query(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, std::vector<int>& results)
+{
+	int x0 = CellCoord(minX), x1 = CellCoord(maxX);
+	int y0 = CellCoord(minY), y1 = CellCoord(maxY);
+	int z0 = CellCoord(minZ), z1 = CellCoord(maxZ);
+
+	for (int x = x0; x <= x1; x++)
+	{
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int z = z0; z <= z1; z++)
+			{
+				//Other cells can share this bucket, only take the ones actually in this cell
+				for (int id = buckets[Hash(x, y, z)]; id != -1; id = entries[id].next)
+				{
+					Entry& e = entries[id];
+					if (e.cellX == x && e.cellY == y && e.cellZ == z)
+						results.push_back(id);
+				}
+			}
+		}
+	}
+}
+
+bool SpatialHash::InBox(int id, float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+{
+	if (id < 0 || id >= (int)entries.size() || !entries[id].inserted) return false;
+
+	Entry& e = entries[id];
+	return e.cellX >= CellCoord(minX) && e.cellX <= CellCoord(maxX)
+		&& e.cellY >= CellCoord(minY) && e.cellY <= CellCoord(maxY)
+		&& e.cellZ >= CellCoord(minZ) && e.cellZ <= CellCoord(maxZ);
+}
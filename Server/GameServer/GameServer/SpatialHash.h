@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//Uniform grid over world space, hashed into a fixed number of buckets.
+//Items are points identified by a small integer id. Moving an item only touches
+//the buckets when it crosses into a different cell, so keeping it in sync each
+//tick is cheap for things that mostly stay put.
+class SpatialHash
+{
+private:
+
+	struct Entry
+	{
+		bool inserted;
+		int cellX, cellY, cellZ;
+		int bucket;
+		int prev, next; //Neighbours in the bucket's list, -1 at either end
+	};
+
+	float cellSize;
+	float inverseCellSize;
+	std::vector<int> buckets; //Head entry of each bucket, -1 if empty
+	std::vector<Entry> entries;
+
+	int Hash(int x, int y, int z);
+	void Link(int id);
+	void Unlink(int id);
+
+public:
+
+	//bucketCount is rounded up to a power of two
+	SpatialHash(float cellSize, int bucketCount = 1024);
+
+	//Inserts the item, or moves it if it's already in
+	void Update(int id, float x, float y, float z);
+	void Remove(int id);
+	void Clear();
+
+	//Appends every item whose cell overlaps the box. Callers do their own exact test
+	void Query(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, std::vector<int>& results);
+
+	//Whether the item is in one of the cells Query would visit for this box
+	bool InBox(int id, float minX, float minY, float minZ, float maxX, float maxY, float maxZ);
+
+	//Grid cell a world coordinate falls in, along one axis
+	int CellCoord(float v);
+
+	float GetCellSize() { return cellSize; }
+
+};
@@ -0,0 +1,173 @@
+#include "ThreadPool.h"
+
+static uint64_t PackRange(uint32_t begin, uint32_t end)
+{
+	return ((uint64_t)end << 32) | begin;
+}
+
+ThreadPool::ThreadPool(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+		if (workerCount < 1) workerCount = 1;
+	}
+
+	ranges.reset(new ChunkRange[workerCount + 1]);
+
+	for (int i = 0; i < workerCount; i++)
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+bool ThreadPool::PopChunk(int index, int* chunk)
+{
+	std::atomic<uint64_t>& bounds = ranges[index].bounds;
+	uint64_t current = bounds.load(std::memory_order_acquire);
+
+	while (true)
+	{
+		uint32_t begin = (uint32_t)current, end = (uint32_t)(current >> 32);
+		if (begin >= end) return false;
+
+		if (bounds.compare_exchange_weak(current, PackRange(begin + 1, end), std::memory_order_acq_rel))
+		{
+			*chunk = (int)begin;
+			return true;
+		}
+	}
+}
+
+bool ThreadPool::StealChunk(int index, int* chunk)
+{
+	int participants = (int)workers.size() + 1;
+
+	for (int offset = 1; offset < participants; offset++)
+	{
+		std::atomic<uint64_t>& victim = ranges[(index + offset) % participants].bounds;
+		uint64_t current = victim.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			uint32_t begin = (uint32_t)current, end = (uint32_t)(current >> 32);
+			if (begin >= end) break;
+
+			//Take the back half, the victim keeps working from the front
+			uint32_t take = (end - begin + 1) / 2;
+			uint32_t split = end - take;
+			if (victim.compare_exchange_weak(current, PackRange(begin, split), std::memory_order_acq_rel))
+			{
+				//Our own run is empty, so nobody else is touching it
+				ranges[index].bounds.store(PackRange(split + 1, end), std::memory_order_release);
+				*chunk = (int)split;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void ThreadPool::RunJob(int index, const std::function<void(int, int)>& fn, int count, int grain)
+{
+	int chunk;
+	while (PopChunk(index, &chunk) || StealChunk(index, &chunk))
+	{
+		int begin = chunk * grain;
+		int end = begin + grain < count ? begin + grain : count;
+		fn(begin, end);
+	}
+}
+
+void ThreadPool::WorkerLoop(int index)
+{
+	uint64_t seen = 0;
+
+	while (true)
+	{
+		const std::function<void(int, int)>* current;
+		int count, grain;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+			busyWorkers++;
+
+			current = job;
+			count = jobCount;
+			grain = jobGrain;
+		}
+
+		//Null if we woke up after the caller already finished everything
+		if (current != nullptr) RunJob(index, *current, count, grain);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busyWorkers--;
+		}
+		done.notify_one();
+	}
+}
+
+void ThreadPool::ParallelForRange(int count, int grain, const std::function<void(int, int)>& fn)
+{
+	if (count <= 0) return;
+	if (grain < 1) grain = 1;
+
+	int chunks = (count + grain - 1) / grain;
+
+	//Not worth waking anyone for
+	if (chunks == 1 || workers.empty())
+	{
+		fn(0, count);
+		return;
+	}
+
+	int participants = (int)workers.size() + 1;
+	int caller = participants - 1;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		//Even contiguous runs to start with, stealing evens out the rest
+		for (int i = 0; i < participants; i++)
+		{
+			uint32_t begin = (uint32_t)((int64_t)chunks * i / participants);
+			uint32_t end = (uint32_t)((int64_t)chunks * (i + 1) / participants);
+			ranges[i].bounds.store(PackRange(begin, end), std::memory_order_relaxed);
+		}
+
+		job = &fn;
+		jobCount = count;
+		jobGrain = grain;
+		generation++;
+	}
+	wake.notify_all();
+
+	//Once this returns every chunk has been claimed, though workers may still be inside theirs
+	RunJob(caller, fn, count, grain);
+
+	//Wait for stragglers still inside fn before the job goes out of scope
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return busyWorkers == 0; });
+	job = nullptr;
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& fn)
+{
+	ParallelForRange(count, 1, [&fn](int begin, int end)
+	{
+		for (int i = begin; i < end; i++) fn(i);
+	});
+}
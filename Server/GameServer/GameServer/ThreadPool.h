@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads for splitting per-tick work.
+//A job is cut into chunks and every thread, the caller included, starts on its own
+//contiguous run of them. Whoever runs out steals half of what's left in someone else's run,
+//so uneven chunks still finish together without a shared counter everyone fights over.
+class ThreadPool
+{
+private:
+
+	//One thread's remaining chunks, begin in the low 32 bits and end in the high.
+	//Both halves change in a single compare-exchange, so the owner and thieves never hand out the same chunk.
+	//Padded out to a cache line so neighbouring threads don't slow each other down
+	struct ChunkRange
+	{
+		std::atomic<uint64_t> bounds{ 0 };
+		char padding[64 - sizeof(std::atomic<uint64_t>)];
+	};
+
+	std::vector<std::thread> workers;
+	std::unique_ptr<ChunkRange[]> ranges; //workers.size() + 1, the caller is last
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	//Current job, only changed while no workers are inside it
+	const std::function<void(int, int)>* job = nullptr;
+	int jobCount = 0;
+	int jobGrain = 1;
+	int busyWorkers = 0;
+	uint64_t generation = 0;
+	bool stopping = false;
+
+	void WorkerLoop(int index);
+	void RunJob(int index, const std::function<void(int, int)>& fn, int count, int grain);
+
+	bool PopChunk(int index, int* chunk);
+	bool StealChunk(int index, int* chunk);
+
+public:
+
+	//0 picks one less than the number of hardware threads
+	ThreadPool(int workerCount = 0);
+	~ThreadPool();
+
+	//Calls fn(begin, end) over [0, count) in chunks of about grain indices, and returns when they've all finished.
+	//Chunks are contiguous so jobs can walk flat arrays
+	void ParallelForRange(int count, int grain, const std::function<void(int, int)>& fn);
+
+	//Calls fn(i) for every i in [0, count) and returns when they've all finished
+	void ParallelFor(int count, const std::function<void(int)>& fn);
+
+	int GetWorkerCount() { return (int)workers.size(); }
+
+};
@@ -0,0 +1,122 @@
+#include "TickProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#define SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+
+static const char* phaseNames[] = { "receive", "simulate", "collide", "encode", "send", "tick" };
+
+LatencyHistogram::LatencyHistogram()
+{
+	//Values under SUB_BUCKETS get a bucket each, then SUB_BUCKETS per power of two above that
+	counts.assign(SUB_BUCKETS + (HISTOGRAM_MAX_MAGNITUDE - HISTOGRAM_SUB_BUCKET_BITS + 1) * SUB_BUCKETS, 0);
+}
+
+int LatencyHistogram::BucketOf(uint64_t value)
+{
+	if (value < SUB_BUCKETS) return (int)value;
+
+	int magnitude = HISTOGRAM_SUB_BUCKET_BITS;
+	while (magnitude < HISTOGRAM_MAX_MAGNITUDE && (value >> (magnitude + 1)) != 0) magnitude++;
+	if ((value >> (magnitude + 1)) != 0) value = (2ull << magnitude) - 1; //Past the top, clamp into the last bucket
+
+	//The bits right under the leading one pick the sub bucket
+	int sub = (int)(value >> (magnitude - HISTOGRAM_SUB_BUCKET_BITS)) - SUB_BUCKETS;
+	return SUB_BUCKETS + (magnitude - HISTOGRAM_SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::BucketHighest(int bucket)
+{
+	if (bucket < SUB_BUCKETS) return (uint64_t)bucket;
+
+	int magnitude = (bucket - SUB_BUCKETS) / SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS;
+	int sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+	return ((uint64_t)(SUB_BUCKETS + sub + 1) << (magnitude - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	counts[BucketOf(value)]++;
+	total++;
+	sum += value;
+	if (value > largest) largest = value;
+}
+
+void LatencyHistogram::Reset()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	total = 0;
+	sum = 0;
+	largest = 0;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double fraction)
+{
+	if (total == 0) return 0;
+
+	uint64_t target = (uint64_t)(fraction * total + 0.5);
+	if (target < 1) target = 1;
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		seen += counts[i];
+		if (seen >= target)
+		{
+			uint64_t highest = BucketHighest((int)i);
+			return highest < largest ? highest : largest;
+		}
+	}
+	return largest;
+}
+
+TickProfiler::clock::time_point TickProfiler::Record(TickPhase phase, clock::time_point start)
+{
+	clock::time_point now = clock::now();
+	uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
+	phases[(int)phase].Record(micros);
+
+	if (phase == TickPhase::Tick)
+	{
+		span.Record(micros);
+		if (budgetMicroseconds > 0 && micros > budgetMicroseconds)
+		{
+			overBudget++;
+			spanOverBudget++;
+		}
+	}
+
+	return now;
+}
+
+void TickProfiler::WriteReport(std::ostream& out)
+{
+	out << std::left << std::setw(10) << "phase" << std::right
+		<< std::setw(10) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90"
+		<< std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << "   (microseconds)\n";
+
+	for (int i = 0; i < (int)TickPhase::Count; i++)
+	{
+		LatencyHistogram& h = phases[i];
+		out << std::left << std::setw(10) << phaseNames[i] << std::right
+			<< std::setw(10) << h.GetCount() << std::setw(10) << (uint64_t)h.GetMean()
+			<< std::setw(10) << h.GetPercentile(0.5) << std::setw(10) << h.GetPercentile(0.9)
+			<< std::setw(10) << h.GetPercentile(0.99) << std::setw(10) << h.GetPercentile(0.999)
+			<< std::setw(10) << h.GetMax() << "\n";
+	}
+
+	out << "Budget " << budgetMicroseconds << "us, " << overBudget << " ticks over\n";
+}
+
+void TickProfiler::Reset()
+{
+	for (int i = 0; i < (int)TickPhase::Count; i++) phases[i].Reset();
+	overBudget = 0;
+}
+
+void TickProfiler::ResetSpan()
+{
+	span.Reset();
+	spanOverBudget = 0;
+}
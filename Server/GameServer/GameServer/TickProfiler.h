@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+//Precision of LatencyHistogram: every power of two is split into 2^bits buckets, about 3% apart
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+
+//Largest value a histogram tells apart, as a power of two. 2^40 microseconds is about 12 days
+#define HISTOGRAM_MAX_MAGNITUDE 40
+
+//Counts of microsecond values in log-linear buckets, like an HDR histogram.
+//Fixed size and O(1) to record into, with a few percent error on any percentile.
+class LatencyHistogram
+{
+private:
+
+	std::vector<uint32_t> counts;
+	uint64_t total = 0;
+	uint64_t sum = 0;
+	uint64_t largest = 0;
+
+	static int BucketOf(uint64_t value);
+	static uint64_t BucketHighest(int bucket);
+
+public:
+
+	LatencyHistogram();
+
+	void Record(uint64_t value);
+	void Reset();
+
+	//Smallest recorded value at least this fraction of the samples are at or under, to bucket precision
+	uint64_t GetPercentile(double fraction);
+
+	uint64_t GetCount() { return total; }
+	uint64_t GetMax() { return largest; }
+	double GetMean() { return total > 0 ? (double)sum / total : 0; }
+
+};
+
+//Steps of a server tick, each timed on its own
+enum class TickPhase
+{
+	Receive,  //Draining and handling client messages
+	Simulate, //Moving players and projectiles
+	Collide,  //Projectile hit checks and applying hits
+	Encode,   //Building and encoding every client's world update
+	Send,     //Handing world updates and reliable resends to the socket
+	Tick,     //Everything above, start to finish
+	Count
+};
+
+//Packets and bytes moved over one stats report period
+struct TrafficCounters
+{
+	uint64_t packetsIn = 0;
+	uint64_t bytesIn = 0;
+	uint64_t packetsOut = 0;
+	uint64_t bytesOut = 0;
+
+	void CountIn(int bytes) { packetsIn++; bytesIn += bytes; }
+	void CountOut(int bytes) { packetsOut++; bytesOut += bytes; }
+	void Reset() { *this = TrafficCounters(); }
+};
+
+//Per phase latency histograms for the server loop. Only used from the game loop thread.
+class TickProfiler
+{
+public:
+
+	using clock = std::chrono::steady_clock;
+
+private:
+
+	LatencyHistogram phases[(int)TickPhase::Count];
+	uint64_t budgetMicroseconds = 0;
+	uint64_t overBudget = 0;
+
+	//Whole ticks again, but only reset by ResetSpan, so a client can time a span of its own
+	//without stats reports cutting into it
+	LatencyHistogram span;
+	uint64_t spanOverBudget = 0;
+
+public:
+
+	static clock::time_point Now() { return clock::now(); }
+
+	//Ticks that take longer than this are counted as over budget
+	void SetBudget(uint64_t microseconds) { budgetMicroseconds = microseconds; }
+
+	//Records the time since start against a phase. Returns now, so phases can be chained
+	clock::time_point Record(TickPhase phase, clock::time_point start);
+
+	//Phase table for everything recorded since the last Reset
+	void WriteReport(std::ostream& out);
+	void Reset();
+
+	LatencyHistogram& GetHistogram(TickPhase phase) { return phases[(int)phase]; }
+	uint64_t GetOverBudgetCount() { return overBudget; }
+	uint64_t GetBudget() { return budgetMicroseconds; }
+
+	LatencyHistogram& GetSpan() { return span; }
+	uint64_t GetSpanOverBudgetCount() { return spanOverBudget; }
+	void ResetSpan();
+
+};
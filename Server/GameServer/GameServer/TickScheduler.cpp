@@ -0,0 +1,69 @@
+#include "TickScheduler.h"
+
+#include <thread>
+
+using namespace std::chrono;
+
+TickScheduler::TickScheduler(int tickRate, int maxCatchUpTicks)
+{
+	if (tickRate < 1) tickRate = 1;
+	if (maxCatchUpTicks < 1) maxCatchUpTicks = 1;
+
+	tickLength = duration_cast<clock::duration>(duration<double>(1.0 / tickRate));
+	TickScheduler::maxCatchUpTicks = maxCatchUpTicks;
+
+	//OS sleeps overshoot by up to a scheduler quantum, spin through the last bit
+	spinWindow = duration_cast<clock::duration>(microseconds(1500));
+
+	Reset();
+}
+
+void TickScheduler::Reset()
+{
+	nextTick = clock::now() + tickLength;
+}
+
+int TickScheduler::WaitForNextTick()
+{
+	clock::time_point now = clock::now();
+
+	if (now < nextTick)
+	{
+		if (nextTick - now > spinWindow)
+			std::this_thread::sleep_until(nextTick - spinWindow);
+
+		while (clock::now() < nextTick)
+			std::this_thread::yield();
+
+		now = clock::now();
+	}
+
+	//Every whole tick length we're past the deadline is another step we owe
+	int ticksDue = 1 + (int)((now - nextTick) / tickLength);
+	if (ticksDue > 1) overrunCount++;
+
+	if (ticksDue > maxCatchUpTicks)
+	{
+		//Too far behind to catch up, drop the rest and restart the schedule from now
+		skippedTicks += ticksDue - maxCatchUpTicks;
+		ticksDue = maxCatchUpTicks;
+		nextTick = now + tickLength;
+	}
+	else
+	{
+		nextTick += tickLength * ticksDue;
+	}
+
+	tickCount += ticksDue;
+	return ticksDue;
+}
+
+float TickScheduler::GetDeltaTime()
+{
+	return duration_cast<duration<float>>(tickLength).count();
+}
+
+int TickScheduler::GetTickRate()
+{
+	return (int)(seconds(1) / tickLength);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+//Fixed timestep scheduler for the server loop.
+//Sleeps until the next tick is due instead of polling the clock, and reports
+//how many fixed steps the caller owes when a tick ran long.
+class TickScheduler
+{
+private:
+
+	using clock = std::chrono::steady_clock;
+
+	clock::duration tickLength;
+	clock::duration spinWindow;
+	clock::time_point nextTick;
+
+	int maxCatchUpTicks;
+
+	uint64_t tickCount = 0;
+	uint64_t overrunCount = 0;
+	uint64_t skippedTicks = 0;
+
+public:
+
+	TickScheduler(int tickRate, int maxCatchUpTicks = 5);
+
+	//Blocks until the next tick is due. Returns how many fixed steps to simulate (at least 1)
+	int WaitForNextTick();
+
+	//Starts counting from now, e.g. after a long stall we don't want to catch up on
+	void Reset();
+
+	float GetDeltaTime();
+	int GetTickRate();
+
+	uint64_t GetTickCount() { return tickCount; }
+	uint64_t GetOverrunCount() { return overrunCount; } //Times a tick started late
+	uint64_t GetSkippedTicks() { return skippedTicks; } //Ticks dropped past maxCatchUpTicks
+
+};
@@ -0,0 +1,109 @@
+#include "TrafficLog.h"
+
+#include <cstring>
+
+static const char magic[4] = { 'G', 'S', 'T', 'L' };
+
+template<typename T>
+static void WriteValue(std::ofstream& file, T value)
+{
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool ReadValue(std::ifstream& file, T* value)
+{
+	return (bool)file.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+bool TrafficRecorder::Open(const std::string& path, int tickRate, int maxPlayers, uint32_t tokenSeed, const uint64_t challengeKey[2])
+{
+	file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+
+	file.write(magic, sizeof(magic));
+	WriteValue<uint32_t>(file, TRAFFIC_LOG_VERSION);
+	WriteValue<uint32_t>(file, (uint32_t)tickRate);
+	WriteValue<uint32_t>(file, (uint32_t)maxPlayers);
+	WriteValue<uint32_t>(file, tokenSeed);
+	WriteValue<uint64_t>(file, challengeKey[0]);
+	WriteValue<uint64_t>(file, challengeKey[1]);
+
+	flushInterval = tickRate;
+	started = std::chrono::steady_clock::now();
+	return (bool)file;
+}
+
+void TrafficRecorder::RecordDatagram(const Datagram* d)
+{
+	WriteValue<uint8_t>(file, TRAFFIC_LOG_DATAGRAM);
+	WriteValue<uint32_t>(file, d->address.sin_addr.s_addr);
+	WriteValue<uint16_t>(file, d->address.sin_port);
+	WriteValue<uint16_t>(file, (uint16_t)d->length);
+	file.write(d->data, d->length);
+}
+
+void TrafficRecorder::RecordTick(int steps)
+{
+	uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+
+	WriteValue<uint8_t>(file, TRAFFIC_LOG_TICK);
+	WriteValue<uint8_t>(file, (uint8_t)steps);
+	WriteValue<uint64_t>(file, micros);
+
+	if (++passesSinceFlush >= flushInterval)
+	{
+		file.flush();
+		passesSinceFlush = 0;
+	}
+}
+
+bool TrafficReplayer::Open(const std::string& path)
+{
+	file.open(path.c_str(), std::ios::binary);
+	if (!file) return false;
+
+	char header[4];
+	uint32_t version, rate, capacity, seed;
+	if (!file.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0) return false;
+	if (!ReadValue(file, &version) || version != TRAFFIC_LOG_VERSION) return false;
+	if (!ReadValue(file, &rate) || !ReadValue(file, &capacity) || rate == 0 || capacity == 0) return false;
+	if (!ReadValue(file, &seed)) return false;
+	if (!ReadValue(file, &challengeKey[0]) || !ReadValue(file, &challengeKey[1])) return false;
+
+	tickRate = (int)rate;
+	maxPlayers = (int)capacity;
+	tokenSeed = seed;
+	return true;
+}
+
+int TrafficReplayer::Next(Datagram* d, int* steps, uint64_t* micros)
+{
+	uint8_t type;
+	if (!ReadValue(file, &type)) return TRAFFIC_LOG_END;
+
+	if (type == TRAFFIC_LOG_DATAGRAM)
+	{
+		uint32_t address;
+		uint16_t port, length;
+		if (!ReadValue(file, &address) || !ReadValue(file, &port) || !ReadValue(file, &length)) return TRAFFIC_LOG_END;
+		if (length > MAX_DATAGRAM_SIZE || !file.read(d->data, length)) return TRAFFIC_LOG_END;
+
+		std::memset(&d->address, 0, sizeof(d->address));
+		d->address.sin_family = AF_INET;
+		d->address.sin_addr.s_addr = address;
+		d->address.sin_port = port;
+		d->length = length;
+		return TRAFFIC_LOG_DATAGRAM;
+	}
+
+	if (type == TRAFFIC_LOG_TICK)
+	{
+		uint8_t count;
+		if (!ReadValue(file, &count) || !ReadValue(file, micros)) return TRAFFIC_LOG_END;
+		*steps = count;
+		return TRAFFIC_LOG_TICK;
+	}
+
+	return TRAFFIC_LOG_END;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "../../../Network.h"
+
+//Record types in a traffic log
+#define TRAFFIC_LOG_END 0
+#define TRAFFIC_LOG_DATAGRAM 'D'
+#define TRAFFIC_LOG_TICK 'T'
+
+#define TRAFFIC_LOG_VERSION 4
+
+//Binary log of everything the game loop was handed, so a session can be run through the server again without clients.
+//Header: "GSTL", then uint32 version, tick rate, max players and session token seed, and the two uint64 halves of the
+//connect challenge key. After that a stream of records:
+//  'D' uint32 address, uint16 port (both as on the wire), uint16 length, then the datagram itself
+//  'T' uint8 steps simulated, uint64 microseconds since recording started
+//Every datagram belongs to the game loop pass ended by the next 'T', which is what makes a replay tick for tick identical.
+//Fields are written in host byte order, which is little endian everywhere the server runs.
+class TrafficRecorder
+{
+private:
+
+	std::ofstream file;
+	std::chrono::steady_clock::time_point started;
+
+	int flushInterval = 1;
+	int passesSinceFlush = 0;
+
+public:
+
+	bool Open(const std::string& path, int tickRate, int maxPlayers, uint32_t tokenSeed, const uint64_t challengeKey[2]);
+	bool IsOpen() { return file.is_open(); }
+
+	void RecordDatagram(const Datagram* d);
+
+	//Ends a game loop pass. Flushes to disk about once a second, so a crash loses little
+	void RecordTick(int steps);
+
+};
+
+//Reads a log written by TrafficRecorder back one record at a time
+class TrafficReplayer
+{
+private:
+
+	std::ifstream file;
+	int tickRate = 0;
+	int maxPlayers = 0;
+	uint32_t tokenSeed = 0;
+	uint64_t challengeKey[2] = {};
+
+public:
+
+	bool Open(const std::string& path);
+
+	//Reads the next record. A datagram is filled into d, a tick sets steps and micros.
+	//Returns its type, or TRAFFIC_LOG_END at the end of the log or anything that doesn't parse
+	int Next(Datagram* d, int* steps, uint64_t* micros);
+
+	//The session's settings, which a replay has to match to assign the same player slots and tokens,
+	//and to accept the same connect cookies
+	int GetTickRate() { return tickRate; }
+	int GetMaxPlayers() { return maxPlayers; }
+	uint32_t GetTokenSeed() { return tokenSeed; }
+	uint64_t GetChallengeKey(int i) { return challengeKey[i]; }
+
+};
@@ -0,0 +1,678 @@
+// LoadTester.cpp : Drives a GameServer with simulated clients over the real protocol.
+//
+// Every client follows a scripted path and fires on a seeded schedule, so two runs
+// with the same arguments send the same traffic. Reports the gaps between snapshot
+// arrivals, packet and byte rates, and lost world updates, then the server's own
+// tick times over the run.
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include "../GameServer/TickScheduler.h"
+#include "../../../PlayerMovement.h"
+#include "../../../Snapshot.h"
+#include "../../../ReliableChannel.h"
+#include "../../../Network.h"
+#include "../../../Packet.h"
+
+using namespace std::chrono;
+
+#define DEFAULT_CLIENTS 4
+#define DEFAULT_SEND_RATE 60
+#define DEFAULT_DURATION 30
+#define DEFAULT_FIRE_RATE 1.0f
+#define DEFAULT_SEED 1
+
+//How long to wait for the server to accept each client
+#define CONNECT_TIMEOUT_MS 2000
+
+//Connect requests are resent this often until the accept arrives, same as the game
+#define CONNECT_RETRY_MS 500
+
+//How long to wait for the server's tick times, asked again this often until they arrive
+#define TICK_STATS_TIMEOUT_MS 2000
+#define TICK_STATS_RETRY_MS 200
+
+//Disconnect can't wait for an ack, so it goes out this many times
+#define DISCONNECT_REPEAT 3
+
+//Distance between neighbouring clients' spawn points
+#define PATH_SPACING 20.0f
+
+//Chance of jumping on any one input
+#define JUMP_CHANCE 0.01f
+
+//Inputs kept for replay while waiting on the server, same as the game
+#define MAX_PENDING_INPUTS 256
+
+//Same launch values the game uses for a new bullet
+#define PROJECTILE_SPEED 35.0f
+#define PROJECTILE_LIFT 2.0f
+#define PROJECTILE_GRAVITY -4.9f
+#define PROJECTILE_LIFESPAN 5.0f
+
+//Small deterministic generator so runs repeat exactly for a given seed
+struct Random
+{
+    uint32_t state;
+
+    float Next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0f;
+    }
+};
+
+struct SimClient
+{
+    UDPSocket socket;
+    bool connected = false;
+    ReliableChannel reliable;
+    uint32_t connectCookie[2] = {}; //From the server's challenge, echoed in connect requests
+
+    unsigned int playerID = 0;
+    int projectilesPerPlayer = 0;
+    int nextProjectile = 0;
+
+    //Scripted input, walking forward while turning at a steady rate traces a circle
+    float angularSpeed, phase, yaw;
+
+    //Predicted with the same movement code as the game, and corrected by the server
+    MovementState movement;
+    uint32_t inputSequence = 0;
+    std::deque<PlayerInput> pendingInputs;
+
+    Random random;
+    float nextShot;
+
+    WorldSnapshot snapshot;
+    SnapshotHistory receivedSnapshots;
+    int ackedSnapshot = -1;
+    uint32_t snapshotsReceived = 0; //Reported back so the server can work out our loss
+
+    //Separate from random so -droprate doesn't change what the client sends
+    Random linkLoss;
+
+    bool receivedAny = false;
+    steady_clock::time_point lastArrival;
+};
+
+struct Stats
+{
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t packetsReceived = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t snapshotsReceived = 0;
+    uint64_t snapshotsLost = 0; //Sequence gaps
+    uint64_t snapshotsDropped = 0; //Thrown away by -droprate
+    uint64_t snapshotsLate = 0; //Arrived after a newer one
+    uint64_t decodeFailures = 0;
+
+    std::vector<float> arrivalIntervals; //ms between world updates at one client
+
+    void Reset() { *this = Stats(); }
+};
+
+//The server's tick times from a msgType 6 answer, all in microseconds
+struct ServerTickStats
+{
+    uint32_t budget;
+    uint32_t count;
+    uint32_t mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t max;
+    uint32_t overBudget;
+};
+
+std::string serverIP = "127.0.0.1";
+unsigned short serverPort = 8888;
+char sendbuffer[MAX_DATAGRAM_SIZE];
+char reliableBuffer[RELIABLE_HEADER_SIZE + RELIABLE_MAX_PAYLOAD];
+char deliverBuffer[RELIABLE_MAX_PAYLOAD];
+Datagram received[MAX_DATAGRAM_BATCH];
+Stats stats;
+float dropRate = 0; //Fraction of world updates thrown away on arrival, to look like a lossy link
+steady_clock::time_point startTime = steady_clock::now();
+
+//Seconds since startup, the reliable channels' clock
+double Now()
+{
+    return duration<double>(steady_clock::now() - startTime).count();
+}
+
+//Sends the first length bytes of sendbuffer
+void Send(SimClient* c, int length)
+{
+    c->socket.SendTo(serverIP, serverPort, sendbuffer, length);
+    stats.packetsSent++;
+    stats.bytesSent += length;
+}
+
+//Sends everything the client's reliable channel has due
+void FlushReliable(SimClient* c, double now)
+{
+    int length;
+    while ((length = c->reliable.WriteDue(now, c->playerID, reliableBuffer, sizeof(reliableBuffer))) > 0)
+    {
+        c->socket.SendTo(serverIP, serverPort, reliableBuffer, length);
+        stats.packetsSent++;
+        stats.bytesSent += length;
+    }
+}
+
+//Same 36 byte layout as NetworkManager::CopyPlayerMovementData
+void CopyMovementData(SimClient* c, PacketWriter* writer)
+{
+    writer->WriteBytes(c->movement.position, 12);
+    writer->WriteBytes(c->movement.velocity, 12);
+    writer->WriteFloat(0); //Pitch
+    writer->WriteFloat(c->yaw);
+    writer->WriteFloat(0); //Roll
+}
+
+//Makes the client's input for time t, and predicts it like the game would
+void NextInput(SimClient* c, float t, float dt)
+{
+    c->yaw = c->phase + c->angularSpeed * t;
+
+    PlayerInput input = {};
+    input.sequence = ++c->inputSequence;
+    input.buttons = INPUT_FORWARD;
+    if (c->random.Next() < JUMP_CHANCE) input.buttons |= INPUT_JUMP;
+    input.yaw = c->yaw;
+    input.dt = dt;
+
+    PlayerMovement::Simulate(&c->movement, input);
+    c->pendingInputs.push_back(input);
+    if (c->pendingInputs.size() > MAX_PENDING_INPUTS) c->pendingInputs.pop_front();
+}
+
+void SetupClient(SimClient* c, int index, int clientCount, uint32_t seed)
+{
+    int side = (int)ceilf(sqrtf((float)clientCount));
+    c->movement.position[0] = ((index % side) - side / 2) * PATH_SPACING;
+    c->movement.position[1] = 0;
+    c->movement.position[2] = ((index / side) - side / 2) * PATH_SPACING;
+    c->movement.velocity[0] = c->movement.velocity[1] = c->movement.velocity[2] = 0;
+
+    c->random.state = seed * 2654435761u + index;
+    c->angularSpeed = 0.5f + c->random.Next();
+    c->phase = c->random.Next() * 6.2831853f;
+    c->nextShot = c->random.Next();
+    c->yaw = c->phase;
+    c->linkLoss.state = seed * 40503u + index * 2246822519u + 1;
+}
+
+//Takes a msgType 20 datagram and handles whatever it puts in order
+void ReceiveReliable(SimClient* c, Datagram* d)
+{
+    if (!c->reliable.Receive(d->data, d->length)) return;
+
+    int length;
+    while ((length = c->reliable.Deliver(deliverBuffer, sizeof(deliverBuffer))) > 0)
+    {
+        PacketReader reader(deliverBuffer, length);
+        if (reader.ReadUInt32() != 1) continue;
+
+        //Connection accepted: id, capacity, slot, projectiles per player
+        unsigned int id = reader.ReadUInt32();
+        reader.ReadUInt32();
+        reader.ReadUInt32();
+        int projectilesPerPlayer = reader.ReadInt32();
+        if (reader.Overflowed()) continue;
+
+        c->playerID = id;
+        c->projectilesPerPlayer = projectilesPerPlayer;
+        c->connected = true;
+    }
+}
+
+//Sends the connection request until the server accepts, answering its challenge. Returns false if it never did
+bool Connect(SimClient* c)
+{
+    c->reliable.Reset();
+    c->connectCookie[0] = c->connectCookie[1] = 0;
+
+    steady_clock::time_point giveUp = steady_clock::now() + milliseconds(CONNECT_TIMEOUT_MS);
+    steady_clock::time_point nextRequest = steady_clock::now();
+    while (steady_clock::now() < giveUp)
+    {
+        if (steady_clock::now() >= nextRequest)
+        {
+            PacketWriter writer(sendbuffer, sizeof(sendbuffer));
+            writer.WriteUInt32(1);
+            writer.WriteUInt32(c->connectCookie[0]);
+            writer.WriteUInt32(c->connectCookie[1]);
+            CopyMovementData(c, &writer);
+            Send(c, writer.GetLength());
+            nextRequest = steady_clock::now() + milliseconds(CONNECT_RETRY_MS);
+        }
+
+        if (!c->socket.WaitReadable(50)) continue;
+
+        int count = c->socket.RecvBatch(received, MAX_DATAGRAM_BATCH);
+        for (int i = 0; i < count; i++)
+        {
+            if (received[i].length < 4) continue;
+            unsigned int msgType = *(unsigned int*)received[i].data;
+            if (msgType == 20) ReceiveReliable(c, &received[i]);
+
+            //Challenge, ask again right away with the cookie
+            if (msgType == 5 && received[i].length >= 12)
+            {
+                std::memcpy(c->connectCookie, received[i].data + 4, 8);
+                nextRequest = steady_clock::now();
+            }
+        }
+        if (c->connected) return true;
+    }
+    return false;
+}
+
+//Asks the server for its tick times since the last reset, and with reset starts it timing a new span.
+//Asks again until it answers. Returns false if it never did
+bool RequestTickStats(SimClient* c, bool reset, ServerTickStats* result)
+{
+    steady_clock::time_point giveUp = steady_clock::now() + milliseconds(TICK_STATS_TIMEOUT_MS);
+    steady_clock::time_point nextRequest = steady_clock::now();
+    while (steady_clock::now() < giveUp)
+    {
+        if (steady_clock::now() >= nextRequest)
+        {
+            PacketWriter writer(sendbuffer, sizeof(sendbuffer));
+            writer.WriteUInt32(6);
+            writer.WriteUInt32(c->playerID);
+            writer.WriteUInt32(reset ? 1 : 0);
+            Send(c, writer.GetLength());
+            nextRequest = steady_clock::now() + milliseconds(TICK_STATS_RETRY_MS);
+        }
+
+        if (!c->socket.WaitReadable(50)) continue;
+
+        //World updates meanwhile are let go, the run isn't being measured
+        int count = c->socket.RecvBatch(received, MAX_DATAGRAM_BATCH);
+        for (int i = 0; i < count; i++)
+        {
+            PacketReader reader(received[i].data, received[i].length);
+            if (reader.ReadUInt32() != 6) continue;
+            if (reader.ReadUInt32() != (reset ? 1u : 0u)) continue; //Answer to an earlier request
+
+            result->budget = reader.ReadUInt32();
+            result->count = reader.ReadUInt32();
+            result->mean = reader.ReadUInt32();
+            result->p50 = reader.ReadUInt32();
+            result->p90 = reader.ReadUInt32();
+            result->p99 = reader.ReadUInt32();
+            result->p999 = reader.ReadUInt32();
+            result->max = reader.ReadUInt32();
+            result->overBudget = reader.ReadUInt32();
+            if (!reader.Overflowed()) return true;
+        }
+    }
+    return false;
+}
+
+void Disconnect(SimClient* c)
+{
+    char message[8];
+    PacketWriter writer(message, sizeof(message));
+    writer.WriteUInt32(4);
+    writer.WriteUInt32(c->playerID);
+    c->reliable.Send(message, writer.GetLength());
+
+    //Everything still unacknowledged goes out again each round
+    double now = Now();
+    for (int i = 0; i < DISCONNECT_REPEAT; i++)
+        FlushReliable(c, now + i * RELIABLE_RESEND_INTERVAL);
+    c->connected = false;
+}
+
+void SendUpdate(SimClient* c)
+{
+    //The newest inputs the server hasn't confirmed, capped the same as NetworkManager::Update
+    int count = (int)c->pendingInputs.size();
+    if (count > MAX_INPUTS_PER_PACKET) count = MAX_INPUTS_PER_PACKET;
+
+    //No interpolation here, the newest update is what we "see"
+    unsigned int viewTick = c->ackedSnapshot >= 0 ? (unsigned int)c->ackedSnapshot : 0xFFFFFFFFu;
+
+    uint16_t reliableAck;
+    unsigned int reliableAckBits;
+    c->reliable.GetAck(&reliableAck, &reliableAckBits);
+
+    PacketWriter writer(sendbuffer, sizeof(sendbuffer));
+    writer.WriteUInt32(10);
+    writer.WriteUInt32(c->playerID);
+    writer.WriteInt32(c->ackedSnapshot);
+    writer.WriteInt32(count);
+    writer.WriteUInt32(viewTick);
+    writer.WriteFloat(0); //View fraction
+    writer.WriteUInt32(reliableAck);
+    writer.WriteUInt32(reliableAckBits);
+    writer.WriteUInt32(c->snapshotsReceived);
+
+    size_t first = c->pendingInputs.size() - count;
+    for (int i = 0; i < count; i++)
+        PlayerMovement::WriteInput(c->pendingInputs[first + i], writer.Reserve(PLAYER_INPUT_SIZE));
+    Send(c, writer.GetLength());
+
+    //Anything reliable that's new or gone unacknowledged too long
+    FlushReliable(c, Now());
+}
+
+void Fire(SimClient* c)
+{
+    if (c->projectilesPerPlayer < 1) return;
+
+    int index = c->nextProjectile;
+    c->nextProjectile = (c->nextProjectile + 1) % c->projectilesPerPlayer;
+
+    char message[RELIABLE_MAX_PAYLOAD];
+    PacketWriter writer(message, sizeof(message));
+    writer.WriteUInt32(3);
+    writer.WriteUInt32(c->playerID);
+    writer.WriteInt32(index);
+
+    //Same 48 byte layout as NetworkManager::CopyProjectileMovementData
+    writer.WriteBytes(c->movement.position, 12);
+    writer.WriteFloat(0); //Velocity
+    writer.WriteFloat(PROJECTILE_LIFT);
+    writer.WriteFloat(PROJECTILE_SPEED);
+    writer.WriteFloat(0); //Pitch
+    writer.WriteFloat(c->yaw);
+    writer.WriteFloat(0); //Roll
+    writer.WriteFloat(PROJECTILE_GRAVITY);
+    writer.WriteFloat(PROJECTILE_LIFESPAN);
+    writer.WriteFloat(0); //Age
+
+    //Reliable, same as the game, so a lost spawn doesn't leave the projectile missing
+    c->reliable.Send(message, writer.GetLength());
+    FlushReliable(c, Now());
+}
+
+//Takes everything waiting on the client's socket
+void Receive(SimClient* c)
+{
+    while (c->socket.WaitReadable(0))
+    {
+        int count = c->socket.RecvBatch(received, MAX_DATAGRAM_BATCH);
+        steady_clock::time_point now = steady_clock::now();
+
+        for (int i = 0; i < count; i++)
+        {
+            Datagram* d = &received[i];
+            stats.packetsReceived++;
+            stats.bytesReceived += d->length;
+
+            if (d->length < 4) continue;
+            if (*(unsigned int*)d->data == 20)
+            {
+                ReceiveReliable(c, d);
+                continue;
+            }
+            if (*(unsigned int*)d->data != 10) continue;
+            if (dropRate > 0 && c->linkLoss.Next() < dropRate)
+            {
+                stats.snapshotsDropped++;
+                continue;
+            }
+
+            if (!SnapshotCodec::Read(&c->snapshot, &c->receivedSnapshots, d->data, d->length))
+            {
+                stats.decodeFailures++;
+                continue;
+            }
+            c->receivedSnapshots.Store(c->snapshot);
+            c->snapshotsReceived++;
+            stats.snapshotsReceived++;
+            c->reliable.ProcessAck(c->snapshot.reliableAck, c->snapshot.reliableAckBits);
+
+            if (c->receivedAny)
+                stats.arrivalIntervals.push_back(duration<float, std::milli>(now - c->lastArrival).count());
+            c->receivedAny = true;
+            c->lastArrival = now;
+
+            if (c->ackedSnapshot >= 0)
+            {
+                if (!SnapshotCodec::SequenceNewer(c->snapshot.sequence, (uint16_t)c->ackedSnapshot))
+                {
+                    stats.snapshotsLate++;
+                    continue;
+                }
+                //A backed off server only sends every interval ticks, so only bigger gaps are losses
+                int gap = (uint16_t)(c->snapshot.sequence - c->ackedSnapshot);
+                if (gap > c->snapshot.interval) stats.snapshotsLost += gap / c->snapshot.interval - 1;
+            }
+            c->ackedSnapshot = c->snapshot.sequence;
+
+            //Rewind to the server's answer and replay what it hasn't seen, like NetworkManager::Reconcile
+            if (c->snapshot.hasOwnerState)
+            {
+                while (!c->pendingInputs.empty() && c->pendingInputs.front().sequence <= c->snapshot.ownerInputSequence)
+                    c->pendingInputs.pop_front();
+
+                for (int a = 0; a < 3; a++)
+                {
+                    c->movement.position[a] = c->snapshot.ownerPosition[a];
+                    c->movement.velocity[a] = c->snapshot.ownerVelocity[a];
+                }
+                for (size_t j = 0; j < c->pendingInputs.size(); j++)
+                    PlayerMovement::Simulate(&c->movement, c->pendingInputs[j]);
+            }
+        }
+    }
+}
+
+float Percentile(std::vector<float>& sorted, float p)
+{
+    if (sorted.empty()) return 0;
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5f);
+    return sorted[i];
+}
+
+void Report(float seconds)
+{
+    std::vector<float>& t = stats.arrivalIntervals;
+    std::sort(t.begin(), t.end());
+
+    std::cout << "Over " << seconds << "s:" << std::endl;
+    std::cout << "  Snapshot arrival gaps ms  p50 " << Percentile(t, 0.5f) << "  p90 " << Percentile(t, 0.9f)
+        << "  p99 " << Percentile(t, 0.99f) << "  max " << (t.empty() ? 0 : t.back()) << std::endl;
+    std::cout << "  Sent      " << stats.packetsSent / seconds << " packets/s  " << stats.bytesSent / seconds << " bytes/s" << std::endl;
+    std::cout << "  Received  " << stats.packetsReceived / seconds << " packets/s  " << stats.bytesReceived / seconds << " bytes/s" << std::endl;
+    std::cout << "  Snapshots " << stats.snapshotsReceived << " received, " << stats.snapshotsLost << " lost, "
+        << stats.snapshotsLate << " late, " << stats.decodeFailures << " undecodable, " << stats.snapshotsDropped << " dropped" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int clientCount = DEFAULT_CLIENTS;
+    int sendRate = DEFAULT_SEND_RATE;
+    int durationSeconds = DEFAULT_DURATION;
+    int reportSeconds = 5;
+    float fireRate = DEFAULT_FIRE_RATE;
+    uint32_t seed = DEFAULT_SEED;
+
+    //LoadTester [-ip A] [-port N] [-clients N] [-rate N] [-duration S] [-report S] [-firerate N] [-droprate F] [-seed N]
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "-ip") serverIP = argv[i + 1];
+        else if (arg == "-port") serverPort = (unsigned short)atoi(argv[i + 1]);
+        else if (arg == "-clients") clientCount = atoi(argv[i + 1]);
+        else if (arg == "-rate") sendRate = atoi(argv[i + 1]);
+        else if (arg == "-duration") durationSeconds = atoi(argv[i + 1]);
+        else if (arg == "-report") reportSeconds = atoi(argv[i + 1]);
+        else if (arg == "-firerate") fireRate = (float)atof(argv[i + 1]);
+        else if (arg == "-droprate") dropRate = (float)atof(argv[i + 1]);
+        else if (arg == "-seed") seed = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+    }
+    if (clientCount < 1) clientCount = 1;
+    if (sendRate < 1) sendRate = 1;
+    if (durationSeconds < 1) durationSeconds = 1;
+    if (reportSeconds < 1) reportSeconds = 1;
+    if (reportSeconds > durationSeconds) reportSeconds = durationSeconds;
+
+    WSASession Session;
+
+    std::vector<SimClient*> clients;
+    for (int i = 0; i < clientCount; i++)
+    {
+        SimClient* c = new SimClient();
+        SetupClient(c, i, clientCount, seed);
+        clients.push_back(c);
+    }
+
+    int connected = 0;
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        try
+        {
+            if (Connect(clients[i])) connected++;
+            else std::cout << "Client " << i << " was not accepted" << std::endl;
+        }
+        catch (std::exception& ex)
+        {
+            std::cout << ex.what() << std::endl;
+        }
+    }
+    std::cout << connected << " of " << clientCount << " clients connected to " << serverIP << ":" << serverPort << std::endl;
+    if (connected == 0) return 1;
+
+    //The server times its ticks from here, so connecting isn't counted
+    SimClient* timed = nullptr;
+    for (size_t i = 0; i < clients.size() && timed == nullptr; i++)
+    {
+        if (clients[i]->connected) timed = clients[i];
+    }
+    ServerTickStats tickStats;
+    bool timing = false;
+    try
+    {
+        timing = RequestTickStats(timed, true, &tickStats);
+    }
+    catch (std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+    if (!timing) std::cout << "Server didn't answer for its tick times, they won't be reported" << std::endl;
+
+    stats.Reset();
+    Stats total;
+
+    TickScheduler scheduler(sendRate);
+    float dt = scheduler.GetDeltaTime();
+    int tick = 0;
+    int totalTicks = durationSeconds * sendRate;
+    int reportTicks = reportSeconds * sendRate;
+
+    while (tick < totalTicks)
+    {
+        int steps = scheduler.WaitForNextTick();
+        for (int s = 0; s < steps && tick < totalTicks; s++)
+        {
+            tick++;
+            float t = tick * dt;
+
+            for (size_t i = 0; i < clients.size(); i++)
+            {
+                SimClient* c = clients[i];
+                if (!c->connected) continue;
+
+                try
+                {
+                    Receive(c);
+                    NextInput(c, t, dt);
+                    SendUpdate(c);
+
+                    if (fireRate > 0 && t >= c->nextShot)
+                    {
+                        Fire(c);
+                        c->nextShot = t + (0.5f + c->random.Next()) / fireRate;
+                    }
+                }
+                catch (std::exception& ex)
+                {
+                    std::cout << ex.what() << std::endl;
+                }
+            }
+
+            if (tick % reportTicks == 0)
+            {
+                Report((float)reportSeconds);
+
+                total.packetsSent += stats.packetsSent;
+                total.bytesSent += stats.bytesSent;
+                total.packetsReceived += stats.packetsReceived;
+                total.bytesReceived += stats.bytesReceived;
+                total.snapshotsReceived += stats.snapshotsReceived;
+                total.snapshotsLost += stats.snapshotsLost;
+                total.snapshotsDropped += stats.snapshotsDropped;
+                total.snapshotsLate += stats.snapshotsLate;
+                total.decodeFailures += stats.decodeFailures;
+                total.arrivalIntervals.insert(total.arrivalIntervals.end(), stats.arrivalIntervals.begin(), stats.arrivalIntervals.end());
+                stats.Reset();
+            }
+        }
+    }
+
+    if (scheduler.GetOverrunCount() > 0)
+        std::cout << "Load tester fell behind " << scheduler.GetOverrunCount() << " times, results may understate the load" << std::endl;
+
+    //Before anyone leaves, while the server still has the whole load
+    if (timing)
+    {
+        try
+        {
+            timing = timed->connected && RequestTickStats(timed, false, &tickStats);
+        }
+        catch (std::exception& ex)
+        {
+            std::cout << ex.what() << std::endl;
+            timing = false;
+        }
+    }
+
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        try
+        {
+            if (clients[i]->connected) Disconnect(clients[i]);
+        }
+        catch (std::exception& ex)
+        {
+            std::cout << ex.what() << std::endl;
+        }
+        delete clients[i];
+    }
+
+    //Anything after the last full report period is left out
+    std::cout << std::endl << "Total" << std::endl;
+    stats = total;
+    Report((float)(totalTicks / reportTicks * reportSeconds));
+
+    if (timing)
+    {
+        std::cout << "  Server tick us  p50 " << tickStats.p50 << "  p90 " << tickStats.p90 << "  p99 " << tickStats.p99
+            << "  p99.9 " << tickStats.p999 << "  max " << tickStats.max << "  mean " << tickStats.mean << std::endl;
+        std::cout << "  Server ticks    " << tickStats.count << " over the whole run, " << tickStats.overBudget
+            << " over the " << tickStats.budget << "us budget" << std::endl;
+    }
+    else
+    {
+        std::cout << "  Server tick times unavailable" << std::endl;
+    }
+
+    return 0;
+}
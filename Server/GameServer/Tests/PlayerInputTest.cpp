@@ -0,0 +1,147 @@
+// PlayerInputTest.cpp : Checks a client can't move faster than real time by lying in its inputs.
+//
+// Player::ApplyInput spends each input's step from a budget that only refills as server time passes.
+// Negative and NaN steps used to get around it: a negative one paid the budget back, and a NaN one
+// turned the budget into NaN so no later input was ever over it. These send such inputs, then as many
+// full length inputs as fit in a packet every tick, and check the player covers no more ground than
+// real time plus the backlog allows. Malformed angles and steps must also never reach the position.
+//
+// From Server/GameServer/Tests:
+// g++ -std=c++14 -O2 PlayerInputTest.cpp ../GameServer/Player.cpp ../GameServer/SendRateController.cpp ../../../PlayerMovement.cpp ../../../ReliableChannel.cpp ../../../Snapshot.cpp -o PlayerInputTest
+
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include "../GameServer/Player.h"
+
+#define TICK_RATE 60
+
+//Sprint speed in PlayerMovement.cpp, the fastest anyone can go along the ground
+#define MAX_GROUND_SPEED 24.0f
+
+//Allowed rounding on top of the distance limit
+#define TOLERANCE 0.01f
+
+int checks = 0;
+int failures = 0;
+
+static void Check(const char* name, bool passed)
+{
+    checks++;
+    if (passed) return;
+    failures++;
+    std::cout << "FAIL " << name << std::endl;
+}
+
+static Player* NewPlayer()
+{
+    sockaddr_in address = {};
+    Player* p = new Player(address, 0);
+    p->SetPosition(0, -3, 0); //On the floor
+    p->SetVelocity(0, 0, 0);
+    p->pitch = p->yaw = p->roll = 0;
+    return p;
+}
+
+static PlayerInput MakeInput(uint32_t sequence, float dt)
+{
+    PlayerInput input = {};
+    input.sequence = sequence;
+    input.buttons = INPUT_FORWARD | INPUT_SPRINT;
+    input.dt = dt;
+    return input;
+}
+
+static float GroundDistance(Player* p)
+{
+    return sqrtf(p->positionX * p->positionX + p->positionZ * p->positionZ);
+}
+
+static bool PositionFinite(Player* p)
+{
+    return std::isfinite(p->positionX) && std::isfinite(p->positionY) && std::isfinite(p->positionZ) &&
+        std::isfinite(p->velocityX) && std::isfinite(p->velocityY) && std::isfinite(p->velocityZ);
+}
+
+//Sends a burst of bad inputs, then tries to run 6 times faster than real time for a second
+static void TestSpeedHack(const char* name, float badDt)
+{
+    Player* p = NewPlayer();
+    uint32_t sequence = 0;
+
+    for (int i = 0; i < 1000; i++)
+        p->ApplyInput(MakeInput(++sequence, badDt));
+    Check(name, std::isfinite(p->inputTimeBudget) && p->inputTimeBudget <= MAX_INPUT_BACKLOG);
+    Check(name, PositionFinite(p) && GroundDistance(p) == 0);
+
+    float dt = 1.0f / TICK_RATE;
+    for (int tick = 0; tick < TICK_RATE; tick++)
+    {
+        p->Update(dt);
+        for (int i = 0; i < MAX_INPUTS_PER_PACKET; i++)
+            p->ApplyInput(MakeInput(++sequence, MAX_INPUT_DT));
+    }
+
+    float limit = (1.0f + MAX_INPUT_BACKLOG) * MAX_GROUND_SPEED;
+    Check(name, PositionFinite(p) && GroundDistance(p) <= limit + TOLERANCE);
+
+    //Honest inputs still move it, so the checks above aren't passing because nothing moves at all
+    Check(name, GroundDistance(p) >= 1.0f * MAX_GROUND_SPEED - TOLERANCE);
+    delete p;
+}
+
+static void TestBadAngles()
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    const float angles[] = { nan, inf, -inf };
+
+    Player* p = NewPlayer();
+    uint32_t sequence = 0;
+    for (float a : angles)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            PlayerInput input = MakeInput(++sequence, 1.0f / TICK_RATE);
+            if (axis == 0) input.pitch = a;
+            else if (axis == 1) input.yaw = a;
+            else input.roll = a;
+
+            p->ApplyInput(input);
+            Check("non-finite angle", PositionFinite(p) && std::isfinite(p->pitch) && std::isfinite(p->yaw) && std::isfinite(p->roll));
+        }
+    }
+    Check("non-finite angle", GroundDistance(p) == 0);
+    delete p;
+}
+
+//The client predicts with the same function, so it has to shrug off a bad step by itself too
+static void TestSimulate()
+{
+    const float steps[] = { -1.0f, std::numeric_limits<float>::quiet_NaN(), 1000.0f };
+    for (float dt : steps)
+    {
+        MovementState state = { { 0, -3, 0 }, { 0, 0, 0 } };
+        PlayerInput input = MakeInput(1, dt);
+        PlayerMovement::Simulate(&state, input);
+
+        bool finite = true;
+        for (int a = 0; a < 3; a++)
+            finite = finite && std::isfinite(state.position[a]) && std::isfinite(state.velocity[a]);
+        float moved = sqrtf(state.position[0] * state.position[0] + state.position[2] * state.position[2]);
+        Check("Simulate step", finite && moved <= MAX_INPUT_DT * MAX_GROUND_SPEED + TOLERANCE);
+    }
+}
+
+int main()
+{
+    TestSpeedHack("negative dt", -1.0f);
+    TestSpeedHack("NaN dt", std::numeric_limits<float>::quiet_NaN());
+    TestSpeedHack("oversized dt", 1000.0f);
+    TestBadAngles();
+    TestSimulate();
+
+    std::cout << checks << " checks, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+// SnapshotTest.cpp : Checks world updates cost what the receiver can see changing, not what the server holds.
+//
+// A world update against an acked baseline only lists slots that left, arrived or changed, so a client
+// alone in an empty part of the map should get the same few bytes whether the session has 4 slots or
+// 1023, and players standing still near it should cost nothing. These build the update a client gets
+// the way GameServer does, with everyone out of its interest radius left not present, and compare sizes.
+// Random snapshots are also round tripped through chains of baselines to check nothing gets lost.
+//
+// From Server/GameServer/Tests:
+// g++ -std=c++14 -O2 SnapshotTest.cpp ../../../Snapshot.cpp -o SnapshotTest
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include "../../../Snapshot.h"
+
+//Slot counts to compare, up to the most a session can have
+static const int CAPACITIES[] = { 4, 64, 256, SNAPSHOT_MAX_PLAYERS };
+
+//Projectile slots per player slot, as GameServer gives them
+#define PROJECTILES_PER_PLAYER 6
+
+//Random round trip cases, each a chain of this many updates
+#define CASES 200
+#define CHAIN 8
+
+//Big enough for a full update at any capacity
+#define BUFFER_SIZE (1 << 20)
+
+//The receiving player's slot, present at every capacity
+#define OWN_SLOT 3
+
+int checks = 0;
+int failures = 0;
+
+static void Check(const char* name, bool passed)
+{
+    checks++;
+    if (passed) return;
+    failures++;
+    std::cout << "FAIL " << name << std::endl;
+}
+
+struct Random
+{
+    uint32_t state;
+
+    Random(uint32_t seed) : state(seed) {}
+
+    uint32_t Next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    int Next(int lo, int hi) { return lo + (int)(Next() % (uint32_t)(hi - lo)); }
+};
+
+static char buffer[BUFFER_SIZE];
+
+static void RandomPlayer(Random& random, PlayerSnapshot& p)
+{
+    p.present = true;
+    for (int a = 0; a < 3; a++)
+    {
+        p.position[a] = random.Next(-20000, 20000);
+        p.velocity[a] = random.Next(-500, 500);
+        p.rotation[a] = (uint16_t)random.Next();
+    }
+}
+
+static void RandomProjectile(Random& random, ProjectileSnapshot& p)
+{
+    p.present = true;
+    for (int a = 0; a < 3; a++)
+    {
+        p.position[a] = random.Next(-20000, 20000);
+        p.rotation[a] = (uint16_t)random.Next();
+    }
+    p.velocityY = random.Next(-500, 500);
+    p.age = (uint16_t)random.Next();
+    p.velocityX = random.Next(-500, 500);
+    p.velocityZ = random.Next(-500, 500);
+    p.gravity = random.Next(-500, 500);
+    p.lifespan = (uint16_t)random.Next();
+}
+
+//A full server with everything moving every tick
+static void FillWorld(Random& random, WorldSnapshot& world, int capacity, uint16_t sequence)
+{
+    world.sequence = sequence;
+    world.players.resize(capacity);
+    world.projectiles.resize(capacity * PROJECTILES_PER_PLAYER);
+    for (PlayerSnapshot& p : world.players) RandomPlayer(random, p);
+    for (ProjectileSnapshot& p : world.projectiles) RandomProjectile(random, p);
+}
+
+//What GameServer puts in one client's update: itself and the players it's near, nothing else
+static void VisibleTo(const WorldSnapshot& world, int slot, const int* nearby, int nearbyCount, WorldSnapshot& visible)
+{
+    visible.sequence = world.sequence;
+    visible.positionBits = world.positionBits;
+    visible.players.resize(world.players.size());
+    visible.projectiles.resize(world.projectiles.size());
+    for (PlayerSnapshot& p : visible.players) p.present = false;
+    for (ProjectileSnapshot& p : visible.projectiles) p.present = false;
+
+    visible.players[slot] = world.players[slot];
+    for (int i = 0; i < nearbyCount; i++)
+        visible.players[nearby[i]] = world.players[nearby[i]];
+
+    visible.hasOwnerState = true;
+    visible.ownerInputSequence = world.sequence;
+    for (int a = 0; a < 3; a++)
+    {
+        visible.ownerPosition[a] = (float)world.players[slot].position[a];
+        visible.ownerVelocity[a] = (float)world.players[slot].velocity[a];
+    }
+}
+
+static bool Same(const WorldSnapshot& a, const WorldSnapshot& b)
+{
+    if (a.sequence != b.sequence || a.positionBits != b.positionBits || a.interval != b.interval) return false;
+    if (a.players.size() != b.players.size() || a.projectiles.size() != b.projectiles.size()) return false;
+    if (a.hasOwnerState != b.hasOwnerState || a.reliableAck != b.reliableAck || a.reliableAckBits != b.reliableAckBits) return false;
+    if (a.hasOwnerState && (a.ownerInputSequence != b.ownerInputSequence ||
+        std::memcmp(a.ownerPosition, b.ownerPosition, sizeof(a.ownerPosition)) != 0 ||
+        std::memcmp(a.ownerVelocity, b.ownerVelocity, sizeof(a.ownerVelocity)) != 0)) return false;
+
+    for (size_t i = 0; i < a.players.size(); i++)
+    {
+        const PlayerSnapshot& x = a.players[i];
+        const PlayerSnapshot& y = b.players[i];
+        if (x.present != y.present) return false;
+        if (!x.present) continue;
+        if (std::memcmp(x.position, y.position, sizeof(x.position)) != 0 ||
+            std::memcmp(x.velocity, y.velocity, sizeof(x.velocity)) != 0 ||
+            std::memcmp(x.rotation, y.rotation, sizeof(x.rotation)) != 0) return false;
+    }
+    for (size_t i = 0; i < a.projectiles.size(); i++)
+    {
+        const ProjectileSnapshot& x = a.projectiles[i];
+        const ProjectileSnapshot& y = b.projectiles[i];
+        if (x.present != y.present) return false;
+        if (!x.present) continue;
+        if (std::memcmp(x.position, y.position, sizeof(x.position)) != 0 || x.velocityY != y.velocityY || x.age != y.age ||
+            x.velocityX != y.velocityX || x.velocityZ != y.velocityZ || x.gravity != y.gravity || x.lifespan != y.lifespan ||
+            std::memcmp(x.rotation, y.rotation, sizeof(x.rotation)) != 0) return false;
+    }
+    return true;
+}
+
+//Bytes for a client alone on the map: its first full update, then one against it while the rest of
+//the world keeps moving out of sight. Checks the client decodes both
+static void AloneSizes(int capacity, int* fullBytes, int* deltaBytes)
+{
+    Random random(capacity);
+    WorldSnapshot world, first, second, decoded;
+    SnapshotHistory history;
+
+    FillWorld(random, world, capacity, 100);
+    VisibleTo(world, OWN_SLOT, nullptr, 0, first);
+    *fullBytes = SnapshotCodec::Write(first, nullptr, buffer, BUFFER_SIZE);
+    Check("alone full update", *fullBytes > 0 && SnapshotCodec::Read(&decoded, &history, buffer, *fullBytes) && Same(decoded, first));
+    history.Store(decoded);
+
+    FillWorld(random, world, capacity, 101);
+    VisibleTo(world, OWN_SLOT, nullptr, 0, second);
+    *deltaBytes = SnapshotCodec::Write(second, &first, buffer, BUFFER_SIZE);
+    Check("alone delta update", *deltaBytes > 0 && SnapshotCodec::Read(&decoded, &history, buffer, *deltaBytes) && Same(decoded, second));
+}
+
+static void TestAlone()
+{
+    int fullBytes[4], deltaBytes[4];
+    for (int c = 0; c < 4; c++)
+    {
+        AloneSizes(CAPACITIES[c], &fullBytes[c], &deltaBytes[c]);
+        std::cout << CAPACITIES[c] << " slots, alone: " << fullBytes[c] << " bytes full, " << deltaBytes[c] << " bytes against a baseline" << std::endl;
+    }
+    for (int c = 1; c < 4; c++)
+    {
+        Check("alone full size doesn't grow with capacity", fullBytes[c] == fullBytes[0]);
+        Check("alone delta size doesn't grow with capacity", deltaBytes[c] == deltaBytes[0]);
+    }
+}
+
+//Players in view that haven't moved since the baseline add nothing; each one that moved adds its change
+static void TestStillNeighbours()
+{
+    const int capacity = SNAPSHOT_MAX_PLAYERS;
+    const int nearbyCount = 16;
+    int nearby[nearbyCount];
+    for (int i = 0; i < nearbyCount; i++) nearby[i] = 100 + i * 50;
+
+    Random random(7);
+    WorldSnapshot world, baseline, current, decoded;
+    FillWorld(random, world, capacity, 200);
+    VisibleTo(world, OWN_SLOT, nearby, nearbyCount, baseline);
+
+    //Only the receiver moves
+    world.sequence = 201;
+    RandomPlayer(random, world.players[OWN_SLOT]);
+    VisibleTo(world, OWN_SLOT, nearby, nearbyCount, current);
+
+    int aloneFull, aloneDelta;
+    AloneSizes(capacity, &aloneFull, &aloneDelta);
+    int stillBytes = SnapshotCodec::Write(current, &baseline, buffer, BUFFER_SIZE);
+    Check("still neighbours cost nothing", stillBytes == aloneDelta);
+
+    int lastBytes = stillBytes;
+    for (int moved = 1; moved <= 4; moved++)
+    {
+        RandomPlayer(random, world.players[nearby[moved]]);
+        VisibleTo(world, OWN_SLOT, nearby, nearbyCount, current);
+        int bytes = SnapshotCodec::Write(current, &baseline, buffer, BUFFER_SIZE);
+        Check("each moving neighbour costs something", bytes > lastBytes);
+        lastBytes = bytes;
+    }
+
+    SnapshotHistory history;
+    int fullBytes = SnapshotCodec::Write(baseline, nullptr, buffer, BUFFER_SIZE);
+    Check("neighbours full update", SnapshotCodec::Read(&decoded, &history, buffer, fullBytes) && Same(decoded, baseline));
+    history.Store(decoded);
+    int bytes = SnapshotCodec::Write(current, &baseline, buffer, BUFFER_SIZE);
+    Check("neighbours delta update", SnapshotCodec::Read(&decoded, &history, buffer, bytes) && Same(decoded, current));
+}
+
+//Each step some slots leave, some arrive, some get reused, some move and the rest stay put
+static void Step(Random& random, WorldSnapshot& s)
+{
+    s.sequence++;
+    s.reliableAck = (uint16_t)random.Next();
+    s.reliableAckBits = random.Next();
+    s.hasOwnerState = random.Next(0, 2) == 0;
+    s.ownerInputSequence = random.Next();
+    for (int a = 0; a < 3; a++)
+    {
+        s.ownerPosition[a] = (float)random.Next(-1000, 1000) / 7.0f;
+        s.ownerVelocity[a] = (float)random.Next(-1000, 1000) / 7.0f;
+    }
+
+    for (PlayerSnapshot& p : s.players)
+    {
+        int roll = random.Next(0, 10);
+        if (roll == 0) p.present = false;
+        else if (roll == 1) RandomPlayer(random, p);
+        else if (roll == 2 && p.present) p.position[random.Next(0, 3)] += random.Next(-50, 50);
+        else if (roll == 3 && p.present) p.rotation[random.Next(0, 3)] = (uint16_t)random.Next();
+    }
+    for (ProjectileSnapshot& p : s.projectiles)
+    {
+        int roll = random.Next(0, 10);
+        if (roll == 0) p.present = false;
+        else if (roll == 1) RandomProjectile(random, p);
+        else if (roll == 2 && p.present) { p.position[1] += random.Next(-50, 50); p.velocityY -= 3; p.age += 16; }
+    }
+}
+
+static void TestRoundTrip()
+{
+    Random random(42);
+    for (int c = 0; c < CASES; c++)
+    {
+        int capacity = random.Next(1, SNAPSHOT_MAX_PLAYERS + 1);
+        WorldSnapshot sent[CHAIN];
+        SnapshotHistory history;
+        WorldSnapshot decoded;
+
+        sent[0].sequence = (uint16_t)random.Next(); //Wraps around in some chains
+        sent[0].players.resize(capacity);
+        sent[0].projectiles.resize(capacity * PROJECTILES_PER_PLAYER);
+        for (PlayerSnapshot& p : sent[0].players) p.present = false;
+        for (ProjectileSnapshot& p : sent[0].projectiles) p.present = false;
+        Step(random, sent[0]);
+
+        for (int k = 0; k < CHAIN; k++)
+        {
+            if (k > 0)
+            {
+                sent[k] = sent[k - 1];
+                Step(random, sent[k]);
+                if (random.Next(0, 8) == 0) sent[k].positionBits = random.Next(5, 9); //Falls back to a full update. Grids under 5 bits would clip these positions
+            }
+
+            //Against any earlier update the client has, like an ack that's fallen behind
+            const WorldSnapshot* baseline = k > 0 ? &sent[random.Next(0, k)] : nullptr;
+            int bytes = SnapshotCodec::Write(sent[k], baseline, buffer, BUFFER_SIZE);
+            bool read = bytes > 0 && SnapshotCodec::Read(&decoded, &history, buffer, bytes);
+            Check("round trip", read && Same(decoded, sent[k]));
+            if (!read) break;
+            history.Store(decoded);
+        }
+    }
+}
+
+//A removal of something the baseline never had can only come from a corrupt packet
+static void TestBadRemoval()
+{
+    WorldSnapshot empty, decoded;
+    empty.sequence = 1;
+    empty.players.resize(4);
+    empty.projectiles.resize(0);
+    for (PlayerSnapshot& p : empty.players) p.present = false;
+
+    SnapshotHistory history;
+    int bytes = SnapshotCodec::Write(empty, nullptr, buffer, BUFFER_SIZE);
+    Check("empty update", SnapshotCodec::Read(&decoded, &history, buffer, bytes));
+    history.Store(decoded);
+
+    //Written against a baseline that had slot 2 under the same sequence, so the update removes it
+    Random random(1);
+    WorldSnapshot other = empty;
+    RandomPlayer(random, other.players[2]);
+    WorldSnapshot current = empty;
+    current.sequence = 2;
+    bytes = SnapshotCodec::Write(current, &other, buffer, BUFFER_SIZE);
+    Check("removing an absent slot is rejected", bytes > 0 && !SnapshotCodec::Read(&decoded, &history, buffer, bytes));
+}
+
+int main()
+{
+    TestAlone();
+    TestStillNeighbours();
+    TestRoundTrip();
+    TestBadRemoval();
+
+    std::cout << checks << " checks, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,676 @@
+// VectorMathTest.cpp : Checks every VectorMath function against reference math.
+//
+// References are worked out in double precision a different way from VectorMath itself: rotations as
+// products of single axis rotations, quaternion rotation as q * v * conjugate(q), inverses by Gauss-Jordan
+// elimination, and projection by where known points land. A few cases are also pinned to the exact values
+// DirectXMath gives, so the conventions (row vectors, left handed, roll then pitch then yaw) can't drift.
+//
+// Every VectorMath result also goes into a checksum of its bits. The SSE2, NEON and scalar backends
+// do the same float operations in the same order, so builds with and without -DVECTORMATH_SCALAR
+// must print the same checksum.
+//
+// From Server/GameServer/Tests:
+// g++ -std=c++14 -O2 VectorMathTest.cpp -o VectorMathTest
+// g++ -std=c++14 -O2 -DVECTORMATH_SCALAR VectorMathTest.cpp -o VectorMathTestScalar
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "../../../VectorMath.h"
+
+using namespace VectorMath;
+
+//Allowed difference from the double precision reference, relative to the size of the value
+#define TOLERANCE 2e-5
+
+//Random cases per function
+#define CASES 1000
+
+//Small deterministic generator so runs repeat exactly
+struct Random
+{
+    uint32_t state;
+
+    Random(uint32_t seed) : state(seed) {}
+
+    //Uniform in [lo, hi)
+    float Next(float lo, float hi)
+    {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * ((state >> 8) / 16777216.0f);
+    }
+};
+
+int checks = 0;
+int failures = 0;
+uint32_t checksum = 2166136261u;
+
+//Folds the exact bits of a result into the checksum
+static void Hash(const float* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        for (int b = 0; b < 4; b++)
+        {
+            checksum ^= (bits >> (b * 8)) & 0xFF;
+            checksum *= 16777619u;
+        }
+    }
+}
+
+static void Check(const char* name, const float* actual, const double* expected, int count, double tolerance = TOLERANCE)
+{
+    checks++;
+    Hash(actual, count);
+    for (int i = 0; i < count; i++)
+    {
+        if (fabs(actual[i] - expected[i]) > tolerance * (1 + fabs(expected[i])))
+        {
+            failures++;
+            std::cout << "FAIL " << name << " [" << i << "]: got " << actual[i] << ", expected " << expected[i] << std::endl;
+            return;
+        }
+    }
+}
+
+static void Check(const char* name, float actual, double expected, double tolerance = TOLERANCE)
+{
+    Check(name, &actual, &expected, 1, tolerance);
+}
+
+static void Check(const char* name, Vector actual, const double* expected, int count = 4)
+{
+    float f[4];
+    StoreFloat4(f, actual);
+    Check(name, f, expected, count);
+}
+
+static void Check(const char* name, const Matrix& actual, const double expected[4][4])
+{
+    float4x4 m;
+    StoreFloat4x4(&m, actual);
+    Check(name, &m.m[0][0], &expected[0][0], 16);
+}
+
+static void CheckTrue(const char* name, bool condition)
+{
+    checks++;
+    if (!condition)
+    {
+        failures++;
+        std::cout << "FAIL " << name << std::endl;
+    }
+}
+
+//Reference math, all in double
+
+struct Mat
+{
+    double m[4][4];
+};
+
+static Mat Identity()
+{
+    Mat r = {};
+    for (int i = 0; i < 4; i++) r.m[i][i] = 1;
+    return r;
+}
+
+static Mat Multiply(const Mat& a, const Mat& b)
+{
+    Mat r = {};
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            for (int k = 0; k < 4; k++)
+                r.m[i][j] += a.m[i][k] * b.m[k][j];
+    return r;
+}
+
+static Mat Transpose(const Mat& a)
+{
+    Mat r;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            r.m[i][j] = a.m[j][i];
+    return r;
+}
+
+//Single axis rotations as DirectXMath writes them for row vectors
+static Mat RotationX(double a)
+{
+    Mat r = Identity();
+    r.m[1][1] = cos(a); r.m[1][2] = sin(a);
+    r.m[2][1] = -sin(a); r.m[2][2] = cos(a);
+    return r;
+}
+
+static Mat RotationY(double a)
+{
+    Mat r = Identity();
+    r.m[0][0] = cos(a); r.m[0][2] = -sin(a);
+    r.m[2][0] = sin(a); r.m[2][2] = cos(a);
+    return r;
+}
+
+static Mat RotationZ(double a)
+{
+    Mat r = Identity();
+    r.m[0][0] = cos(a); r.m[0][1] = sin(a);
+    r.m[1][0] = -sin(a); r.m[1][1] = cos(a);
+    return r;
+}
+
+static Mat RollPitchYaw(double pitch, double yaw, double roll)
+{
+    return Multiply(Multiply(RotationZ(roll), RotationX(pitch)), RotationY(yaw));
+}
+
+static Mat Translation(double x, double y, double z)
+{
+    Mat r = Identity();
+    r.m[3][0] = x; r.m[3][1] = y; r.m[3][2] = z;
+    return r;
+}
+
+static Mat Scaling(double x, double y, double z)
+{
+    Mat r = Identity();
+    r.m[0][0] = x; r.m[1][1] = y; r.m[2][2] = z;
+    return r;
+}
+
+//Gauss-Jordan with partial pivoting
+static Mat Inverse(Mat a)
+{
+    Mat r = Identity();
+    for (int c = 0; c < 4; c++)
+    {
+        int pivot = c;
+        for (int i = c + 1; i < 4; i++)
+            if (fabs(a.m[i][c]) > fabs(a.m[pivot][c])) pivot = i;
+        for (int j = 0; j < 4; j++)
+        {
+            std::swap(a.m[c][j], a.m[pivot][j]);
+            std::swap(r.m[c][j], r.m[pivot][j]);
+        }
+
+        double scale = 1 / a.m[c][c];
+        for (int j = 0; j < 4; j++)
+        {
+            a.m[c][j] *= scale;
+            r.m[c][j] *= scale;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == c) continue;
+            double f = a.m[i][c];
+            for (int j = 0; j < 4; j++)
+            {
+                a.m[i][j] -= f * a.m[c][j];
+                r.m[i][j] -= f * r.m[c][j];
+            }
+        }
+    }
+    return r;
+}
+
+static double Determinant(Mat a)
+{
+    double det = 1;
+    for (int c = 0; c < 4; c++)
+    {
+        int pivot = c;
+        for (int i = c + 1; i < 4; i++)
+            if (fabs(a.m[i][c]) > fabs(a.m[pivot][c])) pivot = i;
+        if (pivot != c)
+        {
+            for (int j = 0; j < 4; j++) std::swap(a.m[c][j], a.m[pivot][j]);
+            det = -det;
+        }
+        det *= a.m[c][c];
+        for (int i = c + 1; i < 4; i++)
+        {
+            double f = a.m[i][c] / a.m[c][c];
+            for (int j = c; j < 4; j++) a.m[i][j] -= f * a.m[c][j];
+        }
+    }
+    return det;
+}
+
+//Quaternions as (x, y, z, w), Hamilton product
+struct Quat
+{
+    double x, y, z, w;
+};
+
+static Quat Hamilton(const Quat& a, const Quat& b)
+{
+    return {
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z };
+}
+
+static Quat AxisAngle(double x, double y, double z, double angle)
+{
+    double s = sin(angle / 2);
+    return { x * s, y * s, z * s, cos(angle / 2) };
+}
+
+//Rotation by a then b. DirectXMath's QuaternionMultiply(a, b) is the Hamilton product b * a
+static Quat Then(const Quat& a, const Quat& b)
+{
+    return Hamilton(b, a);
+}
+
+static Quat RollPitchYawQuat(double pitch, double yaw, double roll)
+{
+    return Then(Then(AxisAngle(0, 0, 1, roll), AxisAngle(1, 0, 0, pitch)), AxisAngle(0, 1, 0, yaw));
+}
+
+//q * v * conjugate(q)
+static void Rotate(const double* v, const Quat& q, double* out)
+{
+    Quat p = Hamilton(Hamilton(q, { v[0], v[1], v[2], 0 }), { -q.x, -q.y, -q.z, q.w });
+    out[0] = p.x; out[1] = p.y; out[2] = p.z;
+}
+
+//Rows are where each axis ends up, so v * M rotates like Rotate
+static Mat QuatMatrix(const Quat& q)
+{
+    Mat r = Identity();
+    const double axes[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+    for (int i = 0; i < 3; i++) Rotate(axes[i], q, r.m[i]);
+    return r;
+}
+
+//Conversions between the two sides
+
+static Matrix ToMatrix(const Mat& a)
+{
+    float4x4 f;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            f.m[i][j] = (float)a.m[i][j];
+    return LoadFloat4x4(&f);
+}
+
+//The float matrix a test feeds VectorMath, back in double so the reference starts from the same values
+static Mat FromMatrix(const Matrix& a)
+{
+    float4x4 f;
+    StoreFloat4x4(&f, a);
+    Mat r;
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 4; j++)
+            r.m[i][j] = f.m[i][j];
+    return r;
+}
+
+static Vector ToVector(const Quat& q)
+{
+    return VectorSet((float)q.x, (float)q.y, (float)q.z, (float)q.w);
+}
+
+//Random inputs
+
+static Vector RandomVector(Random& random, float range)
+{
+    return VectorSet(random.Next(-range, range), random.Next(-range, range), random.Next(-range, range), random.Next(-range, range));
+}
+
+static void ToDouble(Vector v, double* out)
+{
+    float f[4];
+    StoreFloat4(f, v);
+    for (int i = 0; i < 4; i++) out[i] = f[i];
+}
+
+//Scale * rotation * translation with well conditioned random parts
+static Mat RandomTransform(Random& random)
+{
+    double s[3];
+    for (int i = 0; i < 3; i++) s[i] = random.Next(0.5f, 2.0f) * (random.Next(0, 1) < 0.2f ? -1 : 1);
+    Mat srt = Multiply(Scaling(s[0], s[1], s[2]), RollPitchYaw(random.Next(-3, 3), random.Next(-3, 3), random.Next(-3, 3)));
+    return Multiply(srt, Translation(random.Next(-10, 10), random.Next(-10, 10), random.Next(-10, 10)));
+}
+
+//Tests
+
+static void TestVectors(Random& random)
+{
+    //Construction, lanes and storage
+    {
+        Vector v = VectorSet(1, -2, 3.5f, -4.25f);
+        const double set[4] = { 1, -2, 3.5, -4.25 };
+        Check("VectorSet", v, set);
+        const double lanes[4] = { VectorGetX(v), VectorGetY(v), VectorGetZ(v), VectorGetW(v) };
+        Check("VectorGetX..W", v, lanes);
+
+        const double zero[4] = { 0, 0, 0, 0 };
+        Check("VectorZero", VectorZero(), zero);
+        const double seven[4] = { 7, 7, 7, 7 };
+        Check("VectorReplicate", VectorReplicate(7), seven);
+        const double one[4] = { 1, 1, 1, 1 };
+        Check("VectorSplatOne", VectorSplatOne(), one);
+
+        const double splat[4][4] = { { 1, 1, 1, 1 }, { -2, -2, -2, -2 }, { 3.5, 3.5, 3.5, 3.5 }, { -4.25, -4.25, -4.25, -4.25 } };
+        Check("VectorSplatX", VectorSplatX(v), splat[0]);
+        Check("VectorSplatY", VectorSplatY(v), splat[1]);
+        Check("VectorSplatZ", VectorSplatZ(v), splat[2]);
+        Check("VectorSplatW", VectorSplatW(v), splat[3]);
+
+        float raw[4] = { 5, 6, 7, 8 };
+        const double loaded[4] = { 5, 6, 7, 8 };
+        Check("LoadFloat4(float*)", LoadFloat4(raw), loaded);
+        float stored[4];
+        StoreFloat4(stored, v);
+        Check("StoreFloat4(float*)", stored, set, 4);
+
+        float3 f3(9, -10, 11);
+        const double loaded3[4] = { 9, -10, 11, 0 };
+        Check("LoadFloat3", LoadFloat3(&f3), loaded3);
+        StoreFloat3(&f3, v);
+        Check("StoreFloat3", &f3.x, set, 3);
+
+        float4 f4(12, 13, -14, 15);
+        const double loaded4[4] = { 12, 13, -14, 15 };
+        Check("LoadFloat4(float4*)", LoadFloat4(&f4), loaded4);
+        StoreFloat4(&f4, v);
+        Check("StoreFloat4(float4*)", &f4.x, set, 4);
+    }
+
+    for (int n = 0; n < CASES; n++)
+    {
+        Vector a = RandomVector(random, 10), b = RandomVector(random, 10), c = RandomVector(random, 10);
+        double da[4], db[4], dc[4];
+        ToDouble(a, da); ToDouble(b, db); ToDouble(c, dc);
+
+        double add[4], sub[4], mul[4], div[4], neg[4], rcp[4], mad[4];
+        for (int i = 0; i < 4; i++)
+        {
+            add[i] = da[i] + db[i];
+            sub[i] = da[i] - db[i];
+            mul[i] = da[i] * db[i];
+            div[i] = da[i] / db[i];
+            neg[i] = -da[i];
+            rcp[i] = 1 / da[i];
+            mad[i] = da[i] * db[i] + dc[i];
+        }
+        Check("VectorAdd", VectorAdd(a, b), add);
+        Check("VectorSubtract", VectorSubtract(a, b), sub);
+        Check("VectorMultiply", VectorMultiply(a, b), mul);
+        if (fabs(db[0]) > 0.1 && fabs(db[1]) > 0.1 && fabs(db[2]) > 0.1 && fabs(db[3]) > 0.1)
+            Check("VectorDivide", VectorDivide(a, b), div);
+        Check("VectorNegate", VectorNegate(a), neg);
+        if (fabs(da[0]) > 0.1 && fabs(da[1]) > 0.1 && fabs(da[2]) > 0.1 && fabs(da[3]) > 0.1)
+            Check("VectorReciprocal", VectorReciprocal(a), rcp);
+        Check("VectorMultiplyAdd", VectorMultiplyAdd(a, b, c), mad);
+
+        //Angles well past one turn, where a poor range reduction would show
+        Vector angles = RandomVector(random, 20);
+        double dAngles[4], sines[4], cosines[4];
+        ToDouble(angles, dAngles);
+        for (int i = 0; i < 4; i++)
+        {
+            sines[i] = sin(dAngles[i]);
+            cosines[i] = cos(dAngles[i]);
+        }
+        Vector s, co;
+        VectorSinCos(&s, &co, angles);
+        Check("VectorSinCos sin", s, sines);
+        Check("VectorSinCos cos", co, cosines);
+
+        double dot = da[0] * db[0] + da[1] * db[1] + da[2] * db[2];
+        Check("Vector3Dot", Vector3Dot(a, b), dot, TOLERANCE * 10);
+
+        double cross[4] = { da[1] * db[2] - da[2] * db[1], da[2] * db[0] - da[0] * db[2], da[0] * db[1] - da[1] * db[0], 0 };
+        Check("Vector3Cross", Vector3Cross(a, b), cross);
+
+        double length = sqrt(da[0] * da[0] + da[1] * da[1] + da[2] * da[2]);
+        Check("Vector3Length", Vector3Length(a), length);
+        double normal[3] = { da[0] / length, da[1] / length, da[2] / length };
+        Check("Vector3Normalize", Vector3Normalize(a), normal, 3);
+    }
+
+    //Zero length is left alone rather than turned into NaNs
+    const double zero[4] = { 0, 0, 0, 0 };
+    Check("Vector3Normalize zero", Vector3Normalize(VectorZero()), zero);
+}
+
+static void TestQuaternions(Random& random)
+{
+    const double identity[4] = { 0, 0, 0, 1 };
+    Check("QuaternionIdentity", QuaternionIdentity(), identity);
+
+    //Pinned to DirectXMath: a quarter turn of yaw is (0, sin 45, 0, cos 45),
+    //and it turns +x to -z (left handed, row vectors)
+    {
+        double h = sqrt(0.5);
+        const double yaw90[4] = { 0, h, 0, h };
+        Check("QuaternionRotationRollPitchYaw yaw 90", QuaternionRotationRollPitchYaw(0, PI / 2, 0), yaw90);
+        const double minusZ[3] = { 0, 0, -1 };
+        Check("Vector3Rotate yaw 90", Vector3Rotate(VectorSet(1, 0, 0, 0), QuaternionRotationRollPitchYaw(0, PI / 2, 0)), minusZ, 3);
+
+        //Positive pitch tips forward (+z) down
+        const double down[3] = { 0, -1, 0 };
+        Check("Vector3Rotate pitch 90", Vector3Rotate(VectorSet(0, 0, 1, 0), QuaternionRotationRollPitchYaw(PI / 2, 0, 0)), down, 3);
+    }
+
+    for (int n = 0; n < CASES; n++)
+    {
+        double pitch = random.Next(-3, 3), yaw = random.Next(-3, 3), roll = random.Next(-3, 3);
+        Quat q = RollPitchYawQuat((float)pitch, (float)yaw, (float)roll);
+        Vector vq = QuaternionRotationRollPitchYaw((float)pitch, (float)yaw, (float)roll);
+        const double expected[4] = { q.x, q.y, q.z, q.w };
+        Check("QuaternionRotationRollPitchYaw", vq, expected);
+        Check("QuaternionRotationRollPitchYawFromVector",
+            QuaternionRotationRollPitchYawFromVector(VectorSet((float)pitch, (float)yaw, (float)roll, 0)), expected);
+
+        const double conjugate[4] = { -q.x, -q.y, -q.z, q.w };
+        Check("QuaternionConjugate", QuaternionConjugate(vq), conjugate);
+
+        //Any length in, unit length out
+        Vector raw = RandomVector(random, 5);
+        double dr[4];
+        ToDouble(raw, dr);
+        double length = sqrt(dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2] + dr[3] * dr[3]);
+        const double normal[4] = { dr[0] / length, dr[1] / length, dr[2] / length, dr[3] / length };
+        Check("QuaternionNormalize", QuaternionNormalize(raw), normal);
+
+        //a then b
+        Quat b = RollPitchYawQuat(random.Next(-3, 3), random.Next(-3, 3), random.Next(-3, 3));
+        Quat ab = Then(q, b);
+        const double product[4] = { ab.x, ab.y, ab.z, ab.w };
+        Check("QuaternionMultiply", QuaternionMultiply(ToVector(q), ToVector(b)), product);
+
+        Vector v = RandomVector(random, 10);
+        double dv[4], rotated[3];
+        ToDouble(v, dv);
+        Rotate(dv, q, rotated);
+        Check("Vector3Rotate", Vector3Rotate(v, ToVector(q)), rotated, 3);
+
+        //Back out of a rotation matrix, either sign is the same rotation
+        float4 back;
+        StoreFloat4(&back, QuaternionRotationMatrix(ToMatrix(QuatMatrix(q))));
+        double sign = back.x * q.x + back.y * q.y + back.z * q.z + back.w * q.w < 0 ? -1 : 1;
+        const double fromMatrix[4] = { sign * q.x, sign * q.y, sign * q.z, sign * q.w };
+        Check("QuaternionRotationMatrix", &back.x, fromMatrix, 4, TOLERANCE * 10);
+    }
+
+    const double zero[4] = { 0, 0, 0, 0 };
+    Check("QuaternionNormalize zero", QuaternionNormalize(VectorZero()), zero);
+}
+
+static void TestMatrices(Random& random)
+{
+    {
+        Mat id = Identity();
+        Check("MatrixIdentity", MatrixIdentity(), id.m);
+
+        float4x4 f;
+        for (int i = 0; i < 16; i++) f.m[i / 4][i % 4] = (float)(i * 3 - 20);
+        Mat expected;
+        for (int i = 0; i < 16; i++) expected.m[i / 4][i % 4] = i * 3 - 20;
+        Matrix m = LoadFloat4x4(&f);
+        Check("LoadFloat4x4", m, expected.m);
+        float4x4 stored;
+        StoreFloat4x4(&stored, m);
+        Check("StoreFloat4x4", &stored.m[0][0], &expected.m[0][0], 16);
+        Check("float4x4 _11.._44", &stored._11, &expected.m[0][0], 16);
+        Check("MatrixTranspose", MatrixTranspose(m), Transpose(expected).m);
+    }
+
+    //Pinned to DirectXMath: a quarter turn of yaw sends +x to -z, a camera at the origin
+    //looking down +z is the identity, and a 90 degree square projection has these exact entries
+    {
+        Mat yaw90 = Identity();
+        yaw90.m[0][0] = 0; yaw90.m[0][2] = -1;
+        yaw90.m[2][0] = 1; yaw90.m[2][2] = 0;
+        Check("MatrixRotationRollPitchYaw yaw 90", MatrixRotationRollPitchYaw(0, PI / 2, 0), yaw90.m);
+
+        Mat id = Identity();
+        Check("MatrixLookToLH identity", MatrixLookToLH(VectorZero(), VectorSet(0, 0, 1, 0), VectorSet(0, 1, 0, 0)), id.m);
+
+        const double projection[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 2, 1 }, { 0, 0, -2, 0 } };
+        Check("MatrixPerspectiveFovLH 90 degrees", MatrixPerspectiveFovLH(PI / 2, 1, 1, 2), projection);
+    }
+
+    for (int n = 0; n < CASES; n++)
+    {
+        float x = random.Next(-10, 10), y = random.Next(-10, 10), z = random.Next(-10, 10);
+        Check("MatrixTranslation", MatrixTranslation(x, y, z), Translation(x, y, z).m);
+        Check("MatrixTranslationFromVector", MatrixTranslationFromVector(VectorSet(x, y, z, 0)), Translation(x, y, z).m);
+        Check("MatrixScaling", MatrixScaling(x, y, z), Scaling(x, y, z).m);
+        Check("MatrixScalingFromVector", MatrixScalingFromVector(VectorSet(x, y, z, 0)), Scaling(x, y, z).m);
+
+        float pitch = random.Next(-3, 3), yaw = random.Next(-3, 3), roll = random.Next(-3, 3);
+        Mat rpy = RollPitchYaw(pitch, yaw, roll);
+        Check("MatrixRotationRollPitchYaw", MatrixRotationRollPitchYaw(pitch, yaw, roll), rpy.m);
+        Check("MatrixRotationRollPitchYawFromVector", MatrixRotationRollPitchYawFromVector(VectorSet(pitch, yaw, roll, 0)), rpy.m);
+
+        //The quaternion and matrix forms of the same angles must agree
+        Quat q = RollPitchYawQuat(pitch, yaw, roll);
+        Check("MatrixRotationQuaternion", MatrixRotationQuaternion(ToVector(q)), QuatMatrix(q).m);
+        Check("MatrixRotationQuaternion vs RollPitchYaw", MatrixRotationQuaternion(QuaternionRotationRollPitchYaw(pitch, yaw, roll)), rpy.m);
+
+        Matrix a = ToMatrix(RandomTransform(random));
+        Matrix b = ToMatrix(RandomTransform(random));
+        Mat da = FromMatrix(a), db = FromMatrix(b);
+        Check("MatrixMultiply", MatrixMultiply(a, b), Multiply(da, db).m);
+
+        float determinant;
+        Matrix inverse = MatrixInverse(&determinant, a);
+        Check("MatrixInverse", inverse, Inverse(da).m);
+        Check("MatrixInverse determinant", determinant, Determinant(da), TOLERANCE * 10);
+
+        //A general matrix too, not just scale/rotation/translation
+        Matrix g(RandomVector(random, 2), RandomVector(random, 2), RandomVector(random, 2), RandomVector(random, 2));
+        Mat dg = FromMatrix(g);
+        if (fabs(Determinant(dg)) > 0.5)
+            Check("MatrixInverse general", MatrixInverse(nullptr, g), Inverse(dg).m);
+
+        //Parts of scale * rotation * translation, rotation either sign
+        double s[3] = { random.Next(0.5f, 2.0f), random.Next(0.5f, 2.0f), random.Next(0.5f, 2.0f) };
+        if (n % 5 == 0) s[0] = -s[0];
+        Mat srt = Multiply(Multiply(Scaling(s[0], s[1], s[2]), QuatMatrix(q)), Translation(x, y, z));
+        Vector scale, rotation, translation;
+        bool ok = MatrixDecompose(&scale, &rotation, &translation, ToMatrix(srt));
+        CheckTrue("MatrixDecompose succeeds", ok);
+        if (ok)
+        {
+            const double expectedScale[3] = { s[0], s[1], s[2] };
+            Check("MatrixDecompose scale", scale, expectedScale, 3);
+            const double expectedTranslation[3] = { x, y, z };
+            Check("MatrixDecompose translation", translation, expectedTranslation, 3);
+
+            //Putting the parts back together gives the same matrix
+            Matrix rebuilt = MatrixMultiply(MatrixMultiply(MatrixScalingFromVector(scale), MatrixRotationQuaternion(rotation)), MatrixTranslationFromVector(translation));
+            Check("MatrixDecompose rebuilt", rebuilt, srt.m);
+        }
+
+        //A view matrix is the inverse of the camera's own world matrix
+        Vector eye = RandomVector(random, 10);
+        Vector direction = Vector3Normalize(RandomVector(random, 1));
+        Vector up = VectorSet(0, 1, 0, 0);
+        if (fabs(VectorGetY(direction)) < 0.95f)
+        {
+            double de[4], dd[4];
+            ToDouble(eye, de);
+            ToDouble(direction, dd);
+            double dLength = sqrt(dd[0] * dd[0] + dd[1] * dd[1] + dd[2] * dd[2]);
+            double zAxis[3] = { dd[0] / dLength, dd[1] / dLength, dd[2] / dLength };
+            double xAxis[3] = { zAxis[2], 0, -zAxis[0] }; //up x z
+            double xLength = sqrt(xAxis[0] * xAxis[0] + xAxis[2] * xAxis[2]);
+            xAxis[0] /= xLength; xAxis[2] /= xLength;
+            double yAxis[3] = { zAxis[1] * xAxis[2] - zAxis[2] * xAxis[1], zAxis[2] * xAxis[0] - zAxis[0] * xAxis[2], zAxis[0] * xAxis[1] - zAxis[1] * xAxis[0] };
+
+            Mat camera = Identity();
+            for (int i = 0; i < 3; i++)
+            {
+                camera.m[0][i] = xAxis[i];
+                camera.m[1][i] = yAxis[i];
+                camera.m[2][i] = zAxis[i];
+                camera.m[3][i] = de[i];
+            }
+            Check("MatrixLookToLH", MatrixLookToLH(eye, direction, up), Inverse(camera).m);
+        }
+
+        //Points on the near plane get depth 0, on the far plane 1, and the top edge of the view y = 1
+        float fov = random.Next(0.5f, 2.0f), aspect = random.Next(0.5f, 2.5f);
+        float nearZ = random.Next(0.05f, 1.0f), farZ = random.Next(10.0f, 1000.0f);
+        Matrix projection = MatrixPerspectiveFovLH(fov, aspect, nearZ, farZ);
+        double top = tan(fov / 2.0);
+        const double expected[2][2] = { { nearZ, 0 }, { farZ, 1 } };
+        for (int p = 0; p < 2; p++)
+        {
+            double depth = expected[p][0];
+            float4 clip;
+            StoreFloat4(&clip, MatrixMultiply(Matrix(VectorSet(0, (float)(top * depth), (float)depth, 1), VectorZero(), VectorZero(), VectorZero()), projection).r[0]);
+            const double ndc[2] = { 1, expected[p][1] };
+            const float actual[2] = { clip.y / clip.w, clip.z / clip.w };
+            Check("MatrixPerspectiveFovLH", actual, ndc, 2, TOLERANCE * 10);
+        }
+        float4 side;
+        StoreFloat4(&side, MatrixMultiply(Matrix(VectorSet((float)(top * aspect), 0, 1, 1), VectorZero(), VectorZero(), VectorZero()), projection).r[0]);
+        Check("MatrixPerspectiveFovLH aspect", side.x / side.w, 1.0);
+    }
+
+    //Edge cases
+    {
+        Mat singular = Scaling(1, 0, 1);
+        float determinant = 1;
+        Matrix m = MatrixInverse(&determinant, ToMatrix(singular));
+        Check("MatrixInverse singular unchanged", m, singular.m);
+        Check("MatrixInverse singular determinant", determinant, 0.0);
+
+        Vector scale, rotation, translation;
+        CheckTrue("MatrixDecompose zero scale fails", !MatrixDecompose(&scale, &rotation, &translation, ToMatrix(singular)));
+    }
+}
+
+int main()
+{
+    Random random(1);
+    TestVectors(random);
+    TestQuaternions(random);
+    TestMatrices(random);
+
+#if defined(VECTORMATH_SSE2)
+    const char* backend = "SSE2";
+#elif defined(VECTORMATH_NEON)
+    const char* backend = "NEON";
+#else
+    const char* backend = "scalar";
+#endif
+
+    std::cout << backend << " backend: " << checks << " checks, " << failures << " failed" << std::endl;
+    std::cout << "Result checksum " << std::hex << checksum << std::dec << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+#include "Snapshot.h"
+#include "BitStream.h"
+
+#include <cmath>
+#include <cstring>
+
+static const float PI = 3.14159265f;
+
+static int PositionBitCount(int fractionBits)
+{
+	return 1 + SNAPSHOT_POSITION_INTEGER_BITS + fractionBits;
+}
+
+int32_t SnapshotCodec::QuantizePosition(float value, int fractionBits)
+{
+	return (int32_t)std::lround(value * (float)(1 << fractionBits));
+}
+
+float SnapshotCodec::DequantizePosition(int32_t value, int fractionBits)
+{
+	return (float)value / (float)(1 << fractionBits);
+}
+
+int32_t SnapshotCodec::RequantizePosition(int32_t value, int fromBits, int toBits)
+{
+	if (toBits >= fromBits) return value * (1 << (toBits - fromBits));
+	return (int32_t)std::lround((double)value / (double)(1 << (fromBits - toBits)));
+}
+
+int32_t SnapshotCodec::QuantizeVelocity(float value)
+{
+	return (int32_t)std::lround(value * (float)(1 << SNAPSHOT_VELOCITY_FRACTION_BITS));
+}
+
+float SnapshotCodec::DequantizeVelocity(int32_t value)
+{
+	return (float)value / (float)(1 << SNAPSHOT_VELOCITY_FRACTION_BITS);
+}
+
+uint16_t SnapshotCodec::QuantizeAngle(float radians)
+{
+	float turns = radians / (2 * PI);
+	turns -= std::floor(turns);
+	return (uint16_t)((int32_t)std::lround(turns * 65536.0f) & 0xFFFF);
+}
+
+float SnapshotCodec::DequantizeAngle(uint16_t value)
+{
+	//Back into -PI..PI
+	float radians = (float)value / 65536.0f * (2 * PI);
+	if (radians > PI) radians -= 2 * PI;
+	return radians;
+}
+
+uint16_t SnapshotCodec::QuantizeTime(float seconds)
+{
+	if (seconds < 0) return 0;
+	if (seconds > 65.535f) return 0xFFFF;
+	return (uint16_t)std::lround(seconds * 1000.0f);
+}
+
+float SnapshotCodec::DequantizeTime(uint16_t value)
+{
+	return (float)value / 1000.0f;
+}
+
+bool SnapshotCodec::SequenceNewer(uint16_t a, uint16_t b)
+{
+	return (int16_t)(a - b) > 0;
+}
+
+void SnapshotHistory::Store(const WorldSnapshot& snapshot)
+{
+	int slot = snapshot.sequence % SNAPSHOT_HISTORY_SIZE;
+	snapshots[slot] = snapshot; //Vectors keep their capacity, so no allocation once warmed up
+	valid[slot] = true;
+}
+
+const WorldSnapshot* SnapshotHistory::Find(uint16_t sequence)
+{
+	int slot = sequence % SNAPSHOT_HISTORY_SIZE;
+	if (!valid[slot] || snapshots[slot].sequence != sequence) return nullptr;
+	return &snapshots[slot];
+}
+
+void SnapshotHistory::Clear()
+{
+	for (int i = 0; i < SNAPSHOT_HISTORY_SIZE; i++)
+		valid[i] = false;
+}
+
+static void WriteFloat(BitWriter& writer, float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, 4);
+	writer.WriteBits(bits, 32);
+}
+
+static float ReadFloat(BitReader& reader)
+{
+	uint32_t bits = reader.ReadBits(32);
+	float value;
+	std::memcpy(&value, &bits, 4);
+	return value;
+}
+
+static void WriteStatics(BitWriter& writer, const ProjectileSnapshot& p)
+{
+	writer.WriteSigned(p.velocityX, SNAPSHOT_VELOCITY_BITS);
+	writer.WriteSigned(p.velocityZ, SNAPSHOT_VELOCITY_BITS);
+	for (int a = 0; a < 3; a++) writer.WriteBits(p.rotation[a], 16);
+	writer.WriteSigned(p.gravity, SNAPSHOT_VELOCITY_BITS);
+	writer.WriteBits(p.lifespan, 16);
+}
+
+static void ReadStatics(BitReader& reader, ProjectileSnapshot& p)
+{
+	p.velocityX = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+	p.velocityZ = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+	for (int a = 0; a < 3; a++) p.rotation[a] = (uint16_t)reader.ReadBits(16);
+	p.gravity = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+	p.lifespan = (uint16_t)reader.ReadBits(16);
+}
+
+static bool StaticsMatch(const ProjectileSnapshot& a, const ProjectileSnapshot& b)
+{
+	return a.velocityX == b.velocityX && a.velocityZ == b.velocityZ &&
+		a.rotation[0] == b.rotation[0] && a.rotation[1] == b.rotation[1] && a.rotation[2] == b.rotation[2] &&
+		a.gravity == b.gravity && a.lifespan == b.lifespan;
+}
+
+//What changed in a player since the baseline, one bit each for position xyz, velocity xyz, rotation pyr
+static uint32_t PlayerMask(const PlayerSnapshot& p, const PlayerSnapshot& b)
+{
+	uint32_t mask = 0;
+	for (int a = 0; a < 3; a++)
+	{
+		if (p.position[a] != b.position[a]) mask |= 1 << a;
+		if (p.velocity[a] != b.velocity[a]) mask |= 1 << (a + 3);
+		if (p.rotation[a] != b.rotation[a]) mask |= 1 << (a + 6);
+	}
+	return mask;
+}
+
+//What changed in a projectile since the baseline, position xyz, velocityY, age
+static uint32_t ProjectileMask(const ProjectileSnapshot& p, const ProjectileSnapshot& b)
+{
+	uint32_t mask = 0;
+	for (int a = 0; a < 3; a++)
+		if (p.position[a] != b.position[a]) mask |= 1 << a;
+	if (p.velocityY != b.velocityY) mask |= 1 << 3;
+	if (p.age != b.age) mask |= 1 << 4;
+	return mask;
+}
+
+//The baseline's entry for a slot, or null if it didn't have one there
+template<typename T>
+static const T* BaselineSlot(const std::vector<T>* baseline, size_t i)
+{
+	if (baseline == nullptr || i >= baseline->size() || !(*baseline)[i].present) return nullptr;
+	return &(*baseline)[i];
+}
+
+//Slots the baseline had that are gone now
+template<typename T>
+static bool Removed(const std::vector<T>& slots, const std::vector<T>* baseline, size_t i)
+{
+	return !slots[i].present && BaselineSlot(baseline, i) != nullptr;
+}
+
+//Present slots the baseline didn't have, or had with different values
+static bool Changed(const std::vector<PlayerSnapshot>& slots, const std::vector<PlayerSnapshot>* baseline, size_t i)
+{
+	if (!slots[i].present) return false;
+	const PlayerSnapshot* b = BaselineSlot(baseline, i);
+	return b == nullptr || PlayerMask(slots[i], *b) != 0;
+}
+
+static bool Changed(const std::vector<ProjectileSnapshot>& slots, const std::vector<ProjectileSnapshot>* baseline, size_t i)
+{
+	if (!slots[i].present) return false;
+	const ProjectileSnapshot* b = BaselineSlot(baseline, i);
+	return b == nullptr || ProjectileMask(slots[i], *b) != 0 || !StaticsMatch(slots[i], *b);
+}
+
+//A list of slots, as its length and then the gap since the previous slot in it, each followed by
+//whatever writeEntry writes for it
+template<typename InList, typename WriteEntry>
+static void WriteSlotList(BitWriter& writer, size_t size, InList inList, WriteEntry writeEntry)
+{
+	uint32_t count = 0;
+	for (size_t i = 0; i < size; i++)
+		if (inList(i)) count++;
+
+	writer.WriteVarUInt(count);
+	size_t next = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		if (!inList(i)) continue;
+		writer.WriteVarUInt((uint32_t)(i - next));
+		writeEntry(i);
+		next = i + 1;
+	}
+}
+
+//Calls visit for each slot in a list written by WriteSlotList, which reads the slot's entry.
+//False if a slot is out of range or visit fails
+template<typename Visit>
+static bool ReadSlotList(BitReader& reader, size_t size, Visit visit)
+{
+	uint32_t count = reader.ReadVarUInt();
+	if (count > size) return false;
+
+	size_t next = 0;
+	for (uint32_t k = 0; k < count; k++)
+	{
+		size_t i = next + reader.ReadVarUInt();
+		if (i >= size || !visit(i)) return false;
+		next = i + 1;
+	}
+	return true;
+}
+
+//Starts every slot off as the baseline had it, or empty without one
+template<typename T>
+static void CopyBaseline(std::vector<T>& slots, const std::vector<T>* baseline)
+{
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		const T* b = BaselineSlot(baseline, i);
+		if (b != nullptr) slots[i] = *b;
+		else slots[i].present = false;
+	}
+}
+
+static void WritePlayer(BitWriter& writer, const PlayerSnapshot& p, const PlayerSnapshot* b, int posBits)
+{
+	if (b == nullptr)
+	{
+		for (int a = 0; a < 3; a++) writer.WriteSigned(p.position[a], posBits);
+		for (int a = 0; a < 3; a++) writer.WriteSigned(p.velocity[a], SNAPSHOT_VELOCITY_BITS);
+		for (int a = 0; a < 3; a++) writer.WriteBits(p.rotation[a], 16);
+		return;
+	}
+
+	uint32_t mask = PlayerMask(p, *b);
+	writer.WriteBits(mask, 9);
+	for (int a = 0; a < 3; a++) if (mask & (1 << a)) writer.WriteSigned(p.position[a], posBits);
+	for (int a = 0; a < 3; a++) if (mask & (1 << (a + 3))) writer.WriteSigned(p.velocity[a], SNAPSHOT_VELOCITY_BITS);
+	for (int a = 0; a < 3; a++) if (mask & (1 << (a + 6))) writer.WriteBits(p.rotation[a], 16);
+}
+
+//p holds the baseline's entry if hadBaseline, and gets the changes on top
+static void ReadPlayer(BitReader& reader, PlayerSnapshot& p, bool hadBaseline, int posBits)
+{
+	if (!hadBaseline)
+	{
+		for (int a = 0; a < 3; a++) p.position[a] = reader.ReadSigned(posBits);
+		for (int a = 0; a < 3; a++) p.velocity[a] = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+		for (int a = 0; a < 3; a++) p.rotation[a] = (uint16_t)reader.ReadBits(16);
+		return;
+	}
+
+	uint32_t mask = reader.ReadBits(9);
+	for (int a = 0; a < 3; a++) if (mask & (1 << a)) p.position[a] = reader.ReadSigned(posBits);
+	for (int a = 0; a < 3; a++) if (mask & (1 << (a + 3))) p.velocity[a] = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+	for (int a = 0; a < 3; a++) if (mask & (1 << (a + 6))) p.rotation[a] = (uint16_t)reader.ReadBits(16);
+}
+
+static void WriteProjectile(BitWriter& writer, const ProjectileSnapshot& p, const ProjectileSnapshot* b, int posBits)
+{
+	if (b == nullptr)
+	{
+		for (int a = 0; a < 3; a++) writer.WriteSigned(p.position[a], posBits);
+		writer.WriteSigned(p.velocityY, SNAPSHOT_VELOCITY_BITS);
+		writer.WriteBits(p.age, 16);
+		WriteStatics(writer, p);
+		return;
+	}
+
+	uint32_t mask = ProjectileMask(p, *b);
+	bool staticsChanged = !StaticsMatch(p, *b); //Slot was reused for a new projectile
+	writer.WriteBits(mask, 5);
+	writer.WriteBool(staticsChanged);
+
+	for (int a = 0; a < 3; a++) if (mask & (1 << a)) writer.WriteSigned(p.position[a], posBits);
+	if (mask & (1 << 3)) writer.WriteSigned(p.velocityY, SNAPSHOT_VELOCITY_BITS);
+	if (mask & (1 << 4)) writer.WriteBits(p.age, 16);
+	if (staticsChanged) WriteStatics(writer, p);
+}
+
+static void ReadProjectile(BitReader& reader, ProjectileSnapshot& p, bool hadBaseline, int posBits)
+{
+	if (!hadBaseline)
+	{
+		for (int a = 0; a < 3; a++) p.position[a] = reader.ReadSigned(posBits);
+		p.velocityY = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+		p.age = (uint16_t)reader.ReadBits(16);
+		ReadStatics(reader, p);
+		return;
+	}
+
+	uint32_t mask = reader.ReadBits(5);
+	bool staticsChanged = reader.ReadBool();
+
+	for (int a = 0; a < 3; a++) if (mask & (1 << a)) p.position[a] = reader.ReadSigned(posBits);
+	if (mask & (1 << 3)) p.velocityY = reader.ReadSigned(SNAPSHOT_VELOCITY_BITS);
+	if (mask & (1 << 4)) p.age = (uint16_t)reader.ReadBits(16);
+	if (staticsChanged) ReadStatics(reader, p);
+}
+
+// Layout after the message type:
+//   positionBits(4) sequence(16) interval(4) hasBaseline(1) [baselineSequence(16)]
+//   playerCount(SNAPSHOT_PLAYER_COUNT_BITS) projectileCount(SNAPSHOT_PROJECTILE_COUNT_BITS)
+//   hasOwnerState(1) [ownerInputSequence(32) ownerPosition xyz, ownerVelocity xyz (raw floats)]
+//   reliableAck(16) reliableAckBits(32)
+//   removed players, then changed players each followed by:
+//     if the baseline had it: fieldMask(9) + each changed field
+//     otherwise: position xyz, velocity xyz, rotation pyr (16 each)
+//   removed projectiles, then changed projectiles each followed by:
+//     if the baseline had it: fieldMask(5) staticsChanged(1) + each changed field
+//     otherwise: position xyz, velocityY, age(16), statics
+//   statics: velocityX, velocityZ, rotation pyr, gravity, lifespan(16)
+// Removed slots are the ones the baseline had that aren't present now. Changed slots are the present
+// ones the baseline didn't have or had with different values; without a baseline that's all present.
+// Every other slot is as the baseline had it, so slots that are empty, out of the receiver's interest
+// or standing still cost nothing. A slot list is its length, then the gap before each slot, all VarUInts
+int SnapshotCodec::Write(const WorldSnapshot& snapshot, const WorldSnapshot* baseline, char* buffer, int capacity)
+{
+	if (capacity < 4) return 0;
+	if (snapshot.players.size() > SNAPSHOT_MAX_PLAYERS || snapshot.projectiles.size() > SNAPSHOT_MAX_PROJECTILES) return 0;
+
+	//Quantized values from a different grid can't be compared
+	if (baseline != nullptr && baseline->positionBits != snapshot.positionBits) baseline = nullptr;
+
+	unsigned int msgType = 10;
+	std::memcpy(buffer, &msgType, 4);
+
+	BitWriter writer(buffer + 4, capacity - 4);
+	int posBits = PositionBitCount(snapshot.positionBits);
+
+	writer.WriteBits(snapshot.positionBits, 4);
+	writer.WriteBits(snapshot.sequence, 16);
+	writer.WriteBits((uint32_t)snapshot.interval, 4);
+	writer.WriteBool(baseline != nullptr);
+	if (baseline != nullptr) writer.WriteBits(baseline->sequence, 16);
+	writer.WriteBits((uint32_t)snapshot.players.size(), SNAPSHOT_PLAYER_COUNT_BITS);
+	writer.WriteBits((uint32_t)snapshot.projectiles.size(), SNAPSHOT_PROJECTILE_COUNT_BITS);
+
+	writer.WriteBool(snapshot.hasOwnerState);
+	if (snapshot.hasOwnerState)
+	{
+		writer.WriteBits(snapshot.ownerInputSequence, 32);
+		for (int a = 0; a < 3; a++) WriteFloat(writer, snapshot.ownerPosition[a]);
+		for (int a = 0; a < 3; a++) WriteFloat(writer, snapshot.ownerVelocity[a]);
+	}
+	writer.WriteBits(snapshot.reliableAck, 16);
+	writer.WriteBits(snapshot.reliableAckBits, 32);
+
+	const std::vector<PlayerSnapshot>& players = snapshot.players;
+	const std::vector<PlayerSnapshot>* basePlayers = baseline != nullptr ? &baseline->players : nullptr;
+	WriteSlotList(writer, players.size(),
+		[&](size_t i) { return Removed(players, basePlayers, i); },
+		[](size_t) {});
+	WriteSlotList(writer, players.size(),
+		[&](size_t i) { return Changed(players, basePlayers, i); },
+		[&](size_t i) { WritePlayer(writer, players[i], BaselineSlot(basePlayers, i), posBits); });
+
+	const std::vector<ProjectileSnapshot>& projectiles = snapshot.projectiles;
+	const std::vector<ProjectileSnapshot>* baseProjectiles = baseline != nullptr ? &baseline->projectiles : nullptr;
+	WriteSlotList(writer, projectiles.size(),
+		[&](size_t i) { return Removed(projectiles, baseProjectiles, i); },
+		[](size_t) {});
+	WriteSlotList(writer, projectiles.size(),
+		[&](size_t i) { return Changed(projectiles, baseProjectiles, i); },
+		[&](size_t i) { WriteProjectile(writer, projectiles[i], BaselineSlot(baseProjectiles, i), posBits); });
+
+	int bytes = writer.Flush();
+	if (writer.Overflowed()) return 0;
+	return bytes + 4;
+}
+
+bool SnapshotCodec::Read(WorldSnapshot* snapshot, SnapshotHistory* history, const char* buffer, int length)
+{
+	if (length < 4) return false;
+
+	BitReader reader(buffer + 4, length - 4);
+
+	snapshot->positionBits = (int)reader.ReadBits(4);
+	snapshot->sequence = (uint16_t)reader.ReadBits(16);
+	snapshot->interval = (int)reader.ReadBits(4);
+	if (snapshot->interval < 1) snapshot->interval = 1;
+	int posBits = PositionBitCount(snapshot->positionBits);
+
+	const WorldSnapshot* baseline = nullptr;
+	if (reader.ReadBool())
+	{
+		baseline = history->Find((uint16_t)reader.ReadBits(16));
+		if (baseline == nullptr) return false;
+	}
+
+	snapshot->players.resize(reader.ReadBits(SNAPSHOT_PLAYER_COUNT_BITS));
+	snapshot->projectiles.resize(reader.ReadBits(SNAPSHOT_PROJECTILE_COUNT_BITS));
+
+	snapshot->hasOwnerState = reader.ReadBool();
+	if (snapshot->hasOwnerState)
+	{
+		snapshot->ownerInputSequence = reader.ReadBits(32);
+		for (int a = 0; a < 3; a++) snapshot->ownerPosition[a] = ReadFloat(reader);
+		for (int a = 0; a < 3; a++) snapshot->ownerVelocity[a] = ReadFloat(reader);
+	}
+	snapshot->reliableAck = (uint16_t)reader.ReadBits(16);
+	snapshot->reliableAckBits = reader.ReadBits(32);
+
+	//Removed slots are no longer present after their list, so a changed slot that still is came from the baseline
+	std::vector<PlayerSnapshot>& players = snapshot->players;
+	CopyBaseline(players, baseline != nullptr ? &baseline->players : nullptr);
+	bool valid = ReadSlotList(reader, players.size(), [&](size_t i)
+	{
+		if (!players[i].present) return false;
+		players[i].present = false;
+		return true;
+	});
+	valid = valid && ReadSlotList(reader, players.size(), [&](size_t i)
+	{
+		ReadPlayer(reader, players[i], players[i].present, posBits);
+		players[i].present = true;
+		return true;
+	});
+	if (!valid) return false;
+
+	std::vector<ProjectileSnapshot>& projectiles = snapshot->projectiles;
+	CopyBaseline(projectiles, baseline != nullptr ? &baseline->projectiles : nullptr);
+	valid = ReadSlotList(reader, projectiles.size(), [&](size_t i)
+	{
+		if (!projectiles[i].present) return false;
+		projectiles[i].present = false;
+		return true;
+	});
+	valid = valid && ReadSlotList(reader, projectiles.size(), [&](size_t i)
+	{
+		ReadProjectile(reader, projectiles[i], projectiles[i].present, posBits);
+		projectiles[i].present = true;
+		return true;
+	});
+	if (!valid) return false;
+
+	return !reader.Overflowed();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//Fractional bits used for positions unless the server is told otherwise (1/64 unit grid)
+#define SNAPSHOT_DEFAULT_POSITION_BITS 6
+
+//Whole-unit bits for positions, +-4096 units each axis
+#define SNAPSHOT_POSITION_INTEGER_BITS 12
+
+//Velocities use a fixed 1/32 unit/s grid, +-512 units/s
+#define SNAPSHOT_VELOCITY_BITS 15
+#define SNAPSHOT_VELOCITY_FRACTION_BITS 5
+
+//How many past snapshots each side keeps around as delta baselines
+#define SNAPSHOT_HISTORY_SIZE 32
+
+//Bits for the slot counts in a world update, which caps how big a session can be. Every client also keeps
+//SNAPSHOT_HISTORY_SIZE baselines covering every slot, about 10KB per player slot per client with
+//6 projectiles each, so memory runs out well before a bigger field would help
+#define SNAPSHOT_PLAYER_COUNT_BITS 10
+#define SNAPSHOT_PROJECTILE_COUNT_BITS 13
+#define SNAPSHOT_MAX_PLAYERS ((1 << SNAPSHOT_PLAYER_COUNT_BITS) - 1)
+#define SNAPSHOT_MAX_PROJECTILES ((1 << SNAPSHOT_PROJECTILE_COUNT_BITS) - 1)
+
+//Quantized state of one player slot
+struct PlayerSnapshot
+{
+	bool present;
+	int32_t position[3];
+	int32_t velocity[3];
+	uint16_t rotation[3]; //pitch/yaw/roll
+};
+
+//Quantized state of one projectile slot
+struct ProjectileSnapshot
+{
+	bool present;
+	int32_t position[3];
+	int32_t velocityY;
+	uint16_t age;
+
+	//Fixed for the projectile's life, only sent when they differ from the baseline
+	int32_t velocityX;
+	int32_t velocityZ;
+	uint16_t rotation[3];
+	int32_t gravity;
+	uint16_t lifespan;
+};
+
+//Everything in one msgType 10 world update
+struct WorldSnapshot
+{
+	uint16_t sequence = 0;
+	int positionBits = SNAPSHOT_DEFAULT_POSITION_BITS;
+
+	//Ticks between updates to the receiver. The server sends slow links fewer, so a gap this big isn't loss
+	int interval = 1;
+	std::vector<PlayerSnapshot> players;
+	std::vector<ProjectileSnapshot> projectiles;
+
+	//Exact state of the receiving player after the server applied its inputs up to ownerInputSequence.
+	//Never delta encoded, the client rewinds to it and replays newer inputs
+	bool hasOwnerState = false;
+	uint32_t ownerInputSequence = 0;
+	float ownerPosition[3];
+	float ownerVelocity[3];
+
+	//What the server's reliable channel to the receiver has got, see ReliableChannel::GetAck
+	uint16_t reliableAck = 0;
+	uint32_t reliableAckBits = 0;
+};
+
+//Ring of recent snapshots, looked up by sequence number
+class SnapshotHistory
+{
+private:
+
+	WorldSnapshot snapshots[SNAPSHOT_HISTORY_SIZE];
+	bool valid[SNAPSHOT_HISTORY_SIZE] = {};
+
+public:
+
+	void Store(const WorldSnapshot& snapshot);
+	const WorldSnapshot* Find(uint16_t sequence);
+	void Clear();
+
+};
+
+//Quantization helpers and the bit-packed wire format for world snapshots
+class SnapshotCodec
+{
+public:
+
+	static int32_t QuantizePosition(float value, int fractionBits);
+	static float DequantizePosition(int32_t value, int fractionBits);
+
+	//Moves an already quantized position onto a grid with a different number of fractional bits
+	static int32_t RequantizePosition(int32_t value, int fromBits, int toBits);
+
+	static int32_t QuantizeVelocity(float value);
+	static float DequantizeVelocity(int32_t value);
+
+	//Radians, wrapped to a full turn over 16 bits
+	static uint16_t QuantizeAngle(float radians);
+	static float DequantizeAngle(uint16_t value);
+
+	//Seconds, at millisecond resolution
+	static uint16_t QuantizeTime(float seconds);
+	static float DequantizeTime(uint16_t value);
+
+	//True if sequence a was sent after b, allowing for wrap around
+	static bool SequenceNewer(uint16_t a, uint16_t b);
+
+	//Writes the snapshot after the 4 byte message type, only encoding what changed since baseline.
+	//baseline may be null for a full snapshot. Returns bytes used, or 0 if it didn't fit or has more
+	//slots than SNAPSHOT_MAX_PLAYERS/SNAPSHOT_MAX_PROJECTILES
+	static int Write(const WorldSnapshot& snapshot, const WorldSnapshot* baseline, char* buffer, int capacity);
+
+	//Reads a snapshot written by Write, filling in unchanged fields from the baseline in history.
+	//Returns false if the data was truncated or the baseline is no longer available
+	static bool Read(WorldSnapshot* snapshot, SnapshotHistory* history, const char* buffer, int length);
+
+};
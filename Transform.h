@@ -1,12 +1,18 @@
 #pragma once
 
-#include <DirectXMath.h>
-#include <vector>
+#include "VectorMath.h"
+#include "TransformSystem.h"
 
+// Handle to a transform whose data lives in the TransformSystem
 class Transform
 {
 public:
 	Transform();
+	~Transform();
+
+	// Owns its slot in the system, so it can't be copied
+	Transform(Transform const&) = delete;
+	void operator=(Transform const&) = delete;
 
 	void MoveAbsolute(float x, float y, float z);
 	void MoveRelative(float x, float y, float z);
@@ -15,15 +21,17 @@ public:
 
 	void SetPosition(float x, float y, float z);
 	void SetRotation(float p, float y, float r);
+	void SetRotation(VectorMath::quat rotation);
 	void SetScale(float x, float y, float z);
 
-	void SetTransformsFromMatrix(DirectX::XMFLOAT4X4 worldMatrix);
+	void SetTransformsFromMatrix(VectorMath::float4x4 worldMatrix);
 
-	DirectX::XMFLOAT3 GetPosition();
-	DirectX::XMFLOAT3 GetPitchYawRoll();
-	DirectX::XMFLOAT3 GetScale();
-	DirectX::XMFLOAT4X4 GetWorldMatrix();
-	DirectX::XMFLOAT4X4 GetWorldInverseTransposeMatrix();
+	VectorMath::float3 GetPosition();
+	VectorMath::float3 GetPitchYawRoll();
+	VectorMath::quat GetRotation();
+	VectorMath::float3 GetScale();
+	VectorMath::float4x4 GetWorldMatrix();
+	VectorMath::float4x4 GetWorldInverseTransposeMatrix();
 
 	void AddChild(Transform* child, bool makeChildRelative = true);
 	void RemoveChild(Transform* child, bool applyParentTransform = true);
@@ -34,26 +42,6 @@ public:
 	unsigned int GetChildCount();
 
 private:
-	// Raw transformation data
-	DirectX::XMFLOAT3 position;
-	DirectX::XMFLOAT3 pitchYawRoll;
-	DirectX::XMFLOAT3 scale;
-
-	// World matrix and inverse transpose of the world matrix
-	bool matricesDirty;
-	DirectX::XMFLOAT4X4 worldMatrix;
-	DirectX::XMFLOAT4X4 worldInverseTransposeMatrix;
-
-	Transform* parent;
-	std::vector<Transform*> children;
-
-	// Helper to update both matrices if necessary
-	void UpdateMatrices();
-	
-	void MarkChildTransformsDirty();
-
-	// Helpers for conversion
-	DirectX::XMFLOAT3 QuaternionToEuler(DirectX::XMFLOAT4 quaternion);
-
+	TransformSystem* system;
+	TransformHandle handle;
 };
-
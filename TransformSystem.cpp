@@ -0,0 +1,505 @@
+#include "TransformSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace VectorMath;
+
+TransformSystem* TransformSystem::instance;
+
+// An update walks the changed subtrees until they come to more than 1 in this many transforms, then
+// checks every parent link in one pass instead. Following child lists costs a few cache misses a
+// transform where the linear pass streams through, so the walk only wins while it stays small
+#define TRANSFORM_WALK_SHARE 64
+
+// Reorders one array so element i becomes what was at order[i]. The result is built in scratch and
+// swapped in, so scratch ends up holding the old storage, ready for the next array of the same type
+template<typename T>
+static void Permute(std::vector<T>& values, std::vector<T>& scratch, const std::vector<int>& order)
+{
+	scratch.resize(values.size());
+	for (size_t i = 0; i < order.size(); i++)
+		scratch[i] = values[order[i]];
+	values.swap(scratch);
+}
+
+TransformSystem::TransformSystem()
+{
+	anyDirty = false;
+	orderBroken = false;
+}
+
+TransformHandle TransformSystem::Create(Transform* owner)
+{
+	TransformHandle handle;
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+	}
+	else
+	{
+		handle = (TransformHandle)indexOf.size();
+		indexOf.push_back(-1);
+		owners.push_back(nullptr);
+		children.push_back(std::vector<TransformHandle>());
+		childSlot.push_back(0);
+	}
+
+	float4x4 identity;
+	StoreFloat4x4(&identity, MatrixIdentity());
+
+	// Start with an identity matrix and basic transform data, nothing to recalc yet
+	indexOf[handle] = (int)position.size();
+	owners[handle] = owner;
+	position.push_back(float3(0, 0, 0));
+	pitchYawRoll.push_back(float3(0, 0, 0));
+	rotation.push_back(quat(0, 0, 0, 1));
+	rotationState.push_back(TRANSFORM_ROTATION_CURRENT);
+	scale.push_back(float3(1, 1, 1));
+	parent.push_back(-1);
+	dirty.push_back(TRANSFORM_CLEAN);
+	worldMatrix.push_back(identity);
+	worldInverseTransposeMatrix.push_back(identity);
+	handleAt.push_back(handle);
+
+	return handle;
+}
+
+void TransformSystem::Destroy(TransformHandle handle)
+{
+	// Orphan the children where they are
+	for (size_t c = 0; c < children[handle].size(); c++)
+	{
+		TransformHandle child = children[handle][c];
+		parent[indexOf[child]] = -1;
+		MarkDirty(child);
+	}
+	children[handle].clear();
+
+	SetParent(handle, TRANSFORM_NONE);
+
+	// Fill the gap with the last transform
+	int index = indexOf[handle];
+	int last = (int)position.size() - 1;
+	if (index != last)
+	{
+		position[index] = position[last];
+		pitchYawRoll[index] = pitchYawRoll[last];
+		rotation[index] = rotation[last];
+		rotationState[index] = rotationState[last];
+		scale[index] = scale[last];
+		parent[index] = parent[last];
+		dirty[index] = dirty[last];
+		worldMatrix[index] = worldMatrix[last];
+		worldInverseTransposeMatrix[index] = worldInverseTransposeMatrix[last];
+		handleAt[index] = handleAt[last];
+
+		TransformHandle moved = handleAt[index];
+		indexOf[moved] = index;
+		if (parent[index] > index) orderBroken = true;
+
+		for (size_t c = 0; c < children[moved].size(); c++)
+		{
+			int childIndex = indexOf[children[moved][c]];
+			parent[childIndex] = index;
+			if (childIndex < index) orderBroken = true;
+		}
+	}
+
+	position.pop_back();
+	pitchYawRoll.pop_back();
+	rotation.pop_back();
+	rotationState.pop_back();
+	scale.pop_back();
+	parent.pop_back();
+	dirty.pop_back();
+	worldMatrix.pop_back();
+	worldInverseTransposeMatrix.pop_back();
+	handleAt.pop_back();
+
+	indexOf[handle] = -1;
+	owners[handle] = nullptr;
+	freeHandles.push_back(handle);
+}
+
+void TransformSystem::SetPosition(TransformHandle handle, VectorMath::float3 value)
+{
+	position[indexOf[handle]] = value;
+	MarkDirty(handle);
+}
+
+VectorMath::float3 TransformSystem::GetPitchYawRoll(TransformHandle handle)
+{
+	int index = indexOf[handle];
+	if (rotationState[index] == TRANSFORM_EULER_STALE) UpdatePitchYawRoll(index);
+	return pitchYawRoll[index];
+}
+
+VectorMath::quat TransformSystem::GetRotation(TransformHandle handle)
+{
+	int index = indexOf[handle];
+	if (rotationState[index] == TRANSFORM_QUATERNION_STALE) UpdateRotation(index);
+	return rotation[index];
+}
+
+void TransformSystem::SetPitchYawRoll(TransformHandle handle, VectorMath::float3 value)
+{
+	int index = indexOf[handle];
+	pitchYawRoll[index] = value;
+	rotationState[index] = TRANSFORM_QUATERNION_STALE;
+	MarkDirty(handle);
+}
+
+void TransformSystem::SetRotation(TransformHandle handle, VectorMath::quat value)
+{
+	int index = indexOf[handle];
+	StoreFloat4(&rotation[index], QuaternionNormalize(LoadFloat4(&value)));
+	rotationState[index] = TRANSFORM_EULER_STALE;
+	MarkDirty(handle);
+}
+
+void TransformSystem::SetScale(TransformHandle handle, VectorMath::float3 value)
+{
+	scale[indexOf[handle]] = value;
+	MarkDirty(handle);
+}
+
+bool TransformSystem::SetParent(TransformHandle handle, TransformHandle newParent)
+{
+	// Can't parent to ourselves or anything below us
+	for (TransformHandle p = newParent; p != TRANSFORM_NONE; p = GetParent(p))
+	{
+		if (p == handle) return false;
+	}
+
+	int index = indexOf[handle];
+
+	// Take it out of the old parent's list, the last sibling fills the gap
+	TransformHandle oldParent = GetParent(handle);
+	if (oldParent != TRANSFORM_NONE)
+	{
+		std::vector<TransformHandle>& siblings = children[oldParent];
+		TransformHandle moved = siblings.back();
+		siblings[childSlot[handle]] = moved;
+		childSlot[moved] = childSlot[handle];
+		siblings.pop_back();
+	}
+
+	if (newParent == TRANSFORM_NONE)
+	{
+		parent[index] = -1;
+	}
+	else
+	{
+		parent[index] = indexOf[newParent];
+		childSlot[handle] = (unsigned int)children[newParent].size();
+		children[newParent].push_back(handle);
+
+		// Sorted back into place before the next update
+		if (parent[index] > index) orderBroken = true;
+	}
+
+	MarkDirty(handle);
+	return true;
+}
+
+TransformHandle TransformSystem::GetParent(TransformHandle handle)
+{
+	int p = parent[indexOf[handle]];
+	return p < 0 ? TRANSFORM_NONE : handleAt[p];
+}
+
+TransformHandle TransformSystem::GetChild(TransformHandle handle, unsigned int index)
+{
+	if (index >= children[handle].size()) return TRANSFORM_NONE;
+	return children[handle][index];
+}
+
+int TransformSystem::IndexOfChild(TransformHandle handle, TransformHandle child)
+{
+	if (indexOf[child] < 0 || GetParent(child) != handle) return -1;
+	return (int)childSlot[child];
+}
+
+VectorMath::float4x4 TransformSystem::GetWorldMatrix(TransformHandle handle)
+{
+	UpdateWorldMatrices();
+	return worldMatrix[indexOf[handle]];
+}
+
+VectorMath::float4x4 TransformSystem::GetWorldInverseTransposeMatrix(TransformHandle handle)
+{
+	UpdateWorldMatrices();
+	return worldInverseTransposeMatrix[indexOf[handle]];
+}
+
+void TransformSystem::UpdateWorldMatrices()
+{
+	if (!anyDirty) return;
+	if (orderBroken) SortByDepth();
+
+	updateList.clear();
+	if (!CollectDirtySubtrees())
+	{
+		updateList.clear();
+		CollectDirtyLinear();
+	}
+	dirtyList.clear();
+
+	for (size_t u = 0; u < updateList.size(); u++)
+	{
+		int i = updateList[u];
+		if (rotationState[i] == TRANSFORM_QUATERNION_STALE) UpdateRotation(i);
+	}
+
+	for (int i = 0; i < (int)updateList.size(); i += 4)
+		ComputeLocalMatrices(i);
+
+	// Onto the parents, inverse transposes too since they multiply in the same order.
+	// In list order a parent is always final before its children use it
+	for (size_t u = 0; u < updateList.size(); u++)
+	{
+		int i = updateList[u];
+		int p = parent[i];
+		if (p < 0) continue;
+
+		StoreFloat4x4(&worldMatrix[i], MatrixMultiply(LoadFloat4x4(&worldMatrix[i]), LoadFloat4x4(&worldMatrix[p])));
+		StoreFloat4x4(&worldInverseTransposeMatrix[i],
+			MatrixMultiply(LoadFloat4x4(&worldInverseTransposeMatrix[i]), LoadFloat4x4(&worldInverseTransposeMatrix[p])));
+	}
+
+	// All set, and everything that was dirty is in the list
+	for (size_t u = 0; u < updateList.size(); u++)
+		dirty[updateList[u]] = TRANSFORM_CLEAN;
+	anyDirty = false;
+}
+
+void TransformSystem::CollectDirtyLinear()
+{
+	// Out of date if it changed itself or its parent is being updated. Anything a walk that gave up
+	// already collected is below something that changed, so it's flagged either way
+	int count = (int)position.size();
+	for (int i = 0; i < count; i++)
+	{
+		int p = parent[i];
+		if (dirty[i] == TRANSFORM_CLEAN)
+		{
+			if (p < 0 || dirty[p] == TRANSFORM_CLEAN) continue;
+		}
+		dirty[i] = TRANSFORM_COLLECTED;
+		updateList.push_back(i);
+	}
+}
+
+bool TransformSystem::CollectDirtySubtrees()
+{
+	size_t budget = position.size() / TRANSFORM_WALK_SHARE;
+	if (dirtyList.size() > budget) return false;
+
+	// Breadth first below each listed transform, with updateList as the queue. Anything already
+	// collected brought its whole subtree along, so it's neither added nor walked again
+	for (size_t d = 0; d < dirtyList.size(); d++)
+	{
+		int index = indexOf[dirtyList[d]];
+		if (index < 0 || dirty[index] == TRANSFORM_COLLECTED) continue;
+
+		size_t next = updateList.size();
+		dirty[index] = TRANSFORM_COLLECTED;
+		updateList.push_back(index);
+		for (; next < updateList.size(); next++)
+		{
+			if (updateList.size() > budget) return false;
+
+			const std::vector<TransformHandle>& below = children[handleAt[updateList[next]]];
+			for (size_t c = 0; c < below.size(); c++)
+			{
+				int child = indexOf[below[c]];
+				if (dirty[child] == TRANSFORM_COLLECTED) continue;
+				dirty[child] = TRANSFORM_COLLECTED;
+				updateList.push_back(child);
+			}
+		}
+	}
+
+	// Back into array order, which puts parents first
+	std::sort(updateList.begin(), updateList.end());
+	return true;
+}
+
+void TransformSystem::ComputeLocalMatrices(int first)
+{
+	int last = (int)updateList.size() - 1;
+	int index[4];
+	for (int k = 0; k < 4; k++) index[k] = updateList[std::min(first + k, last)];
+
+	// Four transforms side by side: row 0 holds their x values, row 1 y, row 2 z
+	Matrix t = MatrixTranspose(Matrix(
+		LoadFloat3(&position[index[0]]), LoadFloat3(&position[index[1]]),
+		LoadFloat3(&position[index[2]]), LoadFloat3(&position[index[3]])));
+	Matrix q = MatrixTranspose(Matrix(
+		LoadFloat4(&rotation[index[0]]), LoadFloat4(&rotation[index[1]]),
+		LoadFloat4(&rotation[index[2]]), LoadFloat4(&rotation[index[3]])));
+	Matrix s = MatrixTranspose(Matrix(
+		LoadFloat3(&scale[index[0]]), LoadFloat3(&scale[index[1]]),
+		LoadFloat3(&scale[index[2]]), LoadFloat3(&scale[index[3]])));
+
+	// Rotation straight from the unit quaternions, same as MatrixRotationQuaternion
+	Vector x2 = VectorAdd(q.r[0], q.r[0]);
+	Vector y2 = VectorAdd(q.r[1], q.r[1]);
+	Vector z2 = VectorAdd(q.r[2], q.r[2]);
+	Vector xx = VectorMultiply(q.r[0], x2), yy = VectorMultiply(q.r[1], y2), zz = VectorMultiply(q.r[2], z2);
+	Vector xy = VectorMultiply(q.r[0], y2), xz = VectorMultiply(q.r[0], z2), yz = VectorMultiply(q.r[1], z2);
+	Vector wx = VectorMultiply(q.r[3], x2), wy = VectorMultiply(q.r[3], y2), wz = VectorMultiply(q.r[3], z2);
+	Vector one = VectorSplatOne();
+	Vector rot[3][3];
+	rot[0][0] = VectorSubtract(one, VectorAdd(yy, zz));
+	rot[0][1] = VectorAdd(xy, wz);
+	rot[0][2] = VectorSubtract(xz, wy);
+	rot[1][0] = VectorSubtract(xy, wz);
+	rot[1][1] = VectorSubtract(one, VectorAdd(xx, zz));
+	rot[1][2] = VectorAdd(yz, wx);
+	rot[2][0] = VectorAdd(xz, wy);
+	rot[2][1] = VectorSubtract(yz, wx);
+	rot[2][2] = VectorSubtract(one, VectorAdd(xx, yy));
+
+	// World is scale * rotation * translation: rotation rows scaled, then the position.
+	// Its inverse transpose has rotation rows divided by the scale instead, the position
+	// moved into the last column as -(position . row), and a plain last row
+	Vector zero = VectorZero();
+	Vector world[4][4];
+	Vector inverseTranspose[4][4];
+	for (int row = 0; row < 3; row++)
+	{
+		Vector sc = s.r[row];
+		Vector invSc = VectorReciprocal(sc);
+		for (int col = 0; col < 3; col++)
+		{
+			world[row][col] = VectorMultiply(rot[row][col], sc);
+			inverseTranspose[row][col] = VectorMultiply(rot[row][col], invSc);
+		}
+		world[row][3] = zero;
+
+		Vector along = VectorMultiply(t.r[0], rot[row][0]);
+		along = VectorMultiplyAdd(t.r[1], rot[row][1], along);
+		along = VectorMultiplyAdd(t.r[2], rot[row][2], along);
+		inverseTranspose[row][3] = VectorNegate(VectorMultiply(along, invSc));
+	}
+	for (int col = 0; col < 3; col++)
+	{
+		world[3][col] = t.r[col];
+		inverseTranspose[3][col] = zero;
+	}
+	world[3][3] = one;
+	inverseTranspose[3][3] = one;
+
+	// Back to one matrix per transform, a row at a time
+	Matrix w[4], it[4];
+	for (int row = 0; row < 4; row++)
+	{
+		Matrix wRows = MatrixTranspose(Matrix(world[row][0], world[row][1], world[row][2], world[row][3]));
+		Matrix itRows = MatrixTranspose(Matrix(inverseTranspose[row][0], inverseTranspose[row][1], inverseTranspose[row][2], inverseTranspose[row][3]));
+		for (int k = 0; k < 4; k++)
+		{
+			w[k].r[row] = wRows.r[k];
+			it[k].r[row] = itRows.r[k];
+		}
+	}
+
+	for (int k = 0; k < 4 && first + k <= last; k++)
+	{
+		StoreFloat4x4(&worldMatrix[index[k]], w[k]);
+		StoreFloat4x4(&worldInverseTransposeMatrix[index[k]], it[k]);
+	}
+}
+
+void TransformSystem::MarkDirty(TransformHandle handle)
+{
+	int index = indexOf[handle];
+	if (dirty[index] != TRANSFORM_CLEAN) return;
+
+	dirty[index] = TRANSFORM_CHANGED;
+	dirtyList.push_back(handle);
+	anyDirty = true;
+}
+
+void TransformSystem::UpdateRotation(int index)
+{
+	// Roll, then pitch, then yaw
+	StoreFloat4(&rotation[index], QuaternionRotationRollPitchYawFromVector(LoadFloat3(&pitchYawRoll[index])));
+	rotationState[index] = TRANSFORM_ROTATION_CURRENT;
+}
+
+void TransformSystem::UpdatePitchYawRoll(int index)
+{
+	// The entries of the rotation matrix the angles come out of, read straight off the quaternion.
+	// Rough at best near straight up or down, where yaw and roll become the same thing
+	// From: https://stackoverflow.com/questions/60350349/directx-get-pitch-yaw-roll-from-xmmatrix
+	quat q = rotation[index];
+	float m12 = 2 * (q.x * q.y + q.z * q.w);
+	float m22 = 1 - 2 * (q.x * q.x + q.z * q.z);
+	float m31 = 2 * (q.x * q.z + q.y * q.w);
+	float m32 = 2 * (q.y * q.z - q.x * q.w);
+	float m33 = 1 - 2 * (q.x * q.x + q.y * q.y);
+
+	pitchYawRoll[index].x = asinf(-fminf(fmaxf(m32, -1.0f), 1.0f));
+	pitchYawRoll[index].y = atan2f(m31, m33);
+	pitchYawRoll[index].z = atan2f(m12, m22);
+	rotationState[index] = TRANSFORM_ROTATION_CURRENT;
+}
+
+void TransformSystem::SortByDepth()
+{
+	int count = (int)position.size();
+
+	// Depth of everything, walking up only as far as something already known
+	depth.assign(count, -1);
+	int maxDepth = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int steps = 0;
+		int known = i;
+		while (known >= 0 && depth[known] < 0)
+		{
+			steps++;
+			known = parent[known];
+		}
+
+		int d = (known < 0 ? -1 : depth[known]) + steps;
+		for (int j = i; j != known; j = parent[j])
+			depth[j] = d--;
+
+		maxDepth = std::max(maxDepth, depth[i]);
+	}
+
+	// Stable counting sort on depth, so transforms at the same depth keep their order
+	depthStarts.assign(maxDepth + 2, 0);
+	for (int i = 0; i < count; i++) depthStarts[depth[i] + 1]++;
+	for (int d = 1; d <= maxDepth + 1; d++) depthStarts[d] += depthStarts[d - 1];
+
+	sortOrder.resize(count);
+	for (int i = 0; i < count; i++) sortOrder[depthStarts[depth[i]]++] = i;
+
+	// Old index to new, for fixing up the parent links
+	newIndex.resize(count);
+	for (int i = 0; i < count; i++) newIndex[sortOrder[i]] = i;
+	for (int i = 0; i < count; i++)
+	{
+		if (parent[i] >= 0) parent[i] = newIndex[parent[i]];
+	}
+
+	Permute(position, float3Scratch, sortOrder);
+	Permute(pitchYawRoll, float3Scratch, sortOrder);
+	Permute(scale, float3Scratch, sortOrder);
+	Permute(rotation, quatScratch, sortOrder);
+	Permute(rotationState, byteScratch, sortOrder);
+	Permute(dirty, byteScratch, sortOrder);
+	Permute(parent, intScratch, sortOrder);
+	Permute(worldMatrix, matrixScratch, sortOrder);
+	Permute(worldInverseTransposeMatrix, matrixScratch, sortOrder);
+	Permute(handleAt, handleScratch, sortOrder);
+
+	for (int i = 0; i < count; i++) indexOf[handleAt[i]] = i;
+
+	orderBroken = false;
+}
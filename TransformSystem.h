@@ -0,0 +1,150 @@
+#pragma once
+
+#include "VectorMath.h"
+#include <cstdint>
+#include <vector>
+
+class Transform;
+
+// Handle to one transform in a TransformSystem, stays the same while the transform exists
+typedef uint32_t TransformHandle;
+
+// No parent, or no transform at all
+#define TRANSFORM_NONE 0xFFFFFFFFu
+
+// Why a transform's world matrices are out of date
+#define TRANSFORM_CLEAN 0
+#define TRANSFORM_CHANGED 1 // Set itself since the last update
+#define TRANSFORM_COLLECTED 2 // Already in the update list along with everything below it
+
+// Which half of a transform's rotation needs recomputing before it's read
+#define TRANSFORM_ROTATION_CURRENT 0
+#define TRANSFORM_QUATERNION_STALE 1
+#define TRANSFORM_EULER_STALE 2
+
+// Every transform's local data, parent link and world matrices in flat arrays kept parents first,
+// so world matrices can be updated in array order. Only the subtrees of what changed are visited, unless
+// so much changed that one linear pass over everything is cheaper. Transforms move in the arrays, so use handles.
+class TransformSystem
+{
+public:
+	// Gets the one and only instance of this class
+	static TransformSystem& GetInstance()
+	{
+		if (!instance)
+		{
+			instance = new TransformSystem();
+		}
+
+		return *instance;
+	}
+
+	// Remove these functions (C++ 11 version)
+	TransformSystem(TransformSystem const&) = delete;
+	void operator=(TransformSystem const&) = delete;
+
+private:
+	static TransformSystem* instance;
+	TransformSystem();
+
+public:
+
+	// New identity transform with no parent. owner is what GetOwner hands back
+	TransformHandle Create(Transform* owner);
+
+	// Removes a transform, its children are left without a parent
+	void Destroy(TransformHandle handle);
+
+	// Local transformation data. Rotation is stored as both, whichever was set last is exact
+	VectorMath::float3 GetPosition(TransformHandle handle) { return position[indexOf[handle]]; }
+	VectorMath::float3 GetPitchYawRoll(TransformHandle handle);
+	VectorMath::quat GetRotation(TransformHandle handle);
+	VectorMath::float3 GetScale(TransformHandle handle) { return scale[indexOf[handle]]; }
+	void SetPosition(TransformHandle handle, VectorMath::float3 value);
+	void SetPitchYawRoll(TransformHandle handle, VectorMath::float3 value);
+	void SetRotation(TransformHandle handle, VectorMath::quat value); // Normalized on the way in
+	void SetScale(TransformHandle handle, VectorMath::float3 value);
+
+	// Links a transform to a new parent (or TRANSFORM_NONE) without touching its local data.
+	// Returns false if that would make it its own ancestor
+	bool SetParent(TransformHandle handle, TransformHandle parent);
+	TransformHandle GetParent(TransformHandle handle);
+	TransformHandle GetChild(TransformHandle handle, unsigned int index);
+	int IndexOfChild(TransformHandle handle, TransformHandle child); // -1 if it isn't one
+	unsigned int GetChildCount(TransformHandle handle) { return (unsigned int)children[handle].size(); }
+
+	Transform* GetOwner(TransformHandle handle) { return owners[handle]; }
+
+	// World matrices, brought up to date first if anything has changed
+	VectorMath::float4x4 GetWorldMatrix(TransformHandle handle);
+	VectorMath::float4x4 GetWorldInverseTransposeMatrix(TransformHandle handle);
+
+	// Recomputes every world matrix that's out of date in one pass. Called on demand by the
+	// getters, but calling it once a frame before drawing keeps the cost in one place
+	void UpdateWorldMatrices();
+
+	unsigned int Count() { return (unsigned int)position.size(); }
+
+private:
+
+	// Indexed by position in the arrays, parents before children
+	std::vector<VectorMath::float3> position;
+	std::vector<VectorMath::float3> pitchYawRoll;
+	std::vector<VectorMath::quat> rotation;
+	std::vector<uint8_t> rotationState; // Which of the two rotations is out of date, if either
+	std::vector<VectorMath::float3> scale;
+	std::vector<int> parent; // Array index of the parent, -1 for none
+	std::vector<uint8_t> dirty; // TRANSFORM_CLEAN, or why the world matrices are out of date
+	std::vector<VectorMath::float4x4> worldMatrix;
+	std::vector<VectorMath::float4x4> worldInverseTransposeMatrix;
+	std::vector<TransformHandle> handleAt;
+
+	// Indexed by handle
+	std::vector<int> indexOf; // -1 for a free handle
+	std::vector<Transform*> owners;
+	std::vector<std::vector<TransformHandle>> children;
+	std::vector<unsigned int> childSlot; // Where it sits in its parent's children, so it can leave in O(1)
+	std::vector<TransformHandle> freeHandles;
+
+	bool anyDirty;
+	bool orderBroken; // A parent has ended up after one of its children
+
+	// Flags one transform and lists it, its descendants are picked up by the next update.
+	// Setting the same transform again before then costs nothing
+	void MarkDirty(TransformHandle handle);
+
+	// Everything MarkDirty flagged since the last update. Handles, since sorting and Destroy move
+	// transforms. May hold destroyed or reused handles, which the update skips or harmlessly redoes
+	std::vector<TransformHandle> dirtyList;
+
+	// Fill updateList with everything out of date, in array order. The walk only visits the subtrees
+	// under dirtyList, but gives up and returns false once the linear pass would be cheaper
+	bool CollectDirtySubtrees();
+	void CollectDirtyLinear();
+
+	// Bring one side of the rotation up to date from the other
+	void UpdateRotation(int index);
+	void UpdatePitchYawRoll(int index);
+
+	// Array indices of everything the current update is recomputing, parents first
+	std::vector<int> updateList;
+
+	// Local matrices and their analytic inverse transposes of updateList[first, first + 4) into the
+	// world arrays. Short batches repeat the last one
+	void ComputeLocalMatrices(int first);
+
+	// Restores parent before child order by sorting on depth
+	void SortByDepth();
+	std::vector<int> depth;
+	std::vector<int> depthStarts;
+	std::vector<int> sortOrder;
+	std::vector<int> newIndex;
+
+	// Kept between sorts so reordering the arrays doesn't allocate, one per element type
+	std::vector<VectorMath::float3> float3Scratch;
+	std::vector<VectorMath::quat> quatScratch;
+	std::vector<VectorMath::float4x4> matrixScratch;
+	std::vector<uint8_t> byteScratch;
+	std::vector<int> intScratch;
+	std::vector<TransformHandle> handleScratch;
+};
@@ -0,0 +1,501 @@
+#pragma once
+
+#include <cmath>
+
+// Small stand-in for the parts of DirectXMath the simulation, server and transform code use, so they
+// build anywhere. Same conventions as DirectXMath: row vectors multiplied on the left (v * M), left
+// handed, angles in radians, quaternions as (x, y, z, w), and the same argument order and meaning for
+// every function that shares a name with an XM one.
+//
+// Storage types are plain floats. Math happens on Vector/Matrix, which map to SSE2 or NEON registers
+// where those exist and to four floats everywhere else.
+
+// Defining VECTORMATH_SCALAR up front forces the plain float backend, e.g. to compare it against the others
+#if defined(VECTORMATH_SCALAR)
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define VECTORMATH_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VECTORMATH_NEON
+#include <arm_neon.h>
+#else
+#define VECTORMATH_SCALAR
+#endif
+
+// Storage types convert to and from DirectXMath's, so renderer code can keep passing XMFLOATs around
+#ifdef _WIN32
+#include <DirectXMath.h>
+#define VECTORMATH_DIRECTX_INTEROP
+#endif
+
+namespace VectorMath
+{
+	const float PI = 3.141592654f;
+
+	// Storage
+	struct float3
+	{
+		float x, y, z;
+
+		float3() {}
+		float3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+#ifdef VECTORMATH_DIRECTX_INTEROP
+		float3(const DirectX::XMFLOAT3& v) : x(v.x), y(v.y), z(v.z) {}
+		operator DirectX::XMFLOAT3() const { return DirectX::XMFLOAT3(x, y, z); }
+#endif
+	};
+
+	struct float4
+	{
+		float x, y, z, w;
+
+		float4() {}
+		float4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+#ifdef VECTORMATH_DIRECTX_INTEROP
+		float4(const DirectX::XMFLOAT4& v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
+		operator DirectX::XMFLOAT4() const { return DirectX::XMFLOAT4(x, y, z, w); }
+#endif
+	};
+
+	// Rotation quaternion, stored (x, y, z, w)
+	typedef float4 quat;
+
+	// Row major, translation in the last row
+	struct float4x4
+	{
+		union
+		{
+			struct
+			{
+				float _11, _12, _13, _14;
+				float _21, _22, _23, _24;
+				float _31, _32, _33, _34;
+				float _41, _42, _43, _44;
+			};
+			float m[4][4];
+		};
+
+		float4x4() {}
+
+#ifdef VECTORMATH_DIRECTX_INTEROP
+		float4x4(const DirectX::XMFLOAT4X4& v)
+		{
+			for (int r = 0; r < 4; r++)
+				for (int c = 0; c < 4; c++)
+					m[r][c] = v.m[r][c];
+		}
+		operator DirectX::XMFLOAT4X4() const
+		{
+			DirectX::XMFLOAT4X4 v;
+			for (int r = 0; r < 4; r++)
+				for (int c = 0; c < 4; c++)
+					v.m[r][c] = m[r][c];
+			return v;
+		}
+#endif
+	};
+
+	// Registers
+#if defined(VECTORMATH_SSE2)
+	typedef __m128 Vector;
+#elif defined(VECTORMATH_NEON)
+	typedef float32x4_t Vector;
+#else
+	struct Vector { float f[4]; };
+#endif
+
+	struct Matrix
+	{
+		Vector r[4];
+
+		Matrix() {}
+		Matrix(const Vector& r0, const Vector& r1, const Vector& r2, const Vector& r3) { r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; }
+	};
+
+	// Backend, everything after this is written in terms of these
+
+#if defined(VECTORMATH_SSE2)
+
+	inline Vector VectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+	inline Vector VectorZero() { return _mm_setzero_ps(); }
+	inline Vector VectorReplicate(float value) { return _mm_set1_ps(value); }
+	inline Vector LoadFloat4(const float* source) { return _mm_loadu_ps(source); }
+	inline void StoreFloat4(float* destination, Vector v) { _mm_storeu_ps(destination, v); }
+
+	inline float VectorGetX(Vector v) { return _mm_cvtss_f32(v); }
+	inline float VectorGetY(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+	inline float VectorGetZ(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+	inline float VectorGetW(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+	inline Vector VectorSplatX(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+	inline Vector VectorSplatY(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+	inline Vector VectorSplatZ(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+	inline Vector VectorSplatW(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+	inline Vector VectorAdd(Vector a, Vector b) { return _mm_add_ps(a, b); }
+	inline Vector VectorSubtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+	inline Vector VectorMultiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+	inline Vector VectorDivide(Vector a, Vector b) { return _mm_div_ps(a, b); }
+
+	inline Matrix MatrixTranspose(const Matrix& m)
+	{
+		Matrix t = m;
+		_MM_TRANSPOSE4_PS(t.r[0], t.r[1], t.r[2], t.r[3]);
+		return t;
+	}
+
+#elif defined(VECTORMATH_NEON)
+
+	inline Vector VectorSet(float x, float y, float z, float w) { float f[4] = { x, y, z, w }; return vld1q_f32(f); }
+	inline Vector VectorZero() { return vdupq_n_f32(0); }
+	inline Vector VectorReplicate(float value) { return vdupq_n_f32(value); }
+	inline Vector LoadFloat4(const float* source) { return vld1q_f32(source); }
+	inline void StoreFloat4(float* destination, Vector v) { vst1q_f32(destination, v); }
+
+	inline float VectorGetX(Vector v) { return vgetq_lane_f32(v, 0); }
+	inline float VectorGetY(Vector v) { return vgetq_lane_f32(v, 1); }
+	inline float VectorGetZ(Vector v) { return vgetq_lane_f32(v, 2); }
+	inline float VectorGetW(Vector v) { return vgetq_lane_f32(v, 3); }
+	inline Vector VectorSplatX(Vector v) { return vdupq_laneq_f32(v, 0); }
+	inline Vector VectorSplatY(Vector v) { return vdupq_laneq_f32(v, 1); }
+	inline Vector VectorSplatZ(Vector v) { return vdupq_laneq_f32(v, 2); }
+	inline Vector VectorSplatW(Vector v) { return vdupq_laneq_f32(v, 3); }
+
+	inline Vector VectorAdd(Vector a, Vector b) { return vaddq_f32(a, b); }
+	inline Vector VectorSubtract(Vector a, Vector b) { return vsubq_f32(a, b); }
+	inline Vector VectorMultiply(Vector a, Vector b) { return vmulq_f32(a, b); }
+	inline Vector VectorDivide(Vector a, Vector b) { return vdivq_f32(a, b); }
+
+	inline Matrix MatrixTranspose(const Matrix& m)
+	{
+		float32x4x2_t p0 = vzipq_f32(m.r[0], m.r[2]);
+		float32x4x2_t p1 = vzipq_f32(m.r[1], m.r[3]);
+		float32x4x2_t t0 = vzipq_f32(p0.val[0], p1.val[0]);
+		float32x4x2_t t1 = vzipq_f32(p0.val[1], p1.val[1]);
+		return Matrix(t0.val[0], t0.val[1], t1.val[0], t1.val[1]);
+	}
+
+#else
+
+	inline Vector VectorSet(float x, float y, float z, float w) { Vector v = { { x, y, z, w } }; return v; }
+	inline Vector VectorZero() { return VectorSet(0, 0, 0, 0); }
+	inline Vector VectorReplicate(float value) { return VectorSet(value, value, value, value); }
+	inline Vector LoadFloat4(const float* source) { return VectorSet(source[0], source[1], source[2], source[3]); }
+	inline void StoreFloat4(float* destination, Vector v) { for (int i = 0; i < 4; i++) destination[i] = v.f[i]; }
+
+	inline float VectorGetX(Vector v) { return v.f[0]; }
+	inline float VectorGetY(Vector v) { return v.f[1]; }
+	inline float VectorGetZ(Vector v) { return v.f[2]; }
+	inline float VectorGetW(Vector v) { return v.f[3]; }
+	inline Vector VectorSplatX(Vector v) { return VectorReplicate(v.f[0]); }
+	inline Vector VectorSplatY(Vector v) { return VectorReplicate(v.f[1]); }
+	inline Vector VectorSplatZ(Vector v) { return VectorReplicate(v.f[2]); }
+	inline Vector VectorSplatW(Vector v) { return VectorReplicate(v.f[3]); }
+
+	inline Vector VectorAdd(Vector a, Vector b) { return VectorSet(a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3]); }
+	inline Vector VectorSubtract(Vector a, Vector b) { return VectorSet(a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3]); }
+	inline Vector VectorMultiply(Vector a, Vector b) { return VectorSet(a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3]); }
+	inline Vector VectorDivide(Vector a, Vector b) { return VectorSet(a.f[0] / b.f[0], a.f[1] / b.f[1], a.f[2] / b.f[2], a.f[3] / b.f[3]); }
+
+	inline Matrix MatrixTranspose(const Matrix& m)
+	{
+		Matrix t;
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++)
+				t.r[r].f[c] = m.r[c].f[r];
+		return t;
+	}
+
+#endif
+
+	// Vectors
+	inline Vector VectorSplatOne() { return VectorReplicate(1.0f); }
+	inline Vector VectorNegate(Vector v) { return VectorSubtract(VectorZero(), v); }
+	inline Vector VectorReciprocal(Vector v) { return VectorDivide(VectorSplatOne(), v); }
+
+	// a * b + c
+	inline Vector VectorMultiplyAdd(Vector a, Vector b, Vector c) { return VectorAdd(VectorMultiply(a, b), c); }
+
+	inline Vector LoadFloat3(const float3* source) { return VectorSet(source->x, source->y, source->z, 0); }
+	inline Vector LoadFloat4(const float4* source) { return VectorSet(source->x, source->y, source->z, source->w); }
+	inline void StoreFloat3(float3* destination, Vector v) { *destination = float3(VectorGetX(v), VectorGetY(v), VectorGetZ(v)); }
+	inline void StoreFloat4(float4* destination, Vector v) { StoreFloat4(&destination->x, v); }
+
+	// Sine and cosine of every lane
+	inline void VectorSinCos(Vector* sin, Vector* cos, Vector angles)
+	{
+		float a[4], s[4], c[4];
+		StoreFloat4(a, angles);
+		for (int i = 0; i < 4; i++)
+		{
+			s[i] = sinf(a[i]);
+			c[i] = cosf(a[i]);
+		}
+		*sin = LoadFloat4(s);
+		*cos = LoadFloat4(c);
+	}
+
+	inline float Vector3Dot(Vector a, Vector b)
+	{
+		Vector p = VectorMultiply(a, b);
+		return VectorGetX(p) + VectorGetY(p) + VectorGetZ(p);
+	}
+
+	inline Vector Vector3Cross(Vector a, Vector b)
+	{
+		return VectorSet(
+			VectorGetY(a) * VectorGetZ(b) - VectorGetZ(a) * VectorGetY(b),
+			VectorGetZ(a) * VectorGetX(b) - VectorGetX(a) * VectorGetZ(b),
+			VectorGetX(a) * VectorGetY(b) - VectorGetY(a) * VectorGetX(b),
+			0);
+	}
+
+	inline float Vector3Length(Vector v) { return sqrtf(Vector3Dot(v, v)); }
+
+	inline Vector Vector3Normalize(Vector v)
+	{
+		float length = Vector3Length(v);
+		return length > 0 ? VectorMultiply(v, VectorReplicate(1.0f / length)) : v;
+	}
+
+	// Quaternions
+	inline Vector QuaternionIdentity() { return VectorSet(0, 0, 0, 1); }
+
+	inline Vector QuaternionConjugate(Vector q) { return VectorSet(-VectorGetX(q), -VectorGetY(q), -VectorGetZ(q), VectorGetW(q)); }
+
+	inline Vector QuaternionNormalize(Vector q)
+	{
+		float length = sqrtf(VectorGetX(q) * VectorGetX(q) + VectorGetY(q) * VectorGetY(q) + VectorGetZ(q) * VectorGetZ(q) + VectorGetW(q) * VectorGetW(q));
+		return length > 0 ? VectorMultiply(q, VectorReplicate(1.0f / length)) : q;
+	}
+
+	// Rotation by q1 followed by rotation by q2, like XMQuaternionMultiply
+	inline Vector QuaternionMultiply(Vector q1, Vector q2)
+	{
+		float ax = VectorGetX(q2), ay = VectorGetY(q2), az = VectorGetZ(q2), aw = VectorGetW(q2);
+		float bx = VectorGetX(q1), by = VectorGetY(q1), bz = VectorGetZ(q1), bw = VectorGetW(q1);
+		return VectorSet(
+			aw * bx + ax * bw + ay * bz - az * by,
+			aw * by - ax * bz + ay * bw + az * bx,
+			aw * bz + ax * by - ay * bx + az * bw,
+			aw * bw - ax * bx - ay * by - az * bz);
+	}
+
+	// Roll about z first, then pitch about x, then yaw about y
+	inline Vector QuaternionRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		float sp = sinf(pitch * 0.5f), cp = cosf(pitch * 0.5f);
+		float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f);
+		float sr = sinf(roll * 0.5f), cr = cosf(roll * 0.5f);
+		return VectorSet(
+			cy * sp * cr + sy * cp * sr,
+			sy * cp * cr - cy * sp * sr,
+			cy * cp * sr - sy * sp * cr,
+			cy * cp * cr + sy * sp * sr);
+	}
+
+	inline Vector QuaternionRotationRollPitchYawFromVector(Vector angles)
+	{
+		return QuaternionRotationRollPitchYaw(VectorGetX(angles), VectorGetY(angles), VectorGetZ(angles));
+	}
+
+	// v rotated by the unit quaternion q
+	inline Vector Vector3Rotate(Vector v, Vector q)
+	{
+		Vector axis = VectorSet(VectorGetX(q), VectorGetY(q), VectorGetZ(q), 0);
+		Vector t = Vector3Cross(axis, v);
+		t = VectorAdd(t, t);
+		return VectorAdd(VectorAdd(v, VectorMultiply(VectorSplatW(q), t)), Vector3Cross(axis, t));
+	}
+
+	// Rotation part of a matrix without scale
+	inline Vector QuaternionRotationMatrix(const Matrix& m)
+	{
+		float4x4 r;
+		for (int i = 0; i < 4; i++) StoreFloat4(r.m[i], m.r[i]);
+
+		float trace = r._11 + r._22 + r._33;
+		if (trace > 0)
+		{
+			float s = sqrtf(trace + 1) * 2;
+			return VectorSet((r._23 - r._32) / s, (r._31 - r._13) / s, (r._12 - r._21) / s, s * 0.25f);
+		}
+		if (r._11 > r._22 && r._11 > r._33)
+		{
+			float s = sqrtf(1 + r._11 - r._22 - r._33) * 2;
+			return VectorSet(s * 0.25f, (r._21 + r._12) / s, (r._31 + r._13) / s, (r._23 - r._32) / s);
+		}
+		if (r._22 > r._33)
+		{
+			float s = sqrtf(1 + r._22 - r._11 - r._33) * 2;
+			return VectorSet((r._21 + r._12) / s, s * 0.25f, (r._32 + r._23) / s, (r._31 - r._13) / s);
+		}
+		float s = sqrtf(1 + r._33 - r._11 - r._22) * 2;
+		return VectorSet((r._31 + r._13) / s, (r._32 + r._23) / s, s * 0.25f, (r._12 - r._21) / s);
+	}
+
+	// Matrices
+	inline Matrix LoadFloat4x4(const float4x4* source)
+	{
+		return Matrix(LoadFloat4(source->m[0]), LoadFloat4(source->m[1]), LoadFloat4(source->m[2]), LoadFloat4(source->m[3]));
+	}
+
+	inline void StoreFloat4x4(float4x4* destination, const Matrix& m)
+	{
+		for (int i = 0; i < 4; i++) StoreFloat4(destination->m[i], m.r[i]);
+	}
+
+	inline Matrix MatrixIdentity()
+	{
+		return Matrix(VectorSet(1, 0, 0, 0), VectorSet(0, 1, 0, 0), VectorSet(0, 0, 1, 0), VectorSet(0, 0, 0, 1));
+	}
+
+	// a then b
+	inline Matrix MatrixMultiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result;
+		for (int i = 0; i < 4; i++)
+		{
+			Vector row = VectorMultiply(VectorSplatX(a.r[i]), b.r[0]);
+			row = VectorMultiplyAdd(VectorSplatY(a.r[i]), b.r[1], row);
+			row = VectorMultiplyAdd(VectorSplatZ(a.r[i]), b.r[2], row);
+			row = VectorMultiplyAdd(VectorSplatW(a.r[i]), b.r[3], row);
+			result.r[i] = row;
+		}
+		return result;
+	}
+
+	inline Matrix MatrixTranslation(float x, float y, float z)
+	{
+		return Matrix(VectorSet(1, 0, 0, 0), VectorSet(0, 1, 0, 0), VectorSet(0, 0, 1, 0), VectorSet(x, y, z, 1));
+	}
+
+	inline Matrix MatrixTranslationFromVector(Vector v) { return MatrixTranslation(VectorGetX(v), VectorGetY(v), VectorGetZ(v)); }
+
+	inline Matrix MatrixScaling(float x, float y, float z)
+	{
+		return Matrix(VectorSet(x, 0, 0, 0), VectorSet(0, y, 0, 0), VectorSet(0, 0, z, 0), VectorSet(0, 0, 0, 1));
+	}
+
+	inline Matrix MatrixScalingFromVector(Vector v) { return MatrixScaling(VectorGetX(v), VectorGetY(v), VectorGetZ(v)); }
+
+	inline Matrix MatrixRotationQuaternion(Vector q)
+	{
+		float x = VectorGetX(q), y = VectorGetY(q), z = VectorGetZ(q), w = VectorGetW(q);
+		return Matrix(
+			VectorSet(1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0),
+			VectorSet(2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0),
+			VectorSet(2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0),
+			VectorSet(0, 0, 0, 1));
+	}
+
+	// Roll about z first, then pitch about x, then yaw about y
+	inline Matrix MatrixRotationRollPitchYaw(float pitch, float yaw, float roll)
+	{
+		float sp = sinf(pitch), cp = cosf(pitch);
+		float sy = sinf(yaw), cy = cosf(yaw);
+		float sr = sinf(roll), cr = cosf(roll);
+		return Matrix(
+			VectorSet(cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy, 0),
+			VectorSet(cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy, 0),
+			VectorSet(cp * sy, -sp, cp * cy, 0),
+			VectorSet(0, 0, 0, 1));
+	}
+
+	inline Matrix MatrixRotationRollPitchYawFromVector(Vector angles)
+	{
+		return MatrixRotationRollPitchYaw(VectorGetX(angles), VectorGetY(angles), VectorGetZ(angles));
+	}
+
+	// General inverse by cofactors. determinant is optional, and a singular matrix comes back unchanged
+	inline Matrix MatrixInverse(float* determinant, const Matrix& matrix)
+	{
+		float4x4 m;
+		StoreFloat4x4(&m, matrix);
+		const float* a = &m.m[0][0];
+
+		float inv[16];
+		inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+		inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+		inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+		inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+		inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+		inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+		inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+		inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+		inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+		inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+		inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+		inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+		inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+		inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+		inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+		inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+		float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+		if (determinant) *determinant = det;
+		if (det == 0) return matrix;
+
+		float invDet = 1.0f / det;
+		return Matrix(
+			VectorMultiply(LoadFloat4(&inv[0]), VectorReplicate(invDet)),
+			VectorMultiply(LoadFloat4(&inv[4]), VectorReplicate(invDet)),
+			VectorMultiply(LoadFloat4(&inv[8]), VectorReplicate(invDet)),
+			VectorMultiply(LoadFloat4(&inv[12]), VectorReplicate(invDet)));
+	}
+
+	// Splits scale * rotation * translation back into its parts. False if a scale is zero
+	inline bool MatrixDecompose(Vector* outScale, Vector* outRotation, Vector* outTranslation, const Matrix& m)
+	{
+		Vector rows[3];
+		float lengths[3];
+		for (int i = 0; i < 3; i++)
+		{
+			rows[i] = VectorSet(VectorGetX(m.r[i]), VectorGetY(m.r[i]), VectorGetZ(m.r[i]), 0);
+			lengths[i] = Vector3Length(rows[i]);
+			if (lengths[i] == 0) return false;
+			rows[i] = VectorMultiply(rows[i], VectorReplicate(1.0f / lengths[i]));
+		}
+
+		// A mirror shows up as a negative x scale
+		if (Vector3Dot(Vector3Cross(rows[0], rows[1]), rows[2]) < 0)
+		{
+			lengths[0] = -lengths[0];
+			rows[0] = VectorNegate(rows[0]);
+		}
+
+		*outScale = VectorSet(lengths[0], lengths[1], lengths[2], 0);
+		*outRotation = QuaternionRotationMatrix(Matrix(rows[0], rows[1], rows[2], VectorSet(0, 0, 0, 1)));
+		*outTranslation = VectorSet(VectorGetX(m.r[3]), VectorGetY(m.r[3]), VectorGetZ(m.r[3]), 1);
+		return true;
+	}
+
+	// View matrix for a camera at eye looking along direction
+	inline Matrix MatrixLookToLH(Vector eye, Vector direction, Vector up)
+	{
+		Vector r2 = Vector3Normalize(direction);
+		Vector r0 = Vector3Normalize(Vector3Cross(up, r2));
+		Vector r1 = Vector3Cross(r2, r0);
+		Vector negEye = VectorNegate(eye);
+
+		return Matrix(
+			VectorSet(VectorGetX(r0), VectorGetX(r1), VectorGetX(r2), 0),
+			VectorSet(VectorGetY(r0), VectorGetY(r1), VectorGetY(r2), 0),
+			VectorSet(VectorGetZ(r0), VectorGetZ(r1), VectorGetZ(r2), 0),
+			VectorSet(Vector3Dot(r0, negEye), Vector3Dot(r1, negEye), Vector3Dot(r2, negEye), 1));
+	}
+
+	inline Matrix MatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		float height = cosf(0.5f * fovAngleY) / sinf(0.5f * fovAngleY);
+		float width = height / aspectRatio;
+		float range = farZ / (farZ - nearZ);
+
+		return Matrix(
+			VectorSet(width, 0, 0, 0),
+			VectorSet(0, height, 0, 0),
+			VectorSet(0, 0, range, 1),
+			VectorSet(0, 0, -range * nearZ, 0));
+	}
+}